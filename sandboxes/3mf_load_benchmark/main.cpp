@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "libslic3r/Format/3mf.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+// Project of num_objects spheres with num_facets facets in total.
+static Model make_project(size_t num_objects, size_t num_facets)
+{
+    // A sphere with the facet angle fa has about 2 * PI^2 / fa^2 facets.
+    const double fa = PI * std::sqrt(2. * double(num_objects) / double(num_facets));
+    Model model;
+    for (size_t i = 0; i < num_objects; ++ i) {
+        ModelObject *object = model.add_object();
+        object->name = "sphere" + std::to_string(i);
+        object->add_volume(make_sphere(10., fa));
+        object->add_instance()->set_offset(Vec3d(double(i % 20) * 25., double(i / 20) * 25., 10.));
+    }
+    return model;
+}
+
+static size_t num_facets(const Model &model)
+{
+    size_t n = 0;
+    for (const ModelObject *object : model.objects)
+        for (const ModelVolume *volume : object->volumes)
+            n += volume->mesh().facets_count();
+    return n;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const size_t num_objects = argc > 1 ? size_t(std::max(1, std::atoi(argv[1]))) : 200;
+    const size_t num_facets  = argc > 2 ? size_t(std::max(1, std::atoi(argv[2]))) : 20000000;
+    const int    repeats     = 3;
+
+    std::cout << "Generating " << num_objects << " objects with " << num_facets << " facets in total" << std::endl;
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("3mf_load_benchmark-%%%%-%%%%.3mf")).string();
+    size_t facets_stored;
+    {
+        Model model = make_project(num_objects, num_facets);
+        facets_stored = Slic3r::num_facets(model);
+        Benchmark b;
+        b.start();
+        if (! store_3mf(path.c_str(), &model, &config, false)) {
+            std::cerr << "Failed to store " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        b.stop();
+        std::cout << std::fixed << std::setprecision(3) << "Stored " << facets_stored << " facets in " << b.getElapsedSec() << " s, " 
+                  << boost::filesystem::file_size(path) / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    double best = std::numeric_limits<double>::max();
+    bool   ok   = true;
+    for (int i = 0; i < repeats && ok; ++ i) {
+        Model                     model;
+        DynamicPrintConfig        config_loaded;
+        ConfigSubstitutionContext config_substitutions(ForwardCompatibilitySubstitutionRule::Enable);
+        Benchmark b;
+        b.start();
+        ok = load_3mf(path.c_str(), config_loaded, config_substitutions, &model, false);
+        b.stop();
+        best = std::min(best, b.getElapsedSec());
+        ok &= model.objects.size() == num_objects && Slic3r::num_facets(model) == facets_stored;
+    }
+    boost::filesystem::remove(path);
+    if (! ok) {
+        std::cerr << "Failed to load " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::fixed << std::setprecision(3) << "Loaded in " << best << " s" << std::endl;
+    return EXIT_SUCCESS;
+}
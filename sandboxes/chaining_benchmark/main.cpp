@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "libslic3r/ExtrusionEntityCollection.hpp"
+#include "libslic3r/ShortestPath.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures chaining of large sets of short extrusions, as produced by support interfaces and gap fill:
+// the greedy chaining, the greedy chaining improved by a 2-opt within a budget and chaining of many
+// independent collections one by one versus in parallel. Run the same benchmark on an older revision
+// to compare with chaining over a KD tree.
+namespace Slic3r {
+
+static ExtrusionEntityCollection random_extrusions(size_t num_extrusions, double size, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<coord_t> coord(0, scaled<coord_t>(size));
+    std::uniform_int_distribution<coord_t> offset(- scaled<coord_t>(1.5), scaled<coord_t>(1.5));
+    ExtrusionEntityCollection out;
+    for (size_t i = 0; i < num_extrusions; ++ i) {
+        Point a(coord(rng), coord(rng));
+        ExtrusionPath path(erSupportMaterialInterface);
+        path.polyline = Polyline(a, a + Point(offset(rng), offset(rng)));
+        out.append(std::move(path));
+    }
+    return out;
+}
+
+static double travel_length(const ExtrusionEntitiesPtr &entities)
+{
+    double length = 0.;
+    for (size_t i = 1; i < entities.size(); ++ i)
+        length += (entities[i]->first_point() - entities[i - 1]->last_point()).cast<double>().norm();
+    return unscaled<double>(length);
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const size_t num_extrusions = argc > 1 ? size_t(std::max(2, std::atoi(argv[1]))) : 50000;
+    const size_t num_collections = 256;
+    const int    repeats         = 3;
+    const Point  start(0, 0);
+    std::mt19937 rng(0);
+
+    const ExtrusionEntityCollection large = random_extrusions(num_extrusions, 250., rng);
+    for (size_t two_opt_max_evaluations : { size_t(0), size_t(10000), size_t(100000) }) {
+        double best_time = std::numeric_limits<double>::max();
+        double length    = 0.;
+        for (int i = 0; i < repeats; ++ i) {
+            ExtrusionEntityCollection collection = large;
+            Benchmark b;
+            b.start();
+            chain_and_reorder_extrusion_entities(collection.entities, &start, two_opt_max_evaluations);
+            b.stop();
+            best_time = std::min(best_time, b.getElapsedSec());
+            length    = travel_length(collection.entities);
+        }
+        std::cout << num_extrusions << " extrusions, 2-opt budget " << std::setw(6) << two_opt_max_evaluations << ": " << std::fixed
+                  << std::setprecision(4) << best_time << " s, travel " << std::setprecision(1) << length << " mm" << std::endl;
+    }
+
+    std::vector<ExtrusionEntityCollection> collections;
+    for (size_t i = 0; i < num_collections; ++ i)
+        collections.emplace_back(random_extrusions(2000, 50., rng));
+    double best_serial   = std::numeric_limits<double>::max();
+    double best_parallel = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeats; ++ i) {
+        std::vector<ExtrusionEntityCollection> serial = collections;
+        Benchmark b;
+        b.start();
+        for (ExtrusionEntityCollection &collection : serial)
+            chain_and_reorder_extrusion_entities(collection.entities, &start);
+        b.stop();
+        best_serial = std::min(best_serial, b.getElapsedSec());
+
+        std::vector<ExtrusionEntityCollection> parallel = collections;
+        std::vector<ExtrusionEntitiesPtr*>     ptrs;
+        for (ExtrusionEntityCollection &collection : parallel)
+            ptrs.emplace_back(&collection.entities);
+        b.start();
+        chain_and_reorder_extrusion_entities_parallel(ptrs, Points(ptrs.size(), start));
+        b.stop();
+        best_parallel = std::min(best_parallel, b.getElapsedSec());
+    }
+    std::cout << num_collections << " collections of 2000 extrusions: " << std::fixed << std::setprecision(4)
+              << best_serial << " s one by one, " << best_parallel << " s in parallel" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "libslic3r/BoundingBox.hpp"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/ExPolygon.hpp"
+#include "libslic3r/Polyline.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Count the heap allocations of the whole process, the benchmark is single threaded.
+static std::atomic<size_t> g_num_allocations { 0 };
+
+void* operator new(std::size_t size)
+{
+    ++ g_num_allocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void  operator delete(void *ptr) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr) noexcept { std::free(ptr); }
+void  operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace Slic3r {
+
+static Polygon make_circle(const Point &center, double radius, size_t num_points, bool ccw)
+{
+    Polygon out;
+    out.points.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        double a = 2. * PI * double(i) / double(num_points);
+        // Wavy outline, so that the offsets produce some work for Clipper.
+        double r = radius * (1. + 0.05 * std::sin(7. * a));
+        out.points.emplace_back(center + Point(coord_t(r * std::cos(a)), coord_t(r * std::sin(a))));
+    }
+    if (! ccw)
+        out.reverse();
+    return out;
+}
+
+// A grid of islands with holes, resembling a layer slice.
+static ExPolygons make_slice(size_t num_islands, size_t num_holes, size_t num_points)
+{
+    ExPolygons out;
+    const size_t n = size_t(std::ceil(std::sqrt(double(num_islands))));
+    for (size_t i = 0; i < num_islands; ++ i) {
+        Point center(coord_t(i % n) * scaled<coord_t>(30.), coord_t(i / n) * scaled<coord_t>(30.));
+        ExPolygon expoly;
+        expoly.contour = make_circle(center, scaled<double>(12.), num_points, true);
+        for (size_t j = 0; j < num_holes; ++ j) {
+            double a = 2. * PI * double(j) / double(num_holes);
+            expoly.holes.emplace_back(make_circle(center + Point(scaled<double>(6.) * std::cos(a), scaled<double>(6.) * std::sin(a)),
+                scaled<double>(2.), num_points / 4, false));
+        }
+        out.emplace_back(std::move(expoly));
+    }
+    return out;
+}
+
+static Polylines make_infill_lines(const BoundingBox &bbox, coord_t spacing)
+{
+    Polylines out;
+    for (coord_t x = bbox.min.x(); x < bbox.max.x(); x += spacing)
+        out.emplace_back(Point(x, bbox.min.y()), Point(x + spacing / 2, bbox.max.y()));
+    return out;
+}
+
+struct Result {
+    std::string name;
+    double      seconds;
+    size_t      allocations;
+    // The same with the Clipper working data allocated from a thread local arena.
+    double      seconds_arena;
+    size_t      allocations_arena;
+};
+
+static Result measure(const std::string &name, int repeats, const std::function<size_t()> &fn)
+{
+    Result out { name, std::numeric_limits<double>::max(), 0, std::numeric_limits<double>::max(), 0 };
+    size_t sink = 0;
+    auto   run  = [&fn, &sink](double &best, size_t &allocations) {
+        size_t allocations_start = g_num_allocations;
+        Benchmark b;
+        b.start();
+        sink += fn();
+        b.stop();
+        best        = std::min(best, b.getElapsedSec());
+        allocations = g_num_allocations - allocations_start;
+    };
+    for (int i = 0; i < repeats; ++ i)
+        run(out.seconds, out.allocations);
+    {
+        ClipperLib::ArenaScope clipper_arena;
+        // The first pass populates the arena.
+        for (int i = 0; i <= repeats; ++ i)
+            run(out.seconds_arena, out.allocations_arena);
+    }
+    if (sink == 0)
+        std::cerr << name << ": empty result" << std::endl;
+    return out;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const size_t num_islands = argc > 1 ? size_t(std::max(1, std::atoi(argv[1]))) : 400;
+    const size_t num_points  = argc > 2 ? size_t(std::max(16, std::atoi(argv[2]))) : 512;
+    const int    repeats     = 5;
+
+    const ExPolygons slice     = make_slice(num_islands, 4, num_points);
+    const Polygons   polygons  = to_polygons(slice);
+    const ExPolygons shifted   = [&slice]() { ExPolygons out = slice; for (ExPolygon &expoly : out) expoly.translate(scaled<coord_t>(3.), scaled<coord_t>(2.)); return out; }();
+    const Polylines  lines     = make_infill_lines(get_extents(slice), scaled<coord_t>(0.5));
+    const float      perimeter = scaled<float>(0.45);
+
+    std::vector<Result> results;
+    results.emplace_back(measure("offset_ex(ExPolygons)", repeats, [&]() { return offset_ex(slice, - perimeter).size(); }));
+    results.emplace_back(measure("offset(ExPolygons)", repeats, [&]() { return offset(slice, - perimeter).size(); }));
+    results.emplace_back(measure("offset(Polygons)", repeats, [&]() { return offset(polygons, perimeter).size(); }));
+    results.emplace_back(measure("offset2_ex(ExPolygons)", repeats, [&]() { return offset2_ex(slice, - 2.f * perimeter, perimeter).size(); }));
+    results.emplace_back(measure("diff(ExPolygons)", repeats, [&]() { return diff(slice, shifted).size(); }));
+    results.emplace_back(measure("diff_ex(ExPolygons)", repeats, [&]() { return diff_ex(slice, shifted).size(); }));
+    results.emplace_back(measure("intersection_ex(ExPolygons)", repeats, [&]() { return intersection_ex(slice, shifted, ApplySafetyOffset::Yes).size(); }));
+    results.emplace_back(measure("union_ex(Polygons)", repeats, [&]() { return union_ex(polygons).size(); }));
+    results.emplace_back(measure("intersection_pl(Polylines)", repeats, [&]() { return intersection_pl(lines, polygons).size(); }));
+    results.emplace_back(measure("intersection_pl(Polygons)", repeats, [&]() { return intersection_pl(polygons, to_polygons(shifted)).size(); }));
+    results.emplace_back(measure("union_pt_chained_outside_in", repeats, [&]() { return union_pt_chained_outside_in(polygons).size(); }));
+
+    std::cout << num_islands << " islands, " << polygons.size() << " polygons, " << num_points << " points per contour" << std::endl;
+    std::cout << std::left << std::setw(32) << "" << std::right << std::setw(26) << "heap" << std::setw(28) << "arena" << std::endl;
+    size_t total_allocations = 0;
+    size_t total_allocations_arena = 0;
+    for (const Result &r : results) {
+        std::cout << std::left << std::setw(32) << r.name << std::right << std::fixed << std::setprecision(4)
+                  << std::setw(10) << r.seconds << " s" << std::setw(10) << r.allocations << " allocs"
+                  << std::setw(10) << r.seconds_arena << " s" << std::setw(10) << r.allocations_arena << " allocs" << std::endl;
+        total_allocations       += r.allocations;
+        total_allocations_arena += r.allocations_arena;
+    }
+    std::cout << "Total allocations: " << total_allocations << " heap, " << total_allocations_arena << " arena" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include <tbb/task_arena.h>
+
+#include "libslic3r/ExPolygon.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Surface.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures construction of the adaptive cubic infill octree and extraction of the infill lines for all layers
+// of a sphere. Run the same benchmark on an older revision to compare with the pointer based octree.
+namespace Slic3r {
+
+static FillAdaptive::OctreePtr build(const indexed_triangle_set &mesh, double line_spacing, bool support_overhangs_only, int num_threads, double &seconds)
+{
+    FillAdaptive::OctreePtr octree;
+    tbb::task_arena arena(num_threads);
+    Benchmark b;
+    b.start();
+    arena.execute([&]() { octree = FillAdaptive::build_octree(mesh, {}, line_spacing, support_overhangs_only); });
+    b.stop();
+    seconds = b.getElapsedSec();
+    return octree;
+}
+
+// Fill a square covering the sphere at each layer, returns the number of generated infill lines.
+static size_t fill_layers(FillAdaptive::Octree *octree, double radius, double layer_height, double &seconds)
+{
+    std::unique_ptr<Fill> filler(Fill::new_from_type(ipAdaptiveCubic));
+    ExPolygon square;
+    square.contour.points = { { scaled<coord_t>(- radius), scaled<coord_t>(- radius) }, { scaled<coord_t>(radius), scaled<coord_t>(- radius) },
+                              { scaled<coord_t>(radius), scaled<coord_t>(radius) }, { scaled<coord_t>(- radius), scaled<coord_t>(radius) } };
+    filler->set_bounding_box(get_extents(square));
+    filler->adapt_fill_octree = octree;
+    filler->spacing           = 0.45;
+    filler->angle             = 0.f;
+    FillParams params;
+    params.density            = 0.2f;
+    params.dont_adjust        = true;
+    size_t num_lines = 0;
+    Benchmark b;
+    b.start();
+    for (size_t layer_id = 0; layer_id * layer_height < 2. * radius; ++ layer_id) {
+        filler->layer_id = layer_id;
+        filler->z        = (layer_id + 1) * layer_height;
+        Surface surface(stInternal, square);
+        num_lines += filler->fill_surface(&surface, params).size();
+    }
+    b.stop();
+    seconds = b.getElapsedSec();
+    return num_lines;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const double radius       = argc > 1 ? std::max(1., std::atof(argv[1])) : 60.;
+    const double line_spacing = argc > 2 ? std::max(0.1, std::atof(argv[2])) : 2.;
+    const double layer_height = 0.2;
+    const int    repeats      = 3;
+    const int    num_threads  = tbb::this_task_arena::max_concurrency();
+
+    // The sphere stands on the print bed, rotated to the coordinate system of the octree the same way PrintObject does.
+    indexed_triangle_set mesh = its_make_sphere(radius, PI / 180.);
+    its_transform(mesh, Transform3d(FillAdaptive::transform_to_octree().toRotationMatrix() * Eigen::Translation3d(0., 0., radius)), true);
+    std::cout << "Sphere of radius " << radius << " mm, " << mesh.indices.size() << " triangles, line spacing " << line_spacing << " mm" << std::endl;
+
+    for (bool support_overhangs_only : { false, true }) {
+        double best_serial   = std::numeric_limits<double>::max();
+        double best_parallel = std::numeric_limits<double>::max();
+        double best_fill     = std::numeric_limits<double>::max();
+        size_t num_lines     = 0;
+        for (int i = 0; i < repeats; ++ i) {
+            double seconds;
+            build(mesh, line_spacing, support_overhangs_only, 1, seconds);
+            best_serial = std::min(best_serial, seconds);
+            FillAdaptive::OctreePtr octree = build(mesh, line_spacing, support_overhangs_only, num_threads, seconds);
+            best_parallel = std::min(best_parallel, seconds);
+            num_lines = fill_layers(octree.get(), radius, layer_height, seconds);
+            best_fill = std::min(best_fill, seconds);
+        }
+        std::cout << (support_overhangs_only ? "Support cubic:  " : "Adaptive cubic: ") << std::fixed << std::setprecision(4)
+                  << "build " << best_serial << " s (1 thread), " << best_parallel << " s (" << num_threads << " threads), "
+                  << "fill " << best_fill << " s, " << num_lines << " infill lines" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+static GCodeProcessor::Result process(const std::string &path, bool parallel, double &elapsed, std::string &time_normal, std::string &time_stealth)
+{
+    GCodeProcessor processor;
+    processor.enable_producers(true);
+    processor.enable_parallel_parsing(parallel);
+    Benchmark b;
+    b.start();
+    processor.process_file(path, false);
+    b.stop();
+    elapsed      = b.getElapsedSec();
+    time_normal  = processor.get_time_dhm(PrintEstimatedStatistics::ETimeMode::Normal);
+    time_stealth = processor.get_time_dhm(PrintEstimatedStatistics::ETimeMode::Stealth);
+    return processor.extract_result();
+}
+
+static bool same_moves(const GCodeProcessor::Result &r1, const GCodeProcessor::Result &r2)
+{
+    if (r1.moves.size() != r2.moves.size())
+        return false;
+    for (size_t i = 0; i < r1.moves.size(); ++ i) {
+        const GCodeProcessor::MoveVertex &m1 = r1.moves[i];
+        const GCodeProcessor::MoveVertex &m2 = r2.moves[i];
+        if (m1.type != m2.type || m1.extrusion_role != m2.extrusion_role || m1.extruder_id != m2.extruder_id || m1.cp_color_id != m2.cp_color_id ||
+            m1.position != m2.position || m1.delta_extruder != m2.delta_extruder || m1.feedrate != m2.feedrate ||
+            m1.width != m2.width || m1.height != m2.height || m1.mm3_per_mm != m2.mm3_per_mm ||
+            m1.fan_speed != m2.fan_speed || m1.temperature != m2.temperature || m1.time != m2.time)
+            return false;
+    }
+    return true;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: gcode_processor_benchmark <file.gcode> [repeats]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string path    = argv[1];
+    const int         repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+
+    double      best_serial   = std::numeric_limits<double>::max();
+    double      best_parallel = std::numeric_limits<double>::max();
+    bool        identical     = true;
+    std::string time_serial, time_parallel;
+    size_t      moves_count   = 0;
+    size_t      moves_memsize = 0;
+    for (int i = 0; i < repeats; ++ i) {
+        double      elapsed;
+        std::string normal_serial, stealth_serial, normal_parallel, stealth_parallel;
+        GCodeProcessor::Result serial   = process(path, false, elapsed, normal_serial, stealth_serial);
+        best_serial = std::min(best_serial, elapsed);
+        GCodeProcessor::Result parallel = process(path, true, elapsed, normal_parallel, stealth_parallel);
+        best_parallel = std::min(best_parallel, elapsed);
+        if (! same_moves(serial, parallel) || normal_serial != normal_parallel || stealth_serial != stealth_parallel)
+            identical = false;
+        time_serial   = normal_serial;
+        time_parallel = normal_parallel;
+        if (i + 1 == repeats) {
+            moves_count   = serial.moves.size();
+            moves_memsize = serial.moves.memsize();
+            std::cout << "Moves: " << moves_count << ", extruders: " << serial.extruders_count << std::endl;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Serial parsing:   " << best_serial   << " s, estimated time " << time_serial   << std::endl
+              << "Parallel parsing: " << best_parallel << " s, estimated time " << time_parallel << std::endl
+              << "Speedup: " << best_serial / best_parallel << std::endl
+              << "Moves memory: " << moves_memsize << " B, " << double(moves_memsize) / double(std::max<size_t>(1, moves_count)) << " B per move, "
+              << moves_count * sizeof(GCodeProcessor::MoveVertex) << " B as a vector of MoveVertex" << std::endl;
+
+    // The unique attribute combinations have to be few compared to the moves for the compact storage to pay off.
+    if (moves_count > 0 && moves_memsize >= moves_count * sizeof(GCodeProcessor::MoveVertex)) {
+        std::cerr << "The compact storage of the moves is not smaller than a vector of MoveVertex!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (! identical) {
+        std::cerr << "Serial and parallel processing produced different results!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Serial and parallel processing produced identical results." << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "libslic3r/GCodeWriter.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+// Formatting of a G1 extrusion move as done by GCodeWriter::extrude_to_xy() before GCodeFormatter was introduced.
+static std::string extrude_to_xy_ostringstream(const Vec2d &point, double e)
+{
+    std::ostringstream gcode;
+    gcode << "G1 X" << std::fixed << std::setprecision(3) << point.x()
+          <<   " Y" << std::fixed << std::setprecision(3) << point.y()
+          <<   " E" << std::fixed << std::setprecision(5) << e;
+    gcode << "\n";
+    return gcode.str();
+}
+
+static std::string extrude_to_xy_formatter(const Vec2d &point, double e)
+{
+    GCodeG1Formatter w;
+    w.emit_xy(point);
+    w.emit_e("E", e);
+    return w.string();
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const size_t num_moves = argc > 1 ? size_t(std::atoll(argv[1])) : 1000000;
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> dist_xy(0., 250.);
+    std::uniform_real_distribution<double> dist_e(0., 0.1);
+    std::vector<Vec2d> points;
+    points.reserve(num_moves);
+    for (size_t i = 0; i < num_moves; ++ i)
+        points.emplace_back(dist_xy(rng), dist_xy(rng));
+
+    Benchmark b;
+    auto measure = [&b, &points, &dist_e](const char *name, auto fn) {
+        // Fixed seed, so that all the measurements format the same E values.
+        std::mt19937 rng(1);
+        double e = 0.;
+        size_t total_length = 0;
+        b.start();
+        for (const Vec2d &pt : points) {
+            e += dist_e(rng);
+            total_length += fn(pt, e).size();
+        }
+        b.stop();
+        std::cout << std::left << std::setw(32) << name << b.getElapsedSec() << " s, "
+                  << b.getElapsedSec() * 1e6 / double(points.size()) << " s per million G1 moves ("
+                  << total_length << " bytes)" << std::endl;
+    };
+
+    measure("std::ostringstream",  extrude_to_xy_ostringstream);
+    measure("GCodeG1Formatter",    extrude_to_xy_formatter);
+
+    GCodeWriter writer;
+    writer.set_extruders({ 0 });
+    writer.set_extruder(0);
+    measure("GCodeWriter::extrude_to_xy()", [&writer](const Vec2d &pt, double /* e */) { return writer.extrude_to_xy(pt, 0.05); });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+// Measures the infill generation (posInfill) of large flat plates: Each plate is a grid of tiles, thus each layer
+// consists of many islands filled with solid infill. Optionally the plate is repeated as identical objects.
+// Run the same benchmark on an older revision to compare with the serial infill generation inside a layer.
+namespace Slic3r {
+
+static indexed_triangle_set make_plate(double size, double tile, double height)
+{
+    indexed_triangle_set out;
+    const int n = std::max(1, int(size / tile));
+    for (int i = 0; i < n; ++ i)
+        for (int j = 0; j < n; ++ j) {
+            indexed_triangle_set cube = its_make_cube(tile * 0.8, tile * 0.8, height);
+            for (Vec3f &v : cube.vertices)
+                v += Vec3f(float(i * tile), float(j * tile), 0.f);
+            its_merge(out, cube);
+        }
+    return out;
+}
+
+// Returns the sum of the posInfill wall times of all objects and the maximum posInfill wall time of a single object.
+static std::pair<double, double> measure(const indexed_triangle_set &plate, double size, size_t num_objects, const DynamicPrintConfig &config)
+{
+    Model model;
+    for (size_t i = 0; i < num_objects; ++ i) {
+        ModelObject *object = model.add_object();
+        object->name = "plate" + std::to_string(i);
+        object->add_volume(TriangleMesh(plate));
+        object->add_instance()->set_offset(Vec3d(double(i) * (size + 10.), 0., 0.));
+        object->ensure_on_bed();
+    }
+    Print print;
+    for (ModelObject *object : model.objects)
+        print.auto_assign_extruders(object);
+    print.apply(model, config);
+    print.set_status_silent();
+    print.set_step_stats_enabled(true);
+    print.process();
+    double sum = 0.;
+    double max = 0.;
+    for (const PrintStepStats &stats : print.step_stats())
+        if (stats.step_name == "posInfill") {
+            sum += stats.wall_time;
+            max  = std::max(max, stats.wall_time);
+        }
+    return { sum, max };
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const double size        = argc > 1 ? std::max(10., std::atof(argv[1])) : 200.;
+    const double tile        = argc > 2 ? std::max(1., std::atof(argv[2])) : 10.;
+    const size_t num_objects = argc > 3 ? size_t(std::max(1, std::atoi(argv[3]))) : 4;
+    const int    repeats     = 3;
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "layer_height",       0.2 },
+        { "first_layer_height", 0.2 },
+        { "skirts",             0 },
+        { "fill_density",       "20%" },
+        { "top_solid_layers",   3 },
+        { "bottom_solid_layers", 3 }
+    });
+    const indexed_triangle_set plate = make_plate(size, tile, 1.2);
+    std::cout << "Plate " << size << " x " << size << " mm of " << tile << " mm tiles, " << plate.indices.size() << " triangles" << std::endl;
+
+    for (size_t n : { size_t(1), num_objects }) {
+        double best_sum = std::numeric_limits<double>::max();
+        double best_max = std::numeric_limits<double>::max();
+        for (int i = 0; i < repeats; ++ i) {
+            auto [sum, max] = measure(plate, size, n, config);
+            best_sum = std::min(best_sum, sum);
+            best_max = std::min(best_max, max);
+        }
+        std::cout << std::setw(3) << n << " objects: posInfill " << std::fixed << std::setprecision(4)
+                  << best_sum << " s total, " << best_max << " s slowest object" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "libslic3r/ExPolygon.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Surface.hpp"
+#include "libslic3r/Fill/FillBase.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures ordering of the monotonic infill regions on surfaces split into many regions: a plate perforated
+// by a grid of round holes and a row of comb shaped letters. For each quality level the time and the length
+// of the resulting path are reported, the length being the extrusion length plus the travels between the extrusions.
+namespace Slic3r {
+
+static ExPolygon perforated_plate(int num_holes, double pitch)
+{
+    const double size = num_holes * pitch;
+    ExPolygon plate(Polygon::new_scale({ { 0., 0. }, { size, 0. }, { size, size }, { 0., size } }));
+    const int    num_segments = 24;
+    const double radius       = 0.3 * pitch;
+    for (int i = 0; i < num_holes; ++ i)
+        for (int j = 0; j < num_holes; ++ j) {
+            Polygon hole;
+            for (int k = num_segments; k > 0; -- k) {
+                double a = 2. * PI * double(k) / double(num_segments);
+                hole.points.emplace_back(scaled<coord_t>((i + 0.5) * pitch + radius * cos(a)), scaled<coord_t>((j + 0.5) * pitch + radius * sin(a)));
+            }
+            plate.holes.emplace_back(std::move(hole));
+        }
+    return plate;
+}
+
+// Letter "E" like combs with many teeth, each tooth is a monotonic region of its own.
+static ExPolygons combs(int num_combs, int num_teeth)
+{
+    ExPolygons out;
+    const double tooth  = 1.;
+    const double height = 2. * num_teeth * tooth;
+    for (int c = 0; c < num_combs; ++ c) {
+        const double x0 = c * 12.;
+        Points pts { { scaled<coord_t>(x0), 0 } };
+        for (int t = 0; t < num_teeth; ++ t) {
+            const double y = 2. * t * tooth;
+            pts.emplace_back(scaled<coord_t>(x0 + 10.), scaled<coord_t>(y));
+            pts.emplace_back(scaled<coord_t>(x0 + 10.), scaled<coord_t>(y + tooth));
+            pts.emplace_back(scaled<coord_t>(x0 + 2.),  scaled<coord_t>(y + tooth));
+            pts.emplace_back(scaled<coord_t>(x0 + 2.),  scaled<coord_t>(y + 2. * tooth));
+        }
+        pts.emplace_back(scaled<coord_t>(x0 + 10.), scaled<coord_t>(height));
+        pts.emplace_back(scaled<coord_t>(x0 + 10.), scaled<coord_t>(height + tooth));
+        pts.emplace_back(scaled<coord_t>(x0),       scaled<coord_t>(height + tooth));
+        out.emplace_back(Polygon(std::move(pts)));
+    }
+    return out;
+}
+
+static double path_length(const Polylines &polylines)
+{
+    double length = 0.;
+    for (size_t i = 0; i < polylines.size(); ++ i) {
+        length += polylines[i].length();
+        if (i > 0)
+            length += (polylines[i].first_point() - polylines[i - 1].last_point()).cast<double>().norm();
+    }
+    return unscaled<double>(length);
+}
+
+static void run(const std::string &name, const ExPolygons &expolygons, int repeats)
+{
+    std::unique_ptr<Fill> filler(Fill::new_from_type(ipMonotonic));
+    filler->spacing = 0.45;
+    filler->angle   = float(PI / 4.);
+    FillParams params;
+    params.density  = 1.f;
+    for (auto [quality, quality_name] : { std::make_pair(MonotonicQuality::Fast, "fast"), std::make_pair(MonotonicQuality::Normal, "normal"), std::make_pair(MonotonicQuality::Best, "best") }) {
+        params.monotonic_quality = quality;
+        double best_time = std::numeric_limits<double>::max();
+        double length    = 0.;
+        for (int i = 0; i < repeats; ++ i) {
+            Polylines polylines;
+            Benchmark b;
+            b.start();
+            for (const ExPolygon &expolygon : expolygons) {
+                Surface surface(stInternalSolid, expolygon);
+                filler->bounding_box = get_extents(expolygon);
+                append(polylines, filler->fill_surface(&surface, params));
+            }
+            b.stop();
+            best_time = std::min(best_time, b.getElapsedSec());
+            length    = path_length(polylines);
+        }
+        std::cout << std::setw(20) << std::left << name << std::setw(8) << quality_name << std::right << std::fixed
+                  << std::setprecision(4) << best_time << " s, path length " << std::setprecision(1) << length << " mm" << std::endl;
+    }
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const int num_holes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const int num_teeth = argc > 2 ? std::max(1, std::atoi(argv[2])) : 40;
+    const int repeats   = 3;
+
+    run("perforated plate", { perforated_plate(num_holes, 5.) }, repeats);
+    run("combs", combs(10, num_teeth), repeats);
+    return EXIT_SUCCESS;
+}
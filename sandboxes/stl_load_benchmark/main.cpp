@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "libslic3r/Format/STL.hpp"
+#include "admesh/stl.h"
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+// Random triangle soup, the loader does not care about the mesh topology.
+static stl_file random_stl(size_t num_facets)
+{
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> coord(-100.f, 100.f);
+    stl_file                              stl;
+    stl.stats.type             = inmemory;
+    stl.stats.number_of_facets = uint32_t(num_facets);
+    stl_allocate(&stl);
+    for (stl_facet &facet : stl.facet_start) {
+        for (stl_vertex &v : facet.vertex)
+            v = stl_vertex(coord(rng), coord(rng), coord(rng));
+        facet.extra[0] = facet.extra[1] = 0;
+        stl_calculate_normal(facet.normal, &facet);
+        stl_normalize_vector(facet.normal);
+    }
+    stl_get_size(&stl);
+    return stl;
+}
+
+static bool same_stl(const stl_file &stl1, const stl_file &stl2)
+{
+    if (stl1.facet_start.size() != stl2.facet_start.size() || stl1.stats.number_of_facets != stl2.stats.number_of_facets ||
+        stl1.stats.type != stl2.stats.type || stl1.stats.min != stl2.stats.min || stl1.stats.max != stl2.stats.max ||
+        stl1.stats.shortest_edge != stl2.stats.shortest_edge || strcmp(stl1.stats.header, stl2.stats.header) != 0)
+        return false;
+    for (size_t i = 0; i < stl1.facet_start.size(); ++ i)
+        if (memcmp(&stl1.facet_start[i], &stl2.facet_start[i], SIZEOF_STL_FACET - 2) != 0)
+            return false;
+    return true;
+}
+
+// Returns false if the two loaders produced different results.
+static bool measure(const std::string &path, const char *label, int repeats)
+{
+    double best_admesh = std::numeric_limits<double>::max();
+    double best_mapped = std::numeric_limits<double>::max();
+    bool   identical   = true;
+    for (int i = 0; i < repeats; ++ i) {
+        Benchmark b;
+        stl_file  stl_admesh, stl_mapped;
+        b.start();
+        stl_open(&stl_admesh, path.c_str());
+        b.stop();
+        best_admesh = std::min(best_admesh, b.getElapsedSec());
+        b.start();
+        read_stl_file(path.c_str(), stl_mapped);
+        b.stop();
+        best_mapped = std::min(best_mapped, b.getElapsedSec());
+        identical &= same_stl(stl_admesh, stl_mapped);
+    }
+    std::cout << std::fixed << std::setprecision(3) << label << ": admesh " << best_admesh << " s, memory mapped " << best_mapped << " s, speedup " 
+              << best_admesh / best_mapped << (identical ? "" : " (DIFFERENT RESULTS!)") << std::endl;
+    return identical;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++ i)
+        sizes.emplace_back(size_t(std::max(1, std::atoi(argv[i]))));
+    if (sizes.empty())
+        sizes = { 1000000, 10000000 };
+    const int repeats = 3;
+
+    bool identical = true;
+    boost::filesystem::path dir = boost::filesystem::temp_directory_path();
+    for (size_t num_facets : sizes) {
+        std::cout << "Generating " << num_facets << " facets" << std::endl;
+        stl_file    stl         = random_stl(num_facets);
+        std::string path_binary = (dir / boost::filesystem::unique_path("stl_load_benchmark-%%%%-%%%%.stl")).string();
+        std::string path_ascii  = (dir / boost::filesystem::unique_path("stl_load_benchmark-%%%%-%%%%.stl")).string();
+        stl_write_binary(&stl, path_binary.c_str(), "stl_load_benchmark");
+        stl_write_ascii(&stl, path_ascii.c_str(), "stl_load_benchmark");
+        stl.clear();
+        identical &= measure(path_binary, "Binary STL", repeats);
+        identical &= measure(path_ascii,  "ASCII STL ", repeats);
+        boost::filesystem::remove(path_binary);
+        boost::filesystem::remove(path_ascii);
+    }
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -17,7 +17,9 @@
     #endif /* SLIC3R_GUI */
 #endif /* WIN32 */
 
+#include <chrono>
 #include <cstdio>
+#include <iomanip>
 #include <string>
 #include <cstring>
 #include <iostream>
@@ -26,6 +28,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/nowide/iostream.hpp>
 #include <boost/nowide/integration/filesystem.hpp>
 #include <boost/dll/runtime_symbol_info.hpp>
@@ -223,6 +226,11 @@ int CLI::run(int argc, char **argv)
         printer_technology = std::find(m_actions.begin(), m_actions.end(), "export_sla") == m_actions.end() ? ptFFF : ptSLA;
     m_print_config.option<ConfigOptionEnum<PrinterTechnology>>("printer_technology", true)->value = printer_technology;
 
+    // The --batch action composes the configuration of each job from the configuration before being completed with the defaults.
+    DynamicPrintConfig batch_base_config;
+    if (std::find(m_actions.begin(), m_actions.end(), "batch") != m_actions.end())
+        batch_base_config = m_print_config;
+
     // Initialize full print configs for both the FFF and SLA technologies.
     FullPrintConfig    fff_print_config;
     SLAFullPrintConfig sla_print_config;
@@ -509,8 +517,12 @@ int CLI::run(int argc, char **argv)
                 if (printer_technology == ptFFF) {
                     for (auto* mo : model.objects)
                         fff_print.auto_assign_extruders(mo);
+                    fff_print.set_object_cache_dir(m_config.opt_string("cache_dir"));
                 }
                 print->apply(model, m_print_config);
+                const std::string &step_stats_path = m_config.opt_string("step_stats");
+                const std::string &step_trace_path = m_config.opt_string("step_trace");
+                print->set_step_stats_enabled(! step_stats_path.empty() || ! step_trace_path.empty());
                 std::string err = print->validate();
                 if (! err.empty()) {
                     boost::nowide::cerr << err << std::endl;
@@ -542,6 +554,16 @@ int CLI::run(int argc, char **argv)
                         // Run the post-processing scripts if defined.
                         run_post_process_scripts(outfile, fff_print.full_print_config());
                         boost::nowide::cout << "Slicing result exported to " << outfile << std::endl;
+                        auto export_step_stats = [print](const std::string &path, void (*exporter)(const std::vector<PrintStepStats>&, std::ostream&)) {
+                            boost::nowide::ofstream file(path);
+                            exporter(print->step_stats(), file);
+                            if (! file)
+                                throw Slic3r::RuntimeError("Failed writing the step statistics into " + path);
+                        };
+                        if (! step_stats_path.empty())
+                            export_step_stats(step_stats_path, export_step_stats_json);
+                        if (! step_trace_path.empty())
+                            export_step_stats(step_trace_path, export_step_stats_chrome_trace);
                     } catch (const std::exception &ex) {
                         boost::nowide::cerr << ex.what() << std::endl;
                         return 1;
@@ -577,6 +599,13 @@ int CLI::run(int argc, char **argv)
                     << " (" << print.total_extruded_volume()/1000 << "cm3)" << std::endl;
 */
             }
+        } else if (opt_key == "batch") {
+            if (printer_technology != ptFFF) {
+                boost::nowide::cerr << "error: batch slicing is only supported for FFF configurations" << std::endl;
+                return 1;
+            }
+            if (! this->run_batch(batch_base_config, config_substitution_rule))
+                return 1;
         } else {
             boost::nowide::cerr << "error: option not supported yet: " << opt_key << std::endl;
             return 1;
@@ -695,6 +724,8 @@ bool CLI::setup(int argc, char **argv)
             m_config.option(optdef.first, true);
 
     set_data_dir(m_config.opt_string("datadir"));
+    if (const std::string &cache_dir = m_config.opt_string("cache_dir"); ! cache_dir.empty())
+        Model::set_cache_dir((boost::filesystem::path(cache_dir) / "models").string());
     
     //FIXME Validating at this stage most likely does not make sense, as the config is not fully initialized yet.
     if (!validity.empty()) {
@@ -772,6 +803,182 @@ bool CLI::export_models(IO::ExportFormat format)
     return true;
 }
 
+// Split a batch job line into arguments the way a shell would do it for the simple cases:
+// Arguments are separated by white space, single or double quotes group arguments containing white space.
+static std::vector<std::string> split_batch_job_line(const std::string &line)
+{
+    std::vector<std::string> out;
+    std::string              arg;
+    bool                     has_arg = false;
+    char                     quote   = 0;
+    for (char c : line) {
+        if (quote != 0) {
+            if (c == quote)
+                quote = 0;
+            else
+                arg += c;
+        } else if (c == '"' || c == '\'') {
+            quote   = c;
+            has_arg = true;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (has_arg) {
+                out.emplace_back(std::move(arg));
+                arg.clear();
+                has_arg = false;
+            }
+        } else {
+            arg += c;
+            has_arg = true;
+        }
+    }
+    if (has_arg)
+        out.emplace_back(std::move(arg));
+    return out;
+}
+
+bool CLI::run_batch(const DynamicPrintConfig &base_config, ForwardCompatibilitySubstitutionRule config_substitution_rule)
+{
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point t0, clock::time_point t1) { return std::chrono::duration<double>(t1 - t0).count(); };
+
+    // The Print is reused by all the jobs, so that Print::apply() only invalidates the steps affected by the difference
+    // between the consecutive jobs. For the same reason the Model is only reloaded if the input files change,
+    // otherwise the ObjectIDs of the Model would change and Print::apply() would have to start from scratch.
+    // Each job arranges and assigns extruders to its own copy of the loaded Model, which keeps the ObjectIDs,
+    // so that a job is not affected by the modifications made by the previous jobs.
+    Print                    print;
+    Model                    loaded_model;
+    DynamicPrintConfig       model_config;
+    std::vector<std::string> model_files;
+    std::vector<std::time_t> model_timestamps;
+
+    bool        all_succeeded = true;
+    size_t      job_idx       = 0;
+    std::string line;
+    while (std::getline(boost::nowide::cin, line)) {
+        std::vector<std::string> args = split_batch_job_line(line);
+        if (args.empty() || boost::starts_with(args.front(), "#"))
+            // Skip empty lines and comments.
+            continue;
+        ++ job_idx;
+        const clock::time_point t_start = clock::now();
+        try {
+            // Parse the job with the command line parser.
+            args.insert(args.begin(), "prusa-slicer");
+            std::vector<const char*> argv;
+            for (const std::string &arg : args)
+                argv.emplace_back(arg.c_str());
+            DynamicPrintAndCLIConfig job;
+            std::vector<std::string> input_files;
+            t_config_option_keys     opt_order;
+            if (! job.read_cli(int(argv.size()), argv.data(), &input_files, &opt_order))
+                throw Slic3r::RuntimeError("Invalid job options");
+            for (const std::string &opt_key : opt_order)
+                if (cli_actions_config_def.has(opt_key) || (cli_transform_config_def.has(opt_key) && opt_key != "dont_arrange"))
+                    throw Slic3r::RuntimeError("Option \"" + opt_key + "\" is not supported by a batch job");
+            if (input_files.empty())
+                throw Slic3r::RuntimeError("No input file");
+
+            // Load the model, unless the same files were loaded by the previous job.
+            std::vector<std::time_t> timestamps;
+            for (const std::string &file : input_files) {
+                if (! boost::filesystem::exists(file))
+                    throw Slic3r::RuntimeError("No such file: " + file);
+                timestamps.emplace_back(boost::filesystem::last_write_time(file));
+            }
+            if (input_files != model_files || timestamps != model_timestamps) {
+                model_files.clear();
+                model_timestamps.clear();
+                loaded_model.clear_objects();
+                loaded_model.clear_materials();
+                model_config.clear();
+                for (const std::string &file : input_files) {
+                    DynamicPrintConfig        config;
+                    ConfigSubstitutionContext config_substitutions(config_substitution_rule);
+                    Model                     loaded = Model::read_from_file(file, &config, &config_substitutions, Model::LoadAttribute::AddDefaultInstances);
+                    if (get_printer_technology(config) == ptSLA)
+                        throw Slic3r::RuntimeError("Mixing configurations for FFF and SLA technologies");
+                    if (loaded.objects.empty())
+                        throw Slic3r::RuntimeError("File is empty: " + file);
+                    for (ModelObject *o : loaded.objects)
+                        loaded_model.add_object(*o);
+                    model_config.apply(config);
+                }
+                model_files      = input_files;
+                model_timestamps = std::move(timestamps);
+            }
+            Model model = loaded_model;
+
+            // Compose the configuration the same way CLI::run() does: Values loaded from the model files
+            // are overridden by the command line of the batch process, then by --load files of the job
+            // and then by the print options of the job.
+            DynamicPrintConfig config = model_config;
+            config.apply(base_config);
+            for (const std::string &file : job.option<ConfigOptionStrings>("load", true)->values) {
+                DynamicPrintConfig loaded;
+                loaded.load(file, config_substitution_rule);
+                loaded.normalize_fdm();
+                if (get_printer_technology(loaded) == ptSLA)
+                    throw Slic3r::RuntimeError("Mixing configurations for FFF and SLA technologies");
+                config.apply(loaded);
+            }
+            {
+                DynamicPrintConfig job_print_config;
+                job_print_config.apply(job, true);
+                config.apply(job_print_config, true);
+            }
+            config.normalize_fdm();
+            config.option<ConfigOptionEnum<PrinterTechnology>>("printer_technology", true)->value = ptFFF;
+            {
+                FullPrintConfig full_config;
+                full_config.apply(config, true);
+                config.apply(full_config, true);
+            }
+            if (std::string validity = config.validate(); ! validity.empty())
+                throw Slic3r::RuntimeError("The composite configation is not valid: " + validity);
+
+            if (! job.opt_bool("dont_arrange")) {
+                ArrangeParams arrange_cfg;
+                arrange_cfg.min_obj_distance = scaled(min_object_distance(config));
+                arrange_objects(model, get_bed_shape(config), arrange_cfg);
+            }
+            for (ModelObject *mo : model.objects)
+                print.auto_assign_extruders(mo);
+            const std::string &cache_dir = job.has("cache_dir") ? job.opt_string("cache_dir") : m_config.opt_string("cache_dir");
+            print.set_object_cache_dir(cache_dir);
+            const clock::time_point t_loaded = clock::now();
+
+            print.apply(model, config);
+            if (std::string err = print.validate(); ! err.empty())
+                throw Slic3r::RuntimeError(err);
+            if (print.empty())
+                throw Slic3r::RuntimeError("Nothing to print. Either the print is empty or no object is fully inside the print volume.");
+            print.process();
+            const clock::time_point t_sliced = clock::now();
+
+            // The outfile is processed by a PlaceholderParser.
+            std::string outfile       = print.export_gcode(job.has("output") ? job.opt_string("output") : std::string(), nullptr, nullptr);
+            std::string outfile_final = print.print_statistics().finalize_output_path(outfile);
+            if (outfile != outfile_final) {
+                if (Slic3r::rename_file(outfile, outfile_final))
+                    throw Slic3r::RuntimeError("Renaming file " + outfile + " to " + outfile_final + " failed");
+                outfile = outfile_final;
+            }
+            run_post_process_scripts(outfile, print.full_print_config());
+            const clock::time_point t_exported = clock::now();
+
+            boost::nowide::cout << "Job " << job_idx << ": Slicing result exported to " << outfile << std::fixed << std::setprecision(3) <<
+                " (load " << seconds(t_start, t_loaded) << "s, slice " << seconds(t_loaded, t_sliced) << "s, export " << seconds(t_sliced, t_exported) <<
+                "s, total " << seconds(t_start, t_exported) << "s)" << std::endl;
+        } catch (const std::exception &ex) {
+            all_succeeded = false;
+            boost::nowide::cout << "Job " << job_idx << " failed: " << ex.what() << std::fixed << std::setprecision(3) <<
+                " (total " << seconds(t_start, clock::now()) << "s)" << std::endl;
+        }
+    }
+    return all_succeeded;
+}
+
 std::string CLI::output_filepath(const Model &model, IO::ExportFormat format) const
 {
     std::string ext;
@@ -37,6 +37,11 @@ private:
     
     /// Exports loaded models to a file of the specified format, according to the options affecting output filename.
     bool export_models(IO::ExportFormat format);
+
+    /// Slices the jobs read from stdin one by one, see the --batch action.
+    /// base_config is the print configuration from the command line and --load files before being completed with the defaults.
+    /// Returns false if any of the jobs failed.
+    bool run_batch(const DynamicPrintConfig &base_config, ForwardCompatibilitySubstitutionRule config_substitution_rule);
     
     bool has_print_action() const { return m_config.opt_bool("export_gcode") || m_config.opt_bool("export_sla"); }
     
@@ -34,8 +34,66 @@
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
 #include "stl.h"
 
+// Maximum of the absolute differences of the edge vertex coordinates, used to estimate the shortest edge.
+static inline float edge_max_diff(const stl_vertex &a, const stl_vertex &b)
+{
+	stl_vertex diff = (a - b).cwiseAbs();
+	return std::max(diff(0), std::max(diff(1), diff(2)));
+}
+
+// Fill in the key of an edge for exact matching: the edge vertices sorted lexicographically.
+// Returns true if the edge was stored backwards.
+static inline bool edge_key_exact(const stl_vertex *a, const stl_vertex *b, uint32_t key[6])
+{
+  	// Ensure identical vertex ordering of equal edges.
+  	// This method is numerically robust.
+	bool backwards = ! ((*a)(0) != (*b)(0) ? (*a)(0) < (*b)(0) : ((*a)(1) != (*b)(1) ? (*a)(1) < (*b)(1) : (*a)(2) < (*b)(2)));
+  	if (backwards)
+	    std::swap(a, b);
+  	memcpy(&key[0], a->data(), sizeof(stl_vertex));
+  	memcpy(&key[3], b->data(), sizeof(stl_vertex));
+  	// Switch negative zeros to positive zeros, so memcmp will consider them to be equal.
+  	for (size_t i = 0; i < 6; ++ i) {
+    	unsigned char *p = (unsigned char*)(key + i);
+#if BOOST_ENDIAN_LITTLE_BYTE
+    	if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 0x80)
+      		// Negative zero, switch to positive zero.
+      		p[3] = 0;
+#else /* BOOST_ENDIAN_LITTLE_BYTE */
+    	if (p[0] == 0x80 && p[1] == 0 && p[2] == 0 && p[3] == 0)
+      		// Negative zero, switch to positive zero.
+      		p[0] = 0;
+#endif /* BOOST_ENDIAN_LITTLE_BYTE */
+  	}
+	return backwards;
+}
+
+// Record facet_b as a neighbor of facet_a over edge which_edge_a and vice versa.
+// which_edge_a / which_edge_b are increased by 3 if the edge is stored backwards.
+static void stl_connect_neighbors(stl_file *stl, int facet_a, int which_edge_a, int facet_b, int which_edge_b)
+{
+	// Facet a's neighbor is facet b
+	stl->neighbors_start[facet_a].neighbor[which_edge_a % 3] = facet_b;	/* sets the .neighbor part */
+	stl->neighbors_start[facet_a].which_vertex_not[which_edge_a % 3] = (which_edge_b + 2) % 3; /* sets the .which_vertex_not part */
+
+	// Facet b's neighbor is facet a
+	stl->neighbors_start[facet_b].neighbor[which_edge_b % 3] = facet_a;	/* sets the .neighbor part */
+	stl->neighbors_start[facet_b].which_vertex_not[which_edge_b % 3] = (which_edge_a + 2) % 3; /* sets the .which_vertex_not part */
+
+	if (((which_edge_a < 3) && (which_edge_b < 3)) || ((which_edge_a > 2) && (which_edge_b > 2))) {
+		// These facets are oriented in opposite directions, their normals are probably messed up.
+		stl->neighbors_start[facet_a].which_vertex_not[which_edge_a % 3] += 3;
+		stl->neighbors_start[facet_b].which_vertex_not[which_edge_b % 3] += 3;
+	}
+}
+
 struct HashEdge {
 	// Key of a hash edge: sorted vertices of the edge.
 	uint32_t       key[6];
@@ -53,35 +111,10 @@ struct HashEdge {
 
 	void load_exact(stl_file *stl, const stl_vertex *a, const stl_vertex *b)
 	{
-		{
-	    	stl_vertex diff = (*a - *b).cwiseAbs();
-	    	float max_diff = std::max(diff(0), std::max(diff(1), diff(2)));
-	    	stl->stats.shortest_edge = std::min(max_diff, stl->stats.shortest_edge);
-	  	}
-
-	  	// Ensure identical vertex ordering of equal edges.
-	  	// This method is numerically robust.
-	  	if (vertex_lower(*a, *b)) {
-	  	} else {
+    	stl->stats.shortest_edge = std::min(edge_max_diff(*a, *b), stl->stats.shortest_edge);
+	  	if (edge_key_exact(a, b, this->key))
 	  		// This edge is loaded backwards.
-		    std::swap(a, b);
 		    this->which_edge += 3;
-	  	}
-	  	memcpy(&this->key[0], a->data(), sizeof(stl_vertex));
-	  	memcpy(&this->key[3], b->data(), sizeof(stl_vertex));
-	  	// Switch negative zeros to positive zeros, so memcmp will consider them to be equal.
-	  	for (size_t i = 0; i < 6; ++ i) {
-	    	unsigned char *p = (unsigned char*)(this->key + i);
-	#if BOOST_ENDIAN_LITTLE_BYTE
-	    	if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 0x80)
-	      		// Negative zero, switch to positive zero.
-	      		p[3] = 0;
-	#else /* BOOST_ENDIAN_LITTLE_BYTE */
-	    	if (p[0] == 0x80 && p[1] == 0 && p[2] == 0 && p[3] == 0)
-	      		// Negative zero, switch to positive zero.
-	      		p[0] = 0;
-	#endif /* BOOST_ENDIAN_LITTLE_BYTE */
-	  	}
 	}
 
 	bool load_nearby(const stl_file *stl, const stl_vertex &a, const stl_vertex &b, float tolerance)
@@ -112,12 +145,6 @@ struct HashEdge {
 		}
 		return true;
 	}
-
-private:
-	inline bool vertex_lower(const stl_vertex &a, const stl_vertex &b) {
-	  	return (a(0) != b(0)) ? (a(0) < b(0)) :
-	           ((a(1) != b(1)) ? (a(1) < b(1)) : (a(2) < b(2)));
-	}
 };
 
 struct HashTableEdges {
@@ -241,19 +268,7 @@ private:
 
 	static void record_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
 	{
-		// Facet a's neighbor is facet b
-		stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		// Facet b's neighbor is facet a
-		stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		if (((edge_a.which_edge < 3) && (edge_b.which_edge < 3)) || ((edge_a.which_edge > 2) && (edge_b.which_edge > 2))) {
-			// These facets are oriented in opposite directions, their normals are probably messed up.
-			stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
-			stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
-		}
+		stl_connect_neighbors(stl, edge_a.facet_number, edge_a.which_edge, edge_b.facet_number, edge_b.which_edge);
 
 		// Count successful connects:
 		// Total connects:
@@ -453,21 +468,80 @@ void stl_check_facets_exact(stl_file *stl)
 		  	++ i;
   	}
 
-  	// Initialize hash table.
-  	HashTableEdges hash_table(stl->stats.number_of_facets);
 	for (auto &neighbor : stl->neighbors_start)
 		neighbor.reset();
 
-  	// Connect neighbor edges.
-	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i) {
-		const stl_facet &facet = stl->facet_start[i];
-		for (int j = 0; j < 3; ++ j) {
-			HashEdge edge;
-			edge.facet_number = i;
-			edge.which_edge = j;
-			edge.load_exact(stl, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
-			hash_table.insert_edge_exact(stl, edge);
-		}
+	// Instead of inserting the edges into a hash table one by one, the edges are sorted by their keys in parallel
+	// and the runs of equal edges are matched in parallel. Inside a run, the edges are matched in the order
+	// they would have been inserted into the hash table: An edge is matched with the first yet unmatched edge
+	// of a different facet inserted before it, thus the result is the same as with the hash table.
+	struct SortedEdge {
+		uint32_t key[6];
+		int      facet_number;
+		// Index of this edge inside the facet, increased by 3 if the edge is stored backwards.
+		int      which_edge;
+		// Order of insertion into the hash table.
+		size_t   order() const { return size_t(facet_number) * 3 + which_edge % 3; }
+	};
+	const size_t num_facets = stl->stats.number_of_facets;
+	std::vector<SortedEdge> edges(num_facets * 3);
+	stl->stats.shortest_edge = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, num_facets), stl->stats.shortest_edge,
+		[stl, &edges](const tbb::blocked_range<size_t> &range, float shortest_edge) {
+			for (size_t i = range.begin(); i < range.end(); ++ i) {
+				const stl_facet &facet = stl->facet_start[i];
+				for (int j = 0; j < 3; ++ j) {
+					SortedEdge &edge  = edges[i * 3 + j];
+					edge.facet_number = int(i);
+					edge.which_edge   = edge_key_exact(&facet.vertex[j], &facet.vertex[(j + 1) % 3], edge.key) ? j + 3 : j;
+					shortest_edge     = std::min(shortest_edge, edge_max_diff(facet.vertex[j], facet.vertex[(j + 1) % 3]));
+				}
+			}
+			return shortest_edge;
+		},
+		[](float a, float b) { return std::min(a, b); });
+
+	auto key_equal = [](const SortedEdge &a, const SortedEdge &b) { return memcmp(a.key, b.key, sizeof(a.key)) == 0; };
+	tbb::parallel_sort(edges.begin(), edges.end(), [](const SortedEdge &a, const SortedEdge &b) {
+		int cmp = memcmp(a.key, b.key, sizeof(a.key));
+		return cmp < 0 || (cmp == 0 && a.order() < b.order());
+	});
+
+	// Connect neighbor edges. Each range processes the runs of equal edges starting inside the range.
+	// Each edge belongs to a single run, thus the slots of neighbors_start written by different runs never overlap.
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, edges.size()),
+		[stl, &edges, key_equal](const tbb::blocked_range<size_t> &range) {
+			std::vector<const SortedEdge*> unmatched;
+			size_t i = range.begin();
+			// Skip the run started by the previous range.
+			while (i > 0 && i < range.end() && key_equal(edges[i - 1], edges[i]))
+				++ i;
+			while (i < range.end()) {
+				unmatched.clear();
+				size_t j = i;
+				for (; j < edges.size() && key_equal(edges[i], edges[j]); ++ j) {
+					const SortedEdge &edge = edges[j];
+					auto it = std::find_if(unmatched.begin(), unmatched.end(), [&edge](const SortedEdge *e) { return e->facet_number != edge.facet_number; });
+					if (it == unmatched.end())
+						unmatched.emplace_back(&edge);
+					else {
+						stl_connect_neighbors(stl, edge.facet_number, edge.which_edge, (*it)->facet_number, (*it)->which_edge);
+						unmatched.erase(it);
+					}
+				}
+				i = j;
+			}
+		});
+
+	// Count successful connects.
+	for (const stl_neighbors &neighbors : stl->neighbors_start) {
+		int num_neighbors = neighbors.num_neighbors();
+		stl->stats.connected_edges += num_neighbors;
+		if (num_neighbors >= 1)
+			++ stl->stats.connected_facets_1_edge;
+		if (num_neighbors >= 2)
+			++ stl->stats.connected_facets_2_edge;
+		if (num_neighbors == 3)
+			++ stl->stats.connected_facets_3_edge;
 	}
 
 #if 0
@@ -47,6 +47,7 @@
 #include <cstdlib>
 #include <ostream>
 #include <functional>
+#include <new>
 #include <assert.h>
 #include <libslic3r/Int128.hpp>
 
@@ -119,6 +120,98 @@ inline cInt Round(double val)
   return static_cast<cInt>((val < 0) ? (val - 0.5) : (val + 0.5));
 }
 
+//------------------------------------------------------------------------------
+// Arena methods ...
+//------------------------------------------------------------------------------
+
+static thread_local Arena s_thread_arena;
+
+Arena::~Arena()
+{
+  for (char *chunk : m_chunks)
+    ::operator delete(chunk);
+}
+
+Arena* Arena::current()
+{
+  return s_thread_arena.m_depth > 0 ? &s_thread_arena : nullptr;
+}
+
+void* Arena::allocate(size_t bytes)
+{
+  if (bytes > (size_t(1) << max_block_log2))
+    return ::operator new(bytes);
+#ifndef NDEBUG
+  ++ m_num_allocated;
+#endif // NDEBUG
+  size_t block_log2 = min_block_log2;
+  while ((size_t(1) << block_log2) < bytes)
+    ++ block_log2;
+  void *&free_list = m_free[block_log2 - min_block_log2];
+  if (free_list) {
+    // Recycle a released block.
+    void *out = free_list;
+    free_list = *reinterpret_cast<void**>(out);
+    return out;
+  }
+  const size_t block_size = size_t(1) << block_log2;
+  if (m_chunk_idx == m_chunks.size() || m_chunk_used + block_size > chunk_size) {
+    // The current chunk is exhausted, continue with the next one.
+    if (m_chunk_idx < m_chunks.size())
+      ++ m_chunk_idx;
+    if (m_chunk_idx == m_chunks.size())
+      m_chunks.emplace_back(static_cast<char*>(::operator new(chunk_size)));
+    m_chunk_used = 0;
+  }
+  void *out = m_chunks[m_chunk_idx] + m_chunk_used;
+  m_chunk_used += block_size;
+  return out;
+}
+
+void Arena::deallocate(void *ptr, size_t bytes)
+{
+  if (bytes > (size_t(1) << max_block_log2)) {
+    ::operator delete(ptr);
+    return;
+  }
+#ifndef NDEBUG
+  assert(m_num_allocated > 0);
+  -- m_num_allocated;
+#endif // NDEBUG
+  size_t block_log2 = min_block_log2;
+  while ((size_t(1) << block_log2) < bytes)
+    ++ block_log2;
+  void *&free_list = m_free[block_log2 - min_block_log2];
+  *reinterpret_cast<void**>(ptr) = free_list;
+  free_list = ptr;
+}
+
+void Arena::rewind()
+{
+  // All the Clipper objects allocating from this arena shall have been destroyed by now.
+  assert(m_num_allocated == 0);
+  for (void *&free_list : m_free)
+    free_list = nullptr;
+  while (m_chunks.size() > max_chunks_retained) {
+    ::operator delete(m_chunks.back());
+    m_chunks.pop_back();
+  }
+  m_chunk_idx  = 0;
+  m_chunk_used = 0;
+}
+
+ArenaScope::ArenaScope()
+{
+  ++ s_thread_arena.m_depth;
+}
+
+ArenaScope::~ArenaScope()
+{
+  assert(s_thread_arena.m_depth > 0);
+  if (-- s_thread_arena.m_depth == 0)
+    s_thread_arena.rewind();
+}
+
 //------------------------------------------------------------------------------
 // PolyTree methods ...
 //------------------------------------------------------------------------------
@@ -759,7 +852,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
+  ArenaVector<TEdge> edges(highI + 1, ArenaAllocator<TEdge>(m_MinimaList.get_allocator()));
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
@@ -1054,7 +1147,7 @@ void Clipper::Reset()
 {
   CLIPPERLIB_PROFILE_FUNC();
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt>();
+  m_Scanbeam = std::priority_queue<cInt, ArenaVector<cInt>>(std::less<cInt>(), ArenaVector<cInt>(m_Maxima.get_allocator()));
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
@@ -1179,7 +1272,7 @@ OutPt* Clipper::AllocateOutPt()
     pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
   } else {
     // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    m_OutPts.push_back(ArenaAllocator<OutPt>(m_OutPts.get_allocator()).allocate(m_OutPtsChunkSize));
     m_OutPtsChunkLast = 1;
     pt = m_OutPts.back();
   }
@@ -1188,10 +1281,12 @@ OutPt* Clipper::AllocateOutPt()
 
 void Clipper::DisposeAllOutRecs()
 {
+  ArenaAllocator<OutPt> outpt_allocator(m_OutPts.get_allocator());
   for (OutPt *pts : m_OutPts)
-    delete[] pts;
+    outpt_allocator.deallocate(pts, m_OutPtsChunkSize);
+  ArenaAllocator<OutRec> outrec_allocator(m_PolyOuts.get_allocator());
   for (OutRec *rec : m_PolyOuts)
-    delete rec;
+    outrec_allocator.deallocate(rec, 1);
   m_OutPts.clear();
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
@@ -1975,7 +2070,7 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2) const
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result = new (ArenaAllocator<OutRec>(m_PolyOuts.get_allocator()).allocate(1)) OutRec;
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -2211,8 +2306,8 @@ void Clipper::ProcessHorizontal(TEdge *horzEdge)
   if (!eLastHorz->NextInLML)
     eMaxPair = GetMaximaPair(eLastHorz);
 
-  std::vector<cInt>::const_iterator maxIt;
-  std::vector<cInt>::const_reverse_iterator maxRit;
+  ArenaVector<cInt>::const_iterator maxIt;
+  ArenaVector<cInt>::const_reverse_iterator maxRit;
   if (!m_Maxima.empty())
   {
       //get the first maxima in range (X) ...
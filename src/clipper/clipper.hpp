@@ -58,6 +58,7 @@
 #include <ostream>
 #include <functional>
 #include <queue>
+#include <type_traits>
 
 #ifdef CLIPPERLIB_NAMESPACE_PREFIX
   namespace CLIPPERLIB_NAMESPACE_PREFIX {
@@ -214,6 +215,95 @@ struct IntRect { cInt left; cInt top; cInt right; cInt bottom; };
 //enums that are used internally ...
 enum EdgeSide { esLeft = 1, esRight = 2};
 
+// Memory arena for the short lived working data of Clipper and ClipperOffset: edges, local minima,
+// output records and points, joins, intersections and the scan beam.
+// Each thread has its own arena, which is active while an ArenaScope is alive on that thread,
+// typically while a TBB worker processes a single layer. Released blocks are recycled through
+// free lists of power of two size classes, and the arena is rewound when the outermost scope ends.
+// The memory chunks are retained and reused by the next scope, thus in the steady state the Clipper
+// working data does not touch the global heap at all. Clipper results (Paths, PolyTree) are always
+// allocated from the global heap, therefore they may outlive the scope.
+// A Clipper / ClipperOffset object created inside an ArenaScope shall be destroyed before the scope ends.
+class Arena
+{
+public:
+  Arena() = default;
+  ~Arena();
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Arena of the calling thread if an ArenaScope is active on it, nullptr otherwise.
+  static Arena* current();
+
+  void* allocate(size_t bytes);
+  void  deallocate(void *ptr, size_t bytes);
+
+private:
+  friend class ArenaScope;
+  void  rewind();
+
+  // Blocks are allocated with a granularity of 16 bytes up to 256kB, larger blocks are taken from the global heap.
+  static constexpr const size_t min_block_log2 = 4;
+  static constexpr const size_t max_block_log2 = 18;
+  static constexpr const size_t chunk_size     = size_t(1) << 20;
+  // Maximum number of chunks retained when the outermost scope ends.
+  static constexpr const size_t max_chunks_retained = 16;
+
+  std::vector<char*>  m_chunks;
+  // Index of the chunk to allocate from and the number of bytes already allocated from it.
+  size_t              m_chunk_idx  { 0 };
+  size_t              m_chunk_used { 0 };
+  void               *m_free[max_block_log2 - min_block_log2 + 1] {};
+  // Nesting level of ArenaScopes.
+  int                 m_depth { 0 };
+#ifndef NDEBUG
+  // Number of blocks not yet returned to the arena, to catch Clipper objects outliving their ArenaScope.
+  size_t              m_num_allocated { 0 };
+#endif // NDEBUG
+};
+
+// Activates the Arena of the calling thread. Scopes may be nested.
+class ArenaScope
+{
+public:
+  ArenaScope();
+  ~ArenaScope();
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// Allocates from the arena active at the time the allocator was constructed, otherwise from the global heap.
+template<typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap            = std::true_type;
+
+  ArenaAllocator() : m_arena(Arena::current()) {}
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> &rhs) : m_arena(rhs.arena()) {}
+
+  T*   allocate(size_t n) 
+    { return static_cast<T*>(m_arena ? m_arena->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T))); }
+  void deallocate(T *ptr, size_t n) 
+    { if (m_arena) m_arena->deallocate(ptr, n * sizeof(T)); else ::operator delete(ptr); }
+
+  Arena* arena() const { return m_arena; }
+  template<typename U>
+  bool operator==(const ArenaAllocator<U> &rhs) const { return m_arena == rhs.arena(); }
+  template<typename U>
+  bool operator!=(const ArenaAllocator<U> &rhs) const { return m_arena != rhs.arena(); }
+
+private:
+  Arena *m_arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
 // namespace Internal {
   //forward declarations (for stuff used internally) ...
   struct TEdge {
@@ -308,7 +398,7 @@ public:
     if (num_paths == 1)
         return AddPath(*paths_provider.begin(), PolyTyp, Closed);
 
-    std::vector<int> num_edges(num_paths, 0);
+    ArenaVector<int> num_edges(num_paths, 0, ArenaAllocator<int>(m_MinimaList.get_allocator()));
     int num_edges_total = 0;
     size_t i = 0;
     for (const Path &pg : paths_provider) {
@@ -329,7 +419,7 @@ public:
       return false;
 
     // Allocate a new edge array.
-    std::vector<TEdge> edges(num_edges_total);
+    ArenaVector<TEdge> edges(num_edges_total, ArenaAllocator<TEdge>(m_MinimaList.get_allocator()));
     // Fill in the edge array.
     bool result = false;
     TEdge *p_edge = edges.data();
@@ -365,7 +455,7 @@ protected:
   void AscendToMax(TEdge *&E, bool Appending, bool IsClosed);
 
   // Local minima (Y, left edge, right edge) sorted by ascending Y.
-  std::vector<LocalMinimum> m_MinimaList;
+  ArenaVector<LocalMinimum> m_MinimaList;
 
 #ifdef CLIPPERLIB_INT32
   static constexpr const bool m_UseFullRange = false;
@@ -376,7 +466,7 @@ protected:
 #endif // CLIPPERLIB_INT32
 
   // A vector of edges per each input path.
-  std::vector<std::vector<TEdge>> m_edges;
+  ArenaVector<ArenaVector<TEdge>> m_edges;
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -420,22 +510,22 @@ protected:
 private:
   
   // Output polygons.
-  std::vector<OutRec*>  m_PolyOuts;
+  ArenaVector<OutRec*>  m_PolyOuts;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
-  std::vector<OutPt*>   m_OutPts;
+  ArenaVector<OutPt*>   m_OutPts;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
   size_t                m_OutPtsChunkLast;
 
-  std::vector<Join>     m_Joins;
-  std::vector<Join>     m_GhostJoins;
-  std::vector<IntersectNode> m_IntersectList;
+  ArenaVector<Join>     m_Joins;
+  ArenaVector<Join>     m_GhostJoins;
+  ArenaVector<IntersectNode> m_IntersectList;
   ClipType              m_ClipType;
   // A priority queue (a binary heap) of Y coordinates.
-  std::priority_queue<cInt> m_Scanbeam;
+  std::priority_queue<cInt, ArenaVector<cInt>> m_Scanbeam;
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
-  std::vector<cInt>     m_Maxima;
+  ArenaVector<cInt>     m_Maxima;
   TEdge                *m_ActiveEdges;
   TEdge                *m_SortedEdges;
   PolyFillType          m_ClipFillType;
@@ -525,7 +615,7 @@ private:
   Paths m_destPolys;
   Path m_srcPoly;
   Path m_destPoly;
-  std::vector<DoublePoint> m_normals;
+  ArenaVector<DoublePoint> m_normals;
   double m_delta, m_sinA, m_sin, m_cos;
   double m_miterLim, m_StepsPerRad;
   IntPoint m_lowest;
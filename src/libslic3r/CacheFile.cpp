@@ -0,0 +1,129 @@
+#include "CacheFile.hpp"
+#include "Exception.hpp"
+#include "Utils.hpp"
+
+#include <cstring>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+namespace Slic3r {
+
+void CacheHasher::config(const ConfigBase &config)
+{
+    for (const std::string &key : config.keys()) {
+        this->string(key);
+        this->string(config.opt_serialize(key));
+    }
+}
+
+void CacheHasher::config(const ConfigBase &config, const std::initializer_list<const char*> keys)
+{
+    for (const char *key : keys)
+        if (config.has(key)) {
+            this->string(key);
+            this->string(config.opt_serialize(key));
+        }
+}
+
+void CacheHasher::file(const std::string &path)
+{
+    uintmax_t size = boost::filesystem::file_size(path);
+    this->pod(uint64_t(size));
+    if (size == 0)
+        // Empty files cannot be mapped.
+        return;
+    try {
+        boost::iostreams::mapped_file_source mapped(path);
+        this->process(mapped.data(), mapped.size());
+    } catch (const std::exception &ex) {
+        throw Slic3r::RuntimeError(std::string("Cannot read ") + path + ": " + ex.what());
+    }
+}
+
+std::string CacheHasher::hex_digest()
+{
+    boost::uuids::detail::sha1::digest_type digest;
+    m_sha1.get_digest(digest);
+    std::string out;
+    char        buf[32];
+    for (const auto d : digest) {
+        sprintf(buf, "%0*x", int(sizeof(d) * 2), (unsigned int)d);
+        out += buf;
+    }
+    return out;
+}
+
+void CacheFileWriter::write(const void *data, size_t size)
+{
+    if (size > 0 && ::fwrite(data, 1, size, m_file) != size)
+        throw Slic3r::RuntimeError("Failed writing the cache file");
+}
+
+void CacheFileReader::read(void *data, size_t size)
+{
+    if (size > 0 && ::fread(data, 1, size, m_file) != size)
+        throw Slic3r::RuntimeError("Truncated cache file");
+}
+
+size_t CacheFileReader::count()
+{
+    auto n = this->pod<uint64_t>();
+    // Sanity check to not allocate gigabytes of memory if the file is corrupted.
+    if (n > (uint64_t(1) << 32))
+        throw Slic3r::RuntimeError("Corrupted cache file");
+    return size_t(n);
+}
+
+void CacheFileReader::magic(const char *expected, size_t size)
+{
+    std::string data(size, 0);
+    this->read(data.data(), size);
+    if (memcmp(data.data(), expected, size) != 0)
+        throw Slic3r::RuntimeError("Invalid cache file header");
+}
+
+void write_cache_file(const std::string &path, const std::function<void(CacheFileWriter&)> &write)
+{
+    const std::string path_tmp = path + "." + boost::filesystem::unique_path().string() + ".tmp";
+    try {
+        boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+        FILE *file = boost::nowide::fopen(path_tmp.c_str(), "wb");
+        if (file == nullptr)
+            throw Slic3r::RuntimeError(std::string("Cannot create the cache file ") + path_tmp);
+        try {
+            CacheFileWriter out(file);
+            write(out);
+        } catch (...) {
+            fclose(file);
+            throw;
+        }
+        if (fclose(file) != 0)
+            throw Slic3r::RuntimeError(std::string("Failed writing the cache file ") + path_tmp);
+        if (std::error_code ec = rename_file(path_tmp, path); ec)
+            throw Slic3r::RuntimeError(std::string("Failed renaming the cache file ") + path_tmp + " to " + path + ": " + ec.message());
+    } catch (...) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(path_tmp, ec);
+        throw;
+    }
+}
+
+void read_cache_file(const std::string &path, const std::function<void(CacheFileReader&)> &read)
+{
+    FILE *file = boost::nowide::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        throw Slic3r::RuntimeError("Cannot open the file");
+    try {
+        CacheFileReader in(file);
+        read(in);
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+    fclose(file);
+}
+
+} // namespace Slic3r
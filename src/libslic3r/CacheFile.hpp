@@ -0,0 +1,96 @@
+#ifndef slic3r_CacheFile_hpp_
+#define slic3r_CacheFile_hpp_
+
+// Building blocks of the on disk caches (see PrintObjectCache.cpp and ModelCache.cpp):
+// Hashing of the cache keys and reading / writing of the binary cache files.
+
+#include "Config.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/uuid/detail/sha1.hpp>
+
+namespace Slic3r {
+
+class CacheHasher
+{
+public:
+    void process(const void *data, size_t size) { m_sha1.process_bytes(data, size); }
+    template<typename T> void pod(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "CacheHasher::pod() requires a trivially copyable type");
+        this->process(&value, sizeof(T));
+    }
+    template<typename T> void vector(const std::vector<T> &data) {
+        this->pod(data.size());
+        if (! data.empty())
+            this->process(data.data(), data.size() * sizeof(T));
+    }
+    void string(const std::string &s) { this->pod(s.size()); this->process(s.data(), s.size()); }
+    // Hash the values of the config options, not the config hash(), which is not stable between runs.
+    void config(const ConfigBase &config);
+    void config(const ConfigBase &config, const std::initializer_list<const char*> keys);
+    // Hash content of a file. Throws Slic3r::RuntimeError if the file cannot be read.
+    void file(const std::string &path);
+
+    std::string hex_digest();
+
+private:
+    boost::uuids::detail::sha1 m_sha1;
+};
+
+class CacheFileWriter
+{
+public:
+    explicit CacheFileWriter(FILE *file) : m_file(file) {}
+
+    void write(const void *data, size_t size);
+    template<typename T> void pod(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "CacheFileWriter::pod() requires a trivially copyable type");
+        this->write(&value, sizeof(T));
+    }
+    void count(size_t n) { this->pod(uint64_t(n)); }
+    void string(const std::string &s) { this->count(s.size()); this->write(s.data(), s.size()); }
+    // Elements are stored as raw memory, T shall be a plain old data type (Eigen vectors are fine).
+    template<typename T> void vector(const std::vector<T> &data) { this->count(data.size()); this->write(data.data(), data.size() * sizeof(T)); }
+
+private:
+    FILE *m_file;
+};
+
+class CacheFileReader
+{
+public:
+    explicit CacheFileReader(FILE *file) : m_file(file) {}
+
+    void read(void *data, size_t size);
+    template<typename T> T pod() {
+        static_assert(std::is_trivially_copyable<T>::value, "CacheFileReader::pod() requires a trivially copyable type");
+        T value;
+        this->read(&value, sizeof(T));
+        return value;
+    }
+    template<typename T> void pod(T &value) { value = this->pod<T>(); }
+    size_t count();
+    std::string string() { std::string s(this->count(), 0); this->read(s.data(), s.size()); return s; }
+    template<typename T> void vector(std::vector<T> &data) { data.assign(this->count(), T()); this->read(data.data(), data.size() * sizeof(T)); }
+    // Read a magic marker written with CacheFileWriter::write(), throw if it does not match.
+    void magic(const char *expected, size_t size);
+
+private:
+    FILE *m_file;
+};
+
+// Write a cache file into a temporary file first and rename it to path once complete,
+// so that a concurrent slicer process will never see a partially written cache file.
+// The parent directories are created as needed. Throws Slic3r::RuntimeError on failure.
+extern void write_cache_file(const std::string &path, const std::function<void(CacheFileWriter&)> &write);
+// Throws Slic3r::RuntimeError if the file could not be opened, or if it is truncated or corrupted.
+extern void read_cache_file(const std::string &path, const std::function<void(CacheFileReader&)> &read);
+
+} // namespace Slic3r
+
+#endif /* slic3r_CacheFile_hpp_ */
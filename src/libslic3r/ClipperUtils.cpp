@@ -186,21 +186,25 @@ Slic3r::Polygons offset(const Slic3r::Polyline &polyline, const float delta, Cli
 Slic3r::Polygons offset(const Slic3r::Polylines &polylines, const float delta, ClipperLib::JoinType joinType, double miterLimit)
     {  return to_polygons(_offset(ClipperUtils::PolylinesProvider(polylines), ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
 
+static void init_clipper_offset(ClipperLib::ClipperOffset &co, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    if (joinType == jtRound)
+        co.ArcTolerance = miterLimit;
+    else
+        co.MiterLimit = miterLimit;
+    co.ShortestEdgeLength = double(std::abs(delta * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+}
+
 // returns number of expolygons collected (0 or 1).
-static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
+// The ClipperOffset object is initialized by init_clipper_offset() and reused for the contour and all the holes,
+// so that its working buffers are not reallocated for each of them.
+static int offset_expolygon_inner(ClipperLib::ClipperOffset &co, const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, ClipperLib::Paths &out)
 {
     // 1) Offset the outer contour.
     ClipperLib::Paths contours;
-    {
-        ClipperLib::ClipperOffset co;
-        if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
-        else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = double(std::abs(delta * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-        co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta);
-    }
+    co.Clear();
+    co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
+    co.Execute(contours, delta);
     if (contours.empty())
         // No need to try to offset the holes.
         return 0;
@@ -213,12 +217,7 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         ClipperLib::Paths holes;
         {
             for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = double(std::abs(delta * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+                co.Clear();
                 co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
                 ClipperLib::Paths out2;
                 // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
@@ -264,15 +263,17 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
     return 1;
 }
 
-static int offset_expolygon_inner(const Slic3r::Surface &surface, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
-    { return offset_expolygon_inner(surface.expolygon, delta, joinType, miterLimit, out); }
-static int offset_expolygon_inner(const Slic3r::Surface *surface, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
-    { return offset_expolygon_inner(surface->expolygon, delta, joinType, miterLimit, out); }
+static int offset_expolygon_inner(ClipperLib::ClipperOffset &co, const Slic3r::Surface &surface, const float delta, ClipperLib::JoinType joinType, ClipperLib::Paths &out)
+    { return offset_expolygon_inner(co, surface.expolygon, delta, joinType, out); }
+static int offset_expolygon_inner(ClipperLib::ClipperOffset &co, const Slic3r::Surface *surface, const float delta, ClipperLib::JoinType joinType, ClipperLib::Paths &out)
+    { return offset_expolygon_inner(co, surface->expolygon, delta, joinType, out); }
 
 ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
 {
+    ClipperLib::ClipperOffset co;
+    init_clipper_offset(co, delta, joinType, miterLimit);
     ClipperLib::Paths out;
-    offset_expolygon_inner(expolygon, delta, joinType, miterLimit, out);
+    offset_expolygon_inner(co, expolygon, delta, joinType, out);
     return out;
 }
 
@@ -288,8 +289,10 @@ ClipperLib::Paths _offset(const ExPolygonVector &expolygons, const float delta,
     // How many non-empty offsetted expolygons were actually collected into output?
     // If only one, then there is no need to do a final union.
     size_t expolygons_collected = 0;
+    ClipperLib::ClipperOffset co;
+    init_clipper_offset(co, delta, joinType, miterLimit);
     for (const auto &expoly : expolygons)
-        expolygons_collected += offset_expolygon_inner(expoly, delta, joinType, miterLimit, output);
+        expolygons_collected += offset_expolygon_inner(co, expoly, delta, joinType, output);
 
     // 4) Unite the offsetted expolygons.
     if (expolygons_collected > 1 && delta > 0) {
@@ -591,19 +594,8 @@ static void _clipper_pl_recombine(Polylines &polylines)
 template<typename PathProvider1, typename PathProvider2>
 Polylines _clipper_pl_closed(ClipperLib::ClipType clipType, PathProvider1 &&subject, PathProvider2 &&clip)
 {
-    // Transform input polygons into open paths.
-    ClipperLib::Paths paths;
-    paths.reserve(subject.size());
-    for (const Points &poly : subject) {
-        // Emplace polygon, duplicate the 1st point.
-        paths.push_back({});
-        ClipperLib::Path &path = paths.back();
-        path.reserve(poly.size() + 1);
-        path = poly;
-        path.emplace_back(poly.front());
-    }
-    // perform clipping
-    Polylines retval = _clipper_pl_open(clipType, paths, std::forward<PathProvider2>(clip));
+    // Feed the input polygons to Clipper as open paths with the 1st point duplicated, without copying them all.
+    Polylines retval = _clipper_pl_open(clipType, ClipperUtils::ClosedPathsAsOpenProvider<std::decay_t<PathProvider1>>(subject), std::forward<PathProvider2>(clip));
     _clipper_pl_recombine(retval);
     return retval;
 }
@@ -679,6 +671,7 @@ static void traverse_pt_noholes(const ClipperLib::PolyNodes &nodes, Polygons *ou
     });
 }
 
+// The contours are moved out of the polytree.
 static void traverse_pt_outside_in(const ClipperLib::PolyNodes &nodes, Polygons *retval)
 {
     // collect ordering points
@@ -689,8 +682,8 @@ static void traverse_pt_outside_in(const ClipperLib::PolyNodes &nodes, Polygons
 
     // Perform the ordering, push results recursively.
     //FIXME pass the last point to chain_clipper_polynodes?
-    for (const ClipperLib::PolyNode *node : chain_clipper_polynodes(ordering_points, nodes)) {
-        retval->emplace_back(node->Contour);
+    for (ClipperLib::PolyNode *node : chain_clipper_polynodes(ordering_points, nodes)) {
+        retval->emplace_back(std::move(node->Contour));
         if (node->IsHole()) 
             // Orient a hole, which is clockwise oriented, to CCW.
             retval->back().reverse();
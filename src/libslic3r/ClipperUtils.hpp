@@ -259,6 +259,47 @@ namespace ClipperUtils {
         const SurfacesPtr &m_surfaces;
         size_t             m_size;
     };
+
+    // Provides closed polygons as open paths with the first point repeated at the end, so that Clipper
+    // clips them as polylines. The open path is assembled into a buffer owned by the provider,
+    // therefore a dereferenced path is only valid until the next path is dereferenced.
+    // The buffer is reused, so no memory is allocated per polygon.
+    template<typename PathsProvider>
+    class ClosedPathsAsOpenProvider {
+    public:
+        ClosedPathsAsOpenProvider(const PathsProvider &paths) : m_paths(paths) {}
+
+        using source_iterator = decltype(std::declval<const PathsProvider&>().cbegin());
+
+        struct iterator : public PathsProviderIteratorBase {
+        public:
+            explicit iterator(source_iterator it, Points &buffer) : m_it(it), m_buffer(&buffer) {}
+            const Points& operator*() const {
+                const Points &src = *m_it;
+                m_buffer->assign(src.begin(), src.end());
+                if (! src.empty())
+                    m_buffer->emplace_back(src.front());
+                return *m_buffer;
+            }
+            bool operator==(const iterator &rhs) const { return m_it == rhs.m_it; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            const Points& operator++(int) { const Points &out = **this; ++ m_it; return out; }
+            iterator& operator++() { ++ m_it; return *this; }
+        private:
+            source_iterator  m_it;
+            Points          *m_buffer;
+        };
+
+        iterator cbegin() const { return iterator(m_paths.cbegin(), m_buffer); }
+        iterator begin()  const { return this->cbegin(); }
+        iterator cend()   const { return iterator(m_paths.cend(), m_buffer); }
+        iterator end()    const { return this->cend(); }
+        size_t   size()   const { return m_paths.size(); }
+
+    private:
+        PathsProvider   m_paths;
+        mutable Points  m_buffer;
+    };
 }
 
 ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input);
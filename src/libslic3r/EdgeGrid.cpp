@@ -1,8 +1,12 @@
 #include <algorithm>
 #include <vector>
 #include <float.h>
+#include <limits>
+#include <numeric>
 #include <unordered_map>
 
+#include <tbb/parallel_for.h>
+
 #include <png.h>
 
 #include "libslic3r.h"
@@ -165,136 +169,64 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	m_rows = (m_bbox.max(1) - m_bbox.min(1) + m_resolution - 1) / m_resolution;
 	m_cells.assign(m_rows * m_cols, Cell());
 
-	// 3) First round of contour rasterization, count the edges per grid cell.
-	for (size_t i = 0; i < m_contours.size(); ++ i) {
-		const Contour &contour = m_contours[i];
+	// 3) Rasterize the contours in two rounds: first count the edges per grid cell, then fill in m_cell_data.
+	// Both rounds run in parallel over horizontal stripes of the grid, each stripe only touching its own cells.
+	// Inside a cell, the edges are stored in the order of contours and their segments, the same order
+	// a single threaded rasterization produces, thus the grid does not depend on the number of threads.
+	const coord_t stripe_rows = std::max<coord_t>(8, coord_t(m_rows / 64));
+	const size_t  num_stripes = (m_rows + size_t(stripe_rows) - 1) / size_t(stripe_rows);
+	// Bucket the segments by the stripes spanned by their rows, so that a stripe only walks the segments intersecting it.
+	// The buckets are stored in a CSR layout: segments of stripe s are stripe_segments[stripe_begin[s], stripe_begin[s + 1]).
+	auto segment_stripes = [this, stripe_rows](const Contour &contour, size_t j) {
+		coord_t iy1 = (contour.segment_start(j).y() - m_bbox.min.y()) / m_resolution;
+		coord_t iy2 = (contour.segment_end(j).y() - m_bbox.min.y()) / m_resolution;
+		return std::make_pair(size_t(std::min(iy1, iy2) / stripe_rows), size_t(std::max(iy1, iy2) / stripe_rows));
+	};
+	std::vector<size_t> stripe_begin(num_stripes + 1, 0);
+	for (const Contour &contour : m_contours)
 		for (size_t j = 0; j < contour.num_segments(); ++ j) {
-			// End points of the line segment.
-			Slic3r::Point p1(contour.segment_start(j));
-			Slic3r::Point p2(contour.segment_end(j));
-			p1(0) -= m_bbox.min(0);
-			p1(1) -= m_bbox.min(1);
-			p2(0) -= m_bbox.min(0);
-			p2(1) -= m_bbox.min(1);
-		   	// Get the cells of the end points.
-		    coord_t ix    = p1(0) / m_resolution;
-		    coord_t iy    = p1(1) / m_resolution;
-		    coord_t ixb   = p2(0) / m_resolution;
-		    coord_t iyb   = p2(1) / m_resolution;
-			assert(ix >= 0 && size_t(ix) < m_cols);
-			assert(iy >= 0 && size_t(iy) < m_rows);
-			assert(ixb >= 0 && size_t(ixb) < m_cols);
-			assert(iyb >= 0 && size_t(iyb) < m_rows);
-			// Account for the end points.
-			++ m_cells[iy*m_cols+ix].end;
-			if (ix == ixb && iy == iyb)
-				// Both ends fall into the same cell.
-				continue;
-		    // Raster the centeral part of the line.
-			coord_t dx = std::abs(p2(0) - p1(0));
-			coord_t dy = std::abs(p2(1) - p1(1));
-			if (p1(0) < p2(0)) {
-				int64_t ex = int64_t((ix + 1)*m_resolution - p1(0)) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else if (ex == ey) {
-							ex = int64_t(dy) * m_resolution;
-							ey = int64_t(dx) * m_resolution;
-							ix += 1;
-							iy += 1;
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy >= iyb);
-						if (ex <= ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else {
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-			else {
-				int64_t ex = int64_t(p1(0) - ix*m_resolution) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x non positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else {
-							assert(ex >= ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x non positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy >= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else if (ex == ey) {
-							// The lower edge of a grid cell belongs to the cell.
-							// Handle the case where the ray may cross the lower left corner of a cell in a general case,
-							// or a left or lower edge in a degenerate case (horizontal or vertical line).
-							if (dx > 0) {
-								ex = int64_t(dy) * m_resolution;
-								ix -= 1;
-							}
-							if (dy > 0) {
-								ey = int64_t(dx) * m_resolution;
-								iy -= 1;
-							}
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-			}
+			auto [first, last] = segment_stripes(contour, j);
+			assert(last < num_stripes);
+			for (size_t s = first; s <= last; ++ s)
+				++ stripe_begin[s + 1];
 		}
+	std::partial_sum(stripe_begin.begin(), stripe_begin.end(), stripe_begin.begin());
+	// Filled in the order of contours and their segments.
+	std::vector<std::pair<size_t, size_t>> stripe_segments(stripe_begin.back());
+	{
+		std::vector<size_t> stripe_end(stripe_begin.begin(), stripe_begin.end() - 1);
+		for (size_t i = 0; i < m_contours.size(); ++ i)
+			for (size_t j = 0; j < m_contours[i].num_segments(); ++ j) {
+				auto [first, last] = segment_stripes(m_contours[i], j);
+				for (size_t s = first; s <= last; ++ s)
+					stripe_segments[stripe_end[s] ++] = std::make_pair(i, j);
+			}
 	}
+	// Call visit(cell_idx, contour_idx, segment_idx) for all cells of a stripe intersected by the contours.
+	auto rasterize_stripe = [this, stripe_rows, &stripe_begin, &stripe_segments](const size_t stripe, auto &&visit) {
+		const coord_t row_begin = coord_t(stripe) * stripe_rows;
+		const coord_t row_end   = std::min(row_begin + stripe_rows, coord_t(m_rows));
+		for (size_t k = stripe_begin[stripe]; k < stripe_begin[stripe + 1]; ++ k) {
+			const auto [i, j] = stripe_segments[k];
+			const Contour &contour = m_contours[i];
+			const Slic3r::Point &p1 = contour.segment_start(j);
+			const Slic3r::Point &p2 = contour.segment_end(j);
+			coord_t iy1 = (p1.y() - m_bbox.min.y()) / m_resolution;
+			coord_t iy2 = (p2.y() - m_bbox.min.y()) / m_resolution;
+			// The rows are traversed monotonously, stop once the line leaves the stripe.
+			auto visitor = [this, row_begin, row_end, i = i, j = j, up = iy1 <= iy2, &visit](coord_t iy, coord_t ix) {
+				if (iy >= row_begin && iy < row_end)
+					visit(size_t(iy) * m_cols + size_t(ix), i, j);
+				return up ? iy < row_end : iy >= row_begin;
+			};
+			this->visit_cells_intersecting_line(p1, p2, visitor);
+		}
+	};
+	const tbb::blocked_range<size_t> stripes(0, num_stripes);
+	tbb::parallel_for(stripes, [this, &rasterize_stripe](const tbb::blocked_range<size_t> &range) {
+		for (size_t stripe = range.begin(); stripe < range.end(); ++ stripe)
+			rasterize_stripe(stripe, [this](size_t cell_idx, size_t, size_t) { ++ m_cells[cell_idx].end; });
+	});
 
 	// 4) Prefix sum the numbers of hits per cells to get an index into m_cell_data.
 	size_t cnt = m_cells.front().end;
@@ -310,30 +242,12 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	// 6) Finally fill in m_cell_data by rasterizing the lines once again.
 	for (size_t i = 0; i < m_cells.size(); ++i)
 		m_cells[i].end = m_cells[i].begin;
-
-	struct Visitor {
-		Visitor(std::vector<std::pair<size_t, size_t>> &cell_data, std::vector<Cell> &cells, size_t cols) :
-			cell_data(cell_data), cells(cells), cols(cols), i(0), j(0) {}
-
-		inline bool operator()(coord_t iy, coord_t ix) {
-			cell_data[cells[iy*cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-			// Continue traversing the grid along the edge.
-			return true;
-		}
-
-		std::vector<std::pair<size_t, size_t>> &cell_data;
-		std::vector<Cell> 					   &cells;
-		size_t									cols;
-		size_t 									i;
-		size_t 									j;
-	} visitor(m_cell_data, m_cells, m_cols);
-
-	assert(visitor.i == 0);
-	for (; visitor.i < m_contours.size(); ++ visitor.i) {
-		const Contour &contour = m_contours[visitor.i];
-		for (visitor.j = 0; visitor.j < contour.num_segments(); ++ visitor.j)
-			this->visit_cells_intersecting_line(contour.segment_start(visitor.j), contour.segment_end(visitor.j), visitor);
-	}
+	tbb::parallel_for(stripes, [this, &rasterize_stripe](const tbb::blocked_range<size_t> &range) {
+		for (size_t stripe = range.begin(); stripe < range.end(); ++ stripe)
+			rasterize_stripe(stripe, [this](size_t cell_idx, size_t i, size_t j) {
+				m_cell_data[m_cells[cell_idx].end ++] = std::pair<size_t, size_t>(i, j);
+			});
+	});
 }
 
 #if 0
@@ -692,33 +606,32 @@ void EdgeGrid::Grid::calculate_sdf()
 //	m_signed_distance_field.assign(nrows * ncols, FLT_MAX);
 	float search_radius = float(m_resolution<<1);
 	m_signed_distance_field.assign(nrows * ncols, search_radius);
-	// For each cell:
-	for (int r = 0; r < (int)m_rows; ++ r) {
-		for (int c = 0; c < (int)m_cols; ++ c) {
-			const Cell &cell = m_cells[r * m_cols + c];
-			// For each segment in the cell:
-			for (size_t i = cell.begin; i != cell.end; ++ i) {
-				const Contour &contour = m_contours[m_cell_data[i].first];
-				assert(contour.closed());
-				size_t ipt = m_cell_data[i].second;
-				// End points of the line segment.
-				const Slic3r::Point &p1 = contour.segment_start(ipt);
-				const Slic3r::Point &p2 = contour.segment_end(ipt);
-				// Segment vector
-				const Slic3r::Point v_seg = p2 - p1;
-				// l2 of v_seg
-				const int64_t l2_seg = int64_t(v_seg(0)) * int64_t(v_seg(0)) + int64_t(v_seg(1)) * int64_t(v_seg(1));
-				// For each corner of this cell and its 1 ring neighbours:
-				for (int corner_y = -1; corner_y < 3; ++ corner_y) {
-					coord_t corner_r = r + corner_y;
-					if (corner_r < 0 || (size_t)corner_r >= nrows)
-						continue;
-					for (int corner_x = -1; corner_x < 3; ++ corner_x) {
-						coord_t corner_c = c + corner_x;
-						if (corner_c < 0 || (size_t)corner_c >= ncols)
-							continue;
-						float  &d_min = m_signed_distance_field[corner_r * ncols + corner_c];
-						Slic3r::Point pt(m_bbox.min(0) + corner_c * m_resolution, m_bbox.min(1) + corner_r * m_resolution);
+	// For each grid corner, collect the distances to the segments of the cells, to which 1 ring neighbourhood the corner belongs.
+	// Running in parallel over the rows of corners, each corner is written by a single task only. The segments are visited
+	// in the order of cells and segments inside the cells for each corner, thus the result does not depend on the number of threads.
+	tbb::parallel_for(tbb::blocked_range<coord_t>(0, coord_t(nrows)), [this, ncols, &L, &signs](const tbb::blocked_range<coord_t> &range) {
+		for (coord_t corner_r = range.begin(); corner_r < range.end(); ++ corner_r)
+			for (coord_t corner_c = 0; corner_c < coord_t(ncols); ++ corner_c) {
+				size_t 		  addr  = corner_r * ncols + corner_c;
+				float 		 &d_min = m_signed_distance_field[addr];
+				Slic3r::Point pt(m_bbox.min(0) + corner_c * m_resolution, m_bbox.min(1) + corner_r * m_resolution);
+				// For each cell having this corner in its 1 ring neighbourhood:
+				for (coord_t r = std::max<coord_t>(0, corner_r - 2); r < std::min<coord_t>(m_rows, corner_r + 2); ++ r) {
+					// The cells of a row are stored consecutively in m_cell_data.
+					const size_t cell_begin = m_cells[r * m_cols + std::max<coord_t>(0, corner_c - 2)].begin;
+					const size_t cell_end   = m_cells[r * m_cols + std::min<coord_t>(m_cols, corner_c + 2) - 1].end;
+					// For each segment in the cells:
+					for (size_t i = cell_begin; i != cell_end; ++ i) {
+						const Contour &contour = m_contours[m_cell_data[i].first];
+						assert(contour.closed());
+						size_t ipt = m_cell_data[i].second;
+						// End points of the line segment.
+						const Slic3r::Point &p1 = contour.segment_start(ipt);
+						const Slic3r::Point &p2 = contour.segment_end(ipt);
+						// Segment vector
+						const Slic3r::Point v_seg = p2 - p1;
+						// l2 of v_seg
+						const int64_t l2_seg = int64_t(v_seg(0)) * int64_t(v_seg(0)) + int64_t(v_seg(1)) * int64_t(v_seg(1));
 						Slic3r::Point v_pt = pt - p1;
 						// dot(p2-p1, pt-p1)
 						int64_t t_pt = int64_t(v_seg(0)) * int64_t(v_pt(0)) + int64_t(v_seg(1)) * int64_t(v_pt(1));
@@ -737,14 +650,14 @@ void EdgeGrid::Grid::calculate_sdf()
 									assert(det != 0);
 									d_min = dabs;
 									// Fill in an unsigned vector towards the zero iso surface.
-									float *l = &L[(corner_r * ncols + corner_c) << 1];
+									float *l = &L[addr << 1];
 									l[0] = std::abs(v_pt(0));
 									l[1] = std::abs(v_pt(1));
 								#ifdef _DEBUG
 									double dabs2 = sqrt(l[0]*l[0]+l[1]*l[1]);
 									assert(std::abs(dabs-dabs2) < 1e-4 * std::max(dabs, dabs2));
 								#endif /* _DEBUG */
-									signs[corner_r * ncols + corner_c] = ((det < 0) ? 1 : 0) | 2;
+									signs[addr] = ((det < 0) ? 1 : 0) | 2;
 								}
 							}
 						}
@@ -760,7 +673,7 @@ void EdgeGrid::Grid::calculate_sdf()
 							if (dabs < d_min) {
 								d_min = dabs;
 								// Fill in an unsigned vector towards the zero iso surface.
-								float *l = &L[(corner_r * ncols + corner_c) << 1];
+								float *l = &L[addr << 1];
 								float linv = float(d_seg) / float(l2_seg);
 								l[0] = std::abs(float(v_seg(1)) * linv);
 								l[1] = std::abs(float(v_seg(0)) * linv);
@@ -768,14 +681,13 @@ void EdgeGrid::Grid::calculate_sdf()
 									double dabs2 = sqrt(l[0]*l[0]+l[1]*l[1]);
 									assert(std::abs(dabs-dabs2) <= 1e-4 * std::max(dabs, dabs2));
 								#endif /* _DEBUG */
-								signs[corner_r * ncols + corner_c] = ((d_seg < 0) ? 1 : 0) | 2;
+								signs[addr] = ((d_seg < 0) ? 1 : 0) | 2;
 							}
 						}
 					}
 				}
 			}
-		}
-	}
+	});
 
 #ifdef EDGE_GRID_DEBUG_OUTPUT
 	{ 
@@ -892,16 +804,15 @@ void EdgeGrid::Grid::calculate_sdf()
 	}
 
 	// Update signed distance field from absolte vectors to the iso-surface.
-	for (size_t r = 0; r < nrows; ++ r) {
-		for (size_t c = 0; c < ncols; ++ c) {
-			size_t  addr = r * ncols + c;
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, nrows * ncols), [this, &L, &signs](const tbb::blocked_range<size_t> &range) {
+		for (size_t addr = range.begin(); addr < range.end(); ++ addr) {
 			float  *v    = &L[addr<<1];
 			float   d    = sqrt(v[0]*v[0]+v[1]*v[1]);
 			if (signs[addr] & 1)
 				d = -d;
 			m_signed_distance_field[addr] = d;
 		}
-	}
+	});
 
 #ifdef EDGE_GRID_DEBUG_OUTPUT
 	{
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <memory>
 
+#include <tbb/parallel_for.h>
+
 #include "../ClipperUtils.hpp"
 #include "../Geometry.hpp"
 #include "../Layer.hpp"
@@ -11,6 +13,7 @@
 
 #include "FillBase.hpp"
 #include "FillRectilinear.hpp"
+#include "FillSurfaceCache.hpp"
 
 namespace Slic3r {
 
@@ -41,6 +44,8 @@ struct SurfaceFillParams
     // 1000mm is roughly the maximum length line that fits into a 32bit coord_t.
     float 			anchor_length     = 1000.f;
     float 			anchor_length_max = 1000.f;
+    // Effort spent on ordering the regions of the monotonic infill.
+    MonotonicQuality monotonic_quality = MonotonicQuality::Normal;
 
     // width, height of extrusion, nozzle diameter, is bridge
     // For the output, for fill generator.
@@ -72,6 +77,7 @@ struct SurfaceFillParams
 //		RETURN_COMPARE_NON_EQUAL_TYPED(unsigned, dont_adjust);
 		RETURN_COMPARE_NON_EQUAL(anchor_length);
 		RETURN_COMPARE_NON_EQUAL(anchor_length_max);
+		RETURN_COMPARE_NON_EQUAL_TYPED(int, monotonic_quality);
 		RETURN_COMPARE_NON_EQUAL(flow.width());
 		RETURN_COMPARE_NON_EQUAL(flow.height());
 		RETURN_COMPARE_NON_EQUAL(flow.nozzle_diameter());
@@ -92,6 +98,7 @@ struct SurfaceFillParams
 //				this->dont_adjust   	== rhs.dont_adjust 		&&
 				this->anchor_length  	== rhs.anchor_length    &&
 				this->anchor_length_max == rhs.anchor_length_max &&
+				this->monotonic_quality == rhs.monotonic_quality &&
 				this->flow 				== rhs.flow 			&&
 				this->extrusion_role	== rhs.extrusion_role;
 	}
@@ -146,6 +153,7 @@ std::vector<SurfaceFill> group_fills(const Layer &layer)
 		                    erInternalInfill);
 		        params.bridge_angle = float(surface.bridge_angle);
 		        params.angle 		= float(Geometry::deg2rad(region_config.fill_angle.value));
+		        params.monotonic_quality = region_config.monotonic_infill_quality.value;
 		        
 		        // Calculate the actual flow we'll be using for this infill.
 		        params.bridge = is_bridge || Fill::use_bridge_flow(params.pattern);
@@ -279,6 +287,7 @@ std::vector<SurfaceFill> group_fills(const Layer &layer)
 	            params.density 		 = 100.f;
 		        params.extrusion_role = erInternalInfill;
 		        params.angle 		= float(Geometry::deg2rad(layerm.region().config().fill_angle.value));
+		        params.monotonic_quality = layerm.region().config().monotonic_infill_quality.value;
 		        // calculate the actual flow we'll be using for this infill
 				params.flow = layerm.flow(frSolidInfill);
 		        params.spacing = params.flow.spacing();	        
@@ -338,6 +347,11 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 	}
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
 
+    // Create and configure the filler objects, one per SurfaceFill.
+    std::vector<std::unique_ptr<Fill>> fillers;
+    std::vector<FillParams>            fill_params;
+    fillers.reserve(surface_fills.size());
+    fill_params.reserve(surface_fills.size());
     for (SurfaceFill &surface_fill : surface_fills) {
         // Create the filler object.
         std::unique_ptr<Fill> f = std::unique_ptr<Fill>(Fill::new_from_type(surface_fill.params.pattern));
@@ -348,7 +362,6 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
         f->adapt_fill_octree = (surface_fill.params.pattern == ipSupportCubic) ? support_fill_octree : adaptive_fill_octree;
 
         // calculate flow spacing for infill pattern generation
-        bool using_internal_flow = ! surface_fill.surface.is_solid() && ! surface_fill.params.bridge;
         double link_max_length = 0.;
         if (! surface_fill.params.bridge) {
 #if 0
@@ -371,43 +384,72 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 		params.dont_adjust		 = false; //  surface_fill.params.dont_adjust;
         params.anchor_length     = surface_fill.params.anchor_length;
 		params.anchor_length_max = surface_fill.params.anchor_length_max;
+		params.monotonic_quality = surface_fill.params.monotonic_quality;
 
-        for (ExPolygon &expoly : surface_fill.expolygons) {
-			// Spacing is modified by the filler to indicate adjustments. Reset it for each expolygon.
-			f->spacing = surface_fill.params.spacing;
-			surface_fill.surface.expolygon = std::move(expoly);
-			Polylines polylines;
-			try {
-				polylines = f->fill_surface(&surface_fill.surface, params);
-			} catch (InfillFailedException &) {
-			}
-	        if (! polylines.empty()) {
-		        // calculate actual flow from spacing (which might have been adjusted by the infill
-		        // pattern generator)
-		        double flow_mm3_per_mm = surface_fill.params.flow.mm3_per_mm();
-		        double flow_width      = surface_fill.params.flow.width();
-		        if (using_internal_flow) {
-		            // if we used the internal flow we're not doing a solid infill
-		            // so we can safely ignore the slight variation that might have
-		            // been applied to f->spacing
-		        } else {
-		            Flow new_flow   = surface_fill.params.flow.with_spacing(float(f->spacing));
-		        	flow_mm3_per_mm = new_flow.mm3_per_mm();
-		        	flow_width      = new_flow.width();
-		        }
-		        // Save into layer.
-				ExtrusionEntityCollection* eec = nullptr;
-		        m_regions[surface_fill.region_id]->fills.entities.push_back(eec = new ExtrusionEntityCollection());
-		        // Only concentric fills are not sorted.
-		        eec->no_sort = f->no_sort();
-		        extrusion_entities_append_paths(
-		            eec->entities, std::move(polylines),
-		            surface_fill.params.extrusion_role,
-		            flow_mm3_per_mm, float(flow_width), surface_fill.params.flow.height());
-		    }
-		}
+        fillers.emplace_back(std::move(f));
+        fill_params.emplace_back(params);
     }
 
+    // Fill the expolygons of all SurfaceFills in parallel, so that a single large layer (a large flat part, a raft)
+    // keeps all the cores busy. Each expolygon is filled by its own copy of the filler object.
+    struct FillTask {
+        size_t    surface_fill_idx;
+        size_t    expolygon_idx;
+        Polylines polylines;
+        // Spacing as adjusted by the filler.
+        coordf_t  spacing;
+    };
+    std::vector<FillTask> fill_tasks;
+    for (size_t surface_fill_idx = 0; surface_fill_idx < surface_fills.size(); ++ surface_fill_idx)
+        for (size_t expolygon_idx = 0; expolygon_idx < surface_fills[surface_fill_idx].expolygons.size(); ++ expolygon_idx)
+            fill_tasks.push_back({ surface_fill_idx, expolygon_idx, {}, 0. });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, fill_tasks.size(), 1),
+        [&surface_fills, &fillers, &fill_params, &fill_tasks](const tbb::blocked_range<size_t> &range) {
+        for (size_t task_idx = range.begin(); task_idx < range.end(); ++ task_idx) {
+            FillTask              &task         = fill_tasks[task_idx];
+            SurfaceFill           &surface_fill = surface_fills[task.surface_fill_idx];
+            std::unique_ptr<Fill>  f            = std::unique_ptr<Fill>(fillers[task.surface_fill_idx]->clone());
+            // Spacing is modified by the filler to indicate adjustments. Reset it for each expolygon.
+            f->spacing = surface_fill.params.spacing;
+            Surface surface(surface_fill.surface);
+            surface.expolygon = std::move(surface_fill.expolygons[task.expolygon_idx]);
+            try {
+                // Identical objects share the infill of their identical surfaces.
+                task.polylines = FillSurfaceCache::fill_surface(*f, surface_fill.params.pattern, surface, fill_params[task.surface_fill_idx]);
+            } catch (InfillFailedException &) {
+            }
+            task.spacing = f->spacing;
+        }
+    });
+
+    // Store the infill into the layer regions in the order of the SurfaceFills and their expolygons.
+    for (FillTask &task : fill_tasks)
+        if (! task.polylines.empty()) {
+            const SurfaceFill &surface_fill = surface_fills[task.surface_fill_idx];
+            // calculate actual flow from spacing (which might have been adjusted by the infill
+            // pattern generator)
+            double flow_mm3_per_mm = surface_fill.params.flow.mm3_per_mm();
+            double flow_width      = surface_fill.params.flow.width();
+            if (! surface_fill.surface.is_solid() && ! surface_fill.params.bridge) {
+                // if we used the internal flow we're not doing a solid infill
+                // so we can safely ignore the slight variation that might have
+                // been applied to f->spacing
+            } else {
+                Flow new_flow   = surface_fill.params.flow.with_spacing(float(task.spacing));
+                flow_mm3_per_mm = new_flow.mm3_per_mm();
+                flow_width      = new_flow.width();
+            }
+            // Save into layer.
+            ExtrusionEntityCollection* eec = nullptr;
+            m_regions[surface_fill.region_id]->fills.entities.push_back(eec = new ExtrusionEntityCollection());
+            // Only concentric fills are not sorted.
+            eec->no_sort = fillers[task.surface_fill_idx]->no_sort();
+            extrusion_entities_append_paths(
+                eec->entities, std::move(task.polylines),
+                surface_fill.params.extrusion_role,
+                flow_mm3_per_mm, float(flow_width), surface_fill.params.flow.height());
+        }
+
     // add thin fill regions
     // Unpacks the collection, creates multiple collections per path.
     // The path type could be ExtrusionPath, ExtrusionLoop or ExtrusionEntityCollection.
@@ -3,6 +3,7 @@
 #include "../Surface.hpp"
 
 #include "Fill3DHoneycomb.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -16,120 +17,91 @@ and Y axes.
 Credits: David Eccles (gringer).
 */
 
+// A grid coordinate: index of a grid square plus a fraction of the grid square.
+// Converted to scaled coordinates independently of the grid square index,
+// thus the pattern does not depend on the area it is generated for.
+using GridCoord = std::pair<coord_t, coordf_t>;
+
 // Generate an array of points that are in the same direction as the
 // basic printing line (i.e. Y points for columns, X points for rows)
+// spanning grid squares <gridBegin, gridEnd).
 // Note: a negative offset only causes a change in the perpendicular
 // direction
-static std::vector<coordf_t> colinearPoints(const coordf_t offset, const size_t baseLocation, size_t gridLength)
+static std::vector<GridCoord> colinearPoints(const coordf_t offset, const coord_t gridBegin, const coord_t gridEnd)
 {
     const coordf_t offset2 = std::abs(offset / coordf_t(2.));
-    std::vector<coordf_t> points;
-    points.push_back(baseLocation - offset2);
-    for (size_t i = 0; i < gridLength; ++i) {
-        points.push_back(baseLocation + i + offset2);
-        points.push_back(baseLocation + i + 1 - offset2);
+    std::vector<GridCoord> points;
+    points.emplace_back(gridBegin, - offset2);
+    for (coord_t i = gridBegin; i < gridEnd; ++i) {
+        points.emplace_back(i, offset2);
+        points.emplace_back(i + 1, - offset2);
     }
-    points.push_back(baseLocation + gridLength + offset2);
+    points.emplace_back(gridEnd, offset2);
     return points;
 }
 
 // Generate an array of points for the dimension that is perpendicular to
 // the basic printing line (i.e. X points for columns, Y points for rows)
-static std::vector<coordf_t> perpendPoints(const coordf_t offset, const size_t baseLocation, size_t gridLength)
+// of a line at baseLocation, spanning grid squares <gridBegin, gridEnd).
+static std::vector<GridCoord> perpendPoints(const coordf_t offset, const coord_t baseLocation, const coord_t gridBegin, const coord_t gridEnd)
 {
     coordf_t offset2 = offset / coordf_t(2.);
-    coord_t  side    = 2 * (baseLocation & 1) - 1;
-    std::vector<coordf_t> points;
-    points.push_back(baseLocation - offset2 * side);
-    for (size_t i = 0; i < gridLength; ++i) {
+    coord_t  side    = 2 * ((gridBegin + baseLocation) & 1) - 1;
+    std::vector<GridCoord> points;
+    points.emplace_back(baseLocation, - offset2 * side);
+    for (coord_t i = gridBegin; i < gridEnd; ++i) {
         side = 2*((i+baseLocation) & 1) - 1;
-        points.push_back(baseLocation + offset2 * side);
-        points.push_back(baseLocation + offset2 * side);
+        points.emplace_back(baseLocation, offset2 * side);
+        points.emplace_back(baseLocation, offset2 * side);
     }
-    points.push_back(baseLocation - offset2 * side);
+    points.emplace_back(baseLocation, - offset2 * side);
     return points;
 }
 
-// Trims an array of points to specified rectangular limits. Point
-// components that are outside these limits are set to the limits.
-static inline void trim(Pointfs &pts, coordf_t minX, coordf_t minY, coordf_t maxX, coordf_t maxY)
-{
-    for (Vec2d &pt : pts) {
-        pt.x() = std::clamp(pt.x(), minX, maxX);
-        pt.y() = std::clamp(pt.y(), minY, maxY);
-    }
-}
-
-static inline Pointfs zip(const std::vector<coordf_t> &x, const std::vector<coordf_t> &y)
-{
-    assert(x.size() == y.size());
-    Pointfs out;
-    out.reserve(x.size());
-    for (size_t i = 0; i < x.size(); ++ i)
-        out.push_back(Vec2d(x[i], y[i]));
-    return out;
-}
-
-// Generate a set of curves (array of array of 2d points) that describe a
-// horizontal slice of a truncated regular octahedron with edge length 1.
+// Generate a set of polylines that describe a horizontal slice of a truncated
+// regular octahedron tesselation with a specified grid square size, covering the window.
+// The grid is anchored to the origin of the coordinate system, thus the polylines
+// do not depend on the window, and they extend beyond the window by at least a grid square.
 // curveType specifies which lines to print, 1 for vertical lines
 // (columns), 2 for horizontal lines (rows), and 3 for both.
-static std::vector<Pointfs> makeNormalisedGrid(coordf_t z, size_t gridWidth, size_t gridHeight, size_t curveType)
+static Polylines makeGrid(coord_t z, coord_t gridSize, const BoundingBox &window, size_t curveType)
 {
     // offset required to create a regular octagram
     coordf_t octagramGap = coordf_t(0.5);
     
     // sawtooth wave function for range f($z) = [-$octagramGap .. $octagramGap]
+    coordf_t normalisedZ = coordf_t(z) / coordf_t(gridSize);
     coordf_t a = std::sqrt(coordf_t(2.));  // period
-    coordf_t wave = fabs(fmod(z, a) - a/2.)/a*4. - 1.;
+    coordf_t wave = fabs(fmod(normalisedZ, a) - a/2.)/a*4. - 1.;
     coordf_t offset = wave * octagramGap;
-    
-    std::vector<Pointfs> points;
-    if ((curveType & 1) != 0) {
-        for (size_t x = 0; x <= gridWidth; ++x) {
-            points.push_back(Pointfs());
-            Pointfs &newPoints = points.back();
-            newPoints = zip(
-                perpendPoints(offset, x, gridHeight), 
-                colinearPoints(offset, 0, gridHeight));
-            // trim points to grid edges
-            trim(newPoints, coordf_t(0.), coordf_t(0.), coordf_t(gridWidth), coordf_t(gridHeight));
-            if (x & 1)
-                std::reverse(newPoints.begin(), newPoints.end());
-        }
-    }
-    if ((curveType & 2) != 0) {
-        for (size_t y = 0; y <= gridHeight; ++y) {
-            points.push_back(Pointfs());
-            Pointfs &newPoints = points.back();
-            newPoints = zip(
-                colinearPoints(offset, 0, gridWidth),
-                perpendPoints(offset, y, gridWidth));
-            // trim points to grid edges
-            trim(newPoints, coordf_t(0.), coordf_t(0.), coordf_t(gridWidth), coordf_t(gridHeight));
-            if (y & 1)
-                std::reverse(newPoints.begin(), newPoints.end());
+
+    auto to_scaled = [gridSize](const GridCoord &c) { return c.first * gridSize + coord_t(lrint(c.second * gridSize)); };
+    auto make_polylines = [&to_scaled, offset](coord_t lineBegin, coord_t lineEnd, coord_t gridBegin, coord_t gridEnd, bool columns, Polylines &out) {
+        const std::vector<GridCoord> colinear = colinearPoints(offset, gridBegin, gridEnd);
+        for (coord_t line = lineBegin; line <= lineEnd; ++ line) {
+            const std::vector<GridCoord> perpend = perpendPoints(offset, line, gridBegin, gridEnd);
+            assert(colinear.size() == perpend.size());
+            Polyline polyline;
+            polyline.points.reserve(colinear.size());
+            for (size_t i = 0; i < colinear.size(); ++ i)
+                polyline.points.emplace_back(columns ?
+                    Point(to_scaled(perpend[i]), to_scaled(colinear[i])) :
+                    Point(to_scaled(colinear[i]), to_scaled(perpend[i])));
+            if (line & 1)
+                polyline.reverse();
+            out.emplace_back(std::move(polyline));
         }
-    }
-    return points;
-}
+    };
 
-// Generate a set of curves (array of array of 2d points) that describe a
-// horizontal slice of a truncated regular octahedron with a specified
-// grid square size.
-static Polylines makeGrid(coord_t z, coord_t gridSize, size_t gridWidth, size_t gridHeight, size_t curveType)
-{
-    coord_t  scaleFactor = gridSize;
-    coordf_t normalisedZ = coordf_t(z) / coordf_t(scaleFactor);
-    std::vector<Pointfs> polylines = makeNormalisedGrid(normalisedZ, gridWidth, gridHeight, curveType);
+    const coord_t xBegin = coord_t(std::floor(double(window.min.x()) / gridSize)) - 1;
+    const coord_t xEnd   = coord_t(std::ceil (double(window.max.x()) / gridSize)) + 1;
+    const coord_t yBegin = coord_t(std::floor(double(window.min.y()) / gridSize)) - 1;
+    const coord_t yEnd   = coord_t(std::ceil (double(window.max.y()) / gridSize)) + 1;
     Polylines result;
-    result.reserve(polylines.size());
-    for (std::vector<Pointfs>::const_iterator it_polylines = polylines.begin(); it_polylines != polylines.end(); ++ it_polylines) {
-        result.push_back(Polyline());
-        Polyline &polyline = result.back();
-        for (Pointfs::const_iterator it = it_polylines->begin(); it != it_polylines->end(); ++ it)
-            polyline.points.push_back(Point(coord_t((*it)(0) * scaleFactor), coord_t((*it)(1) * scaleFactor)));
-    }
+    if ((curveType & 1) != 0)
+        make_polylines(xBegin, xEnd, yBegin, yEnd, true, result);
+    if ((curveType & 2) != 0)
+        make_polylines(yBegin, yEnd, xBegin, xEnd, false, result);
     return result;
 }
 
@@ -144,22 +116,16 @@ void Fill3DHoneycomb::_fill_surface_single(
     BoundingBox bb = expolygon.contour.bounding_box();
     coord_t     distance = coord_t(scale_(this->spacing) / params.density);
 
-    // align bounding box to a multiple of our honeycomb grid module
-    // (a module is 2*$distance since one $distance half-module is 
-    // growing while the other $distance half-module is shrinking)
-    bb.merge(align_to_grid(bb.min, Point(2*distance, 2*distance)));
-    
-    // generate pattern
-    Polylines   polylines = makeGrid(
-        scale_(this->z),
-        distance,
-        ceil(bb.size()(0) / distance) + 1,
-        ceil(bb.size()(1) / distance) + 1,
-        ((this->layer_id/thickness_layers) % 2) + 1);
-    
-    // move pattern in place
-	for (Polyline &pl : polylines)
-		pl.translate(bb.min);
+    size_t      curve_type = ((this->layer_id/thickness_layers) % 2) + 1;
+    // The pattern is periodic in Z with a period of sqrt(2) in the normalized grid coordinates.
+    double      z_period = std::sqrt(2.) * distance;
+    int         z_phase  = FillPatternCache::z_phase(scale_(this->z), z_period);
+
+    // Get the pattern cropped to the surface.
+    Polylines   polylines = FillPatternCache::get({ ip3DHoneycomb, double(distance), scale_(this->spacing), int(curve_type), z_phase }, bb,
+        [distance, curve_type, z_period, z_phase](const BoundingBox &window) {
+            return makeGrid(coord_t(FillPatternCache::z_of_phase(z_phase, z_period)), distance, window, curve_type);
+        });
 
     // clip pattern to boundaries, chain the clipped polylines
     polylines = intersection_pl(polylines, expolygon);
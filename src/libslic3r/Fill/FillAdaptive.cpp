@@ -14,11 +14,12 @@
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
+#include <bitset>
 #include <numeric>
 
-// Boost pool: Don't use mutexes to synchronize memory allocation.
-#define BOOST_POOL_NO_MT
-#include <boost/pool/object_pool.hpp>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/task_arena.h>
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
@@ -235,14 +236,31 @@ static constexpr std::array<std::array<int, 8>, 3> child_traversal_order {
     std::array<int, 8>{ 1, 5, 0, 4, 3, 7, 2, 6 },
 };
 
+// Octree cube. Cubes are stored in a flat array, one level of the octree after the other,
+// starting with the root cube. Inside a level, the cubes are sorted by their path from the root,
+// which is a Morton code of the cube position. Therefore children of a cube are stored
+// in a single continuous block of the next level, ordered by their child index.
 struct Cube
 {
-    Vec3d center;
+    Vec3d       center;
 #ifndef NDEBUG
-    Vec3d center_octree;
+    Vec3d       center_octree;
 #endif // NDEBUG
-    std::array<Cube*, 8> children {}; // initialized to nullptrs
-    Cube(const Vec3d &center) : center(center) {}
+    // Path from the root cube, three bits (child index) per level, the child index at the deepest level
+    // stored in the least significant bits. Zero for the root cube.
+    uint64_t    path        { 0 };
+    // Index of the first child in Octree::cubes, valid if child_mask != 0.
+    uint32_t    first_child { 0 };
+    // Bit i is set if children[i] exists.
+    uint8_t     child_mask  { 0 };
+    // Index into Octree::cubes_properties, the root cube has the highest depth, leaves have depth zero.
+    uint8_t     depth       { 0 };
+
+    // Index of a child in Octree::cubes, or -1 if such a child does not exist.
+    int         child(int child_idx) const {
+        return (this->child_mask & (1 << child_idx)) ?
+            int(this->first_child + std::bitset<8>(this->child_mask & ((1u << child_idx) - 1)).count()) : -1;
+    }
 };
 
 struct CubeProperties
@@ -254,19 +272,27 @@ struct CubeProperties
     double line_xy_distance;// Defines maximal distance from a center of a cube on X and Y axis on which lines will be created
 };
 
+// Maximum number of octree levels below the root, limited by the number of bits of Cube::path and of the keys
+// used to sort the cubes.
+static constexpr int max_octree_levels = 19;
+
 struct Octree
 {
-    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
-    // perfect for building up our octree.
-    boost::object_pool<Cube>    pool;
-    Cube*                       root_cube { nullptr };
+    // All cubes of the octree, cubes[0] is the root cube.
+    std::vector<Cube>           cubes;
+    // Start of each level of the octree in cubes, level zero is the root cube. The last item is cubes.size().
+    std::vector<size_t>         level_begin;
+    // Cubes of each level (indexed by level_begin) sorted by the Z coordinate of their centers in world coordinates,
+    // so that a layer may find the band of cubes it intersects by a binary search.
+    std::vector<std::pair<double, uint32_t>> cubes_by_z;
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
 
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
-        : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
+        : origin(origin), cubes_properties(cubes_properties) {}
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    const Cube& root_cube() const { return this->cubes.front(); }
+    int         num_levels() const { return int(this->level_begin.size()) - 1; }
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -356,7 +382,7 @@ std::pair<double, double> adaptive_fill_line_spacing(const PrintObject &print_ob
     return std::make_pair(adaptive_line_spacing, support_line_spacing);
 }
 
-// Context used by generate_infill_lines() when recursively traversing an octree in a DDA fashion
+// Context used by generate_infill_lines() when traversing an octree in a DDA fashion
 // (Digital Differential Analyzer).
 struct FillContext
 {
@@ -368,6 +394,7 @@ struct FillContext
     };
 
     FillContext(const Octree &octree, double z_position, int direction_idx) :
+        cubes(octree.cubes),
         cubes_properties(octree.cubes_properties),
         z_position(z_position),
         traversal_order(child_traversal_order[direction_idx]),
@@ -381,6 +408,7 @@ struct FillContext
     // Rotate the point, uses the same convention as Point::rotate().
     Vec2d rotate(const Vec2d& v) { return Vec2d(this->cos_a * v.x() - this->sin_a * v.y(), this->sin_a * v.x() + this->cos_a * v.y()); }
 
+    const std::vector<Cube>            &cubes;
     const std::vector<CubeProperties>  &cubes_properties;
     // Top of the current layer.
     const double                        z_position;
@@ -414,7 +442,7 @@ Eigen::Quaterniond transform_to_octree()
 // therefore the infill line may get extended with O(1) time & space complexity.
 static bool verify_traversal_order(
     FillContext  &context,
-    const Cube   *cube,
+    const Cube   &cube,
     int           depth,
     const Vec2d  &line_from,
     const Vec2d  &line_to)
@@ -423,8 +451,8 @@ static bool verify_traversal_order(
     Eigen::Quaterniond to_world = transform_to_world();
     for (int i = 0; i < 8; ++i) {
         int j = context.traversal_order[i];
-        Vec3d cntr = to_world * (cube->center_octree + (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.)));
-        assert(!cube->children[j] || cube->children[j]->center.isApprox(cntr));
+        Vec3d cntr = to_world * (cube.center_octree + (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.)));
+        assert(cube.child(j) == -1 || context.cubes[cube.child(j)].center.isApprox(cntr));
         c[i] = cntr;
     }
     std::array<Vec3d, 10> dirs = {
@@ -446,23 +474,70 @@ static bool verify_traversal_order(
 }
 #endif // NDEBUG
 
-static void generate_infill_lines_recursive(
-    FillContext     &context,
-    const Cube      *cube,
-    // Address of this wall in the octree,  used to address context.temp_lines.
-    int              address,
-    int              depth)
+// Collect the cubes generating an infill line at z_position, that are the cubes with their centers closer than
+// line_z_distance to z_position. Cubes of each octree level are sorted by Z, thus the band of cubes intersecting the layer
+// is found by a binary search, without traversing the octree from its root. A cube is contained in its parent cube,
+// thus the parents of the collected cubes intersect the layer as well and the result is the same as if the octree
+// was traversed recursively.
+static std::vector<uint32_t> cubes_generating_lines(const Octree &octree, double z_position)
 {
-    assert(cube != nullptr);
+    std::vector<uint32_t> out;
+    for (int level = 0; level < octree.num_levels(); ++ level) {
+        auto         begin = octree.cubes_by_z.begin() + octree.level_begin[level];
+        auto         end   = octree.cubes_by_z.begin() + octree.level_begin[level + 1];
+        const double zdist = octree.cubes_properties[octree.cubes[octree.level_begin[level]].depth].line_z_distance;
+        for (auto it = std::upper_bound(begin, end, z_position - zdist, [](double z, const std::pair<double, uint32_t> &c) { return z < c.first; });
+             it != end && it->first < z_position + zdist; ++ it)
+            out.emplace_back(it->second);
+    }
+    return out;
+}
 
+// Generate infill lines of the cubes collected by cubes_generating_lines() for a single line direction.
+// The cubes are processed in the order of a depth first traversal of the octree in context.traversal_order,
+// so that a single line is discretized in a strictly monotonic order and it may be extended in O(1).
+static void generate_infill_lines(FillContext &context, const std::vector<uint32_t> &cube_indices)
+{
     const std::vector<CubeProperties> &cubes_properties = context.cubes_properties;
-    const double z_diff     = context.z_position - cube->center.z();
-    const double z_diff_abs = std::abs(z_diff);
-
-    if (z_diff_abs > cubes_properties[depth].height / 2.)
-        return;
-
-    if (z_diff_abs < cubes_properties[depth].line_z_distance) {
+    const int                          root_depth       = int(cubes_properties.size()) - 1;
+
+    // Rank of a child in the traversal order.
+    std::array<uint64_t, 8> rank;
+    for (int i = 0; i < 8; ++ i)
+        rank[context.traversal_order[i]] = uint64_t(i);
+
+    struct CubeToTraverse {
+        // Ranks of the children along the path from the root padded to max_octree_levels, followed by the level.
+        // A cube is sorted in front of its descendants and the descendants are sorted by the traversal order.
+        uint64_t key;
+        // Address of the wall of the cube in the octree, used to address context.temp_lines.
+        int      address;
+        uint32_t cube_idx;
+        bool operator<(const CubeToTraverse &rhs) const { return this->key < rhs.key; }
+    };
+    std::vector<CubeToTraverse> cubes;
+    cubes.reserve(cube_indices.size());
+    for (uint32_t cube_idx : cube_indices) {
+        const Cube &cube    = context.cubes[cube_idx];
+        const int   level   = root_depth - int(cube.depth);
+        uint64_t    key     = 0;
+        int         address = 0;
+        for (int l = level - 1; l >= 0; -- l) {
+            uint64_t r = rank[(cube.path >> (3 * l)) & 7];
+            key = (key << 3) | r;
+            // Left child wall for the first four children in the traversal order, right child wall for the rest.
+            address = address * 2 + (r < 4 ? 1 : 2);
+        }
+        cubes.push_back({ ((key << (3 * (max_octree_levels - level))) << 5) | uint64_t(level), address, cube_idx });
+    }
+    std::sort(cubes.begin(), cubes.end());
+
+    for (const CubeToTraverse &c : cubes) {
+        const Cube  &cube       = context.cubes[c.cube_idx];
+        const int    depth      = cube.depth;
+        const double z_diff     = context.z_position - cube.center.z();
+        const double z_diff_abs = std::abs(z_diff);
+        assert(z_diff_abs < cubes_properties[depth].line_z_distance);
         // Discretize a single wall splitting the cube into two.
         const double zdist = cubes_properties[depth].line_z_distance;
         Vec2d from(
@@ -472,14 +547,14 @@ static void generate_infill_lines_recursive(
         from = context.rotate(from);
         to   = context.rotate(to);
         // Relative to cube center
-        const Vec2d offset(cube->center.x(), cube->center.y());
+        const Vec2d offset(cube.center.x(), cube.center.y());
         from += offset;
         to   += offset;
         // Verify that the traversal order of the octree children matches the line direction,
         // therefore the infill line may get extended with O(1) time & space complexity.
         assert(verify_traversal_order(context, cube, depth, from, to));
         // Either extend an existing line or start a new one.
-        Line &last_line = context.temp_lines[address];
+        Line &last_line = context.temp_lines[c.address];
         Line  new_line(Point::new_scale(from), Point::new_scale(to));
         if (last_line.a.x() == std::numeric_limits<coord_t>::max()) {
             last_line.a = new_line.a;
@@ -489,19 +564,6 @@ static void generate_infill_lines_recursive(
         }
         last_line.b = new_line.b;
     }
-
-    // left child index
-    address = address * 2 + 1;
-    -- depth;
-    size_t i = 0;
-    for (const int child_idx : context.traversal_order) {
-        const Cube *child = cube->children[child_idx];
-        if (child != nullptr)
-            generate_infill_lines_recursive(context, child, address, depth);
-        if (++ i == 4)
-            // right child index
-            ++ address;
-    }
 }
 
 #ifndef NDEBUG
@@ -1333,9 +1395,10 @@ void Filler::_fill_surface_single(
             FillContext { *adapt_fill_octree, this->z, 2 }
         };
         // Generate the infill lines along the octree cells, merge touching lines of the same direction.
+        const std::vector<uint32_t> cubes = cubes_generating_lines(*adapt_fill_octree, this->z);
         size_t num_lines = 0;
         for (auto &context : contexts) {
-            generate_infill_lines_recursive(context, adapt_fill_octree->root_cube, 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
+            generate_infill_lines(context, cubes);
             num_lines += context.output_lines.size() + context.temp_lines.size();
         }
 
@@ -1449,76 +1512,43 @@ static inline bool is_overhang_triangle(const Vec3d &a, const Vec3d &b, const Ve
     return n.dot(up) > 0.707 * n.norm();
 }
 
-static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
-{
-#ifndef NDEBUG
-    current_cube->center_octree = current_cube->center;
-#endif // NDEBUG
-    current_cube->center = rot * current_cube->center;
-    for (auto *child : current_cube->children)
-        if (child)
-            transform_center(child, rot);
-}
+// Key of a cube used to sort the cubes while building the octree: Level of the cube (five most significant bits)
+// followed by Cube::path. Sorting the keys orders the cubes by their level first, then by their Morton code.
+static constexpr int      cube_key_level_shift = 58;
+static constexpr uint64_t cube_key_path_mask   = (uint64_t(1) << cube_key_level_shift) - 1;
+static inline uint64_t    cube_key(int level, uint64_t path) { return (uint64_t(level) << cube_key_level_shift) | path; }
 
-OctreePtr build_octree(
-    // Mesh is rotated to the coordinate system of the octree.
-    const indexed_triangle_set  &triangle_mesh,
-    // Overhang triangles extracted from fill surfaces with stInternalBridge type,
-    // rotated to the coordinate system of the octree.
-    const std::vector<Vec3d>    &overhang_triangles, 
-    coordf_t                     line_spacing,
-    bool                         support_overhangs_only)
+// Keys of cubes intersected by a subset of triangles.
+struct CubeKeys
 {
-    assert(line_spacing > 0);
-    assert(! std::isnan(line_spacing));
-
-    BoundingBox3Base<Vec3f>     bbox(triangle_mesh.vertices);
-    Vec3d                       cube_center      = bbox.center().cast<double>();
-    std::vector<CubeProperties> cubes_properties = make_cubes_properties(double(bbox.size().maxCoeff()), line_spacing);
-    auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
-
-    if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
-        double edge_length_half = 0.5 * cubes_properties.back().edge_length;
-        Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
-        int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
-        };
-        auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
-        }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
-        {
-            // Transform the octree to world coordinates to reduce computation when extracting infill lines.
-            auto rot = transform_to_world().toRotationMatrix();
-            transform_center(octree->root_cube, rot);
-            octree->origin = rot * octree->origin;
+    std::vector<uint64_t> keys;
+    // Number of keys after the last removal of duplicates.
+    size_t                num_unique { 0 };
+
+    void add(uint64_t key) {
+        this->keys.emplace_back(key);
+        // Neighboring triangles intersect mostly the same cubes, remove the duplicates before they consume too much memory.
+        if (this->keys.size() > 2 * this->num_unique + 65536) {
+            sort_remove_duplicates(this->keys);
+            this->num_unique = this->keys.size();
         }
     }
+};
 
-    return octree;
-}
-
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+// Collect keys of all the cubes below the current cube intersected by a triangle.
+static void insert_triangle(
+    const std::vector<CubeProperties> &cubes_properties,
+    const Vec3d &a, const Vec3d &b, const Vec3d &c,
+    const Vec3d &current_center, uint64_t current_path, const BoundingBoxf3 &current_bbox, int level, int depth,
+    CubeKeys &out)
 {
-    assert(current_cube);
     assert(depth > 0);
 
     --depth;
+    ++level;
 
     // Squared radius of a sphere around the child cube.
-    // const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[depth].height + EPSILON);
+    // const double r2_cube = Slic3r::sqr(0.5 * cubes_properties[depth].height + EPSILON);
 
     for (size_t i = 0; i < 8; ++ i) {
         const Vec3d &child_center_dir = child_centers[i];
@@ -1528,23 +1558,158 @@ void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cub
         for (int k = 0; k < 3; ++ k) {
             if (child_center_dir[k] == -1.) {
                 bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
+                bbox.max[k] = current_center[k] + EPSILON;
             } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
+                bbox.min[k] = current_center[k] - EPSILON;
                 bbox.max[k] = current_bbox.max[k];
             }
         }
-        Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
         //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
         // dist2_to_triangle and r2_cube are commented out too.
         if (triangle_AABB_intersects(a, b, c, bbox)) {
-            if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
-            if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
+            uint64_t child_path = (current_path << 3) | i;
+            out.add(cube_key(level, child_path));
+            if (depth > 0) {
+                Vec3d child_center = current_center + (child_center_dir * (cubes_properties[depth].edge_length / 2.));
+                insert_triangle(cubes_properties, a, b, c, child_center, child_path, bbox, level, depth, out);
+            }
         }
     }
 }
 
+OctreePtr build_octree(
+    // Mesh is rotated to the coordinate system of the octree.
+    const indexed_triangle_set  &triangle_mesh,
+    // Overhang triangles extracted from fill surfaces with stInternalBridge type,
+    // rotated to the coordinate system of the octree.
+    const std::vector<Vec3d>    &overhang_triangles, 
+    coordf_t                     line_spacing,
+    bool                         support_overhangs_only)
+{
+    assert(line_spacing > 0);
+    assert(! std::isnan(line_spacing));
+
+    BoundingBox3Base<Vec3f>     bbox(triangle_mesh.vertices);
+    Vec3d                       cube_center      = bbox.center().cast<double>();
+    std::vector<CubeProperties> cubes_properties = make_cubes_properties(double(bbox.size().maxCoeff()), line_spacing);
+    auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
+    const int                   max_depth        = int(cubes_properties.size()) - 1;
+
+    if (max_depth > max_octree_levels)
+        throw Slic3r::RuntimeError("Adaptive infill: The object is too large for the infill line spacing.");
+
+    {
+        Cube root;
+        root.center = cube_center;
+#ifndef NDEBUG
+        root.center_octree = cube_center;
+#endif // NDEBUG
+        root.depth = uint8_t(max_depth);
+        octree->cubes.emplace_back(root);
+        octree->level_begin = { 0, 1 };
+    }
+
+    if (max_depth > 0) {
+        // Collect keys of the cubes intersected by the triangles in parallel, then sort them and remove duplicates.
+        std::vector<uint64_t> keys;
+        {
+            double edge_length_half = 0.5 * cubes_properties.back().edge_length;
+            Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
+            BoundingBoxf3 root_bbox(cube_center - diag_half, cube_center + diag_half);
+            auto   up_vector        = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
+            size_t num_mesh_triangles = triangle_mesh.indices.size();
+            size_t num_triangles      = num_mesh_triangles + overhang_triangles.size() / 3;
+            // Split the triangles into chunks of equal size, so that a chunk collects its own cubes without synchronization.
+            std::vector<CubeKeys> chunks(std::min(num_triangles, 4 * size_t(tbb::this_task_arena::max_concurrency())));
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size(), 1),
+                [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+                    CubeKeys &chunk = chunks[chunk_idx];
+                    for (size_t i = num_triangles * chunk_idx / chunks.size(); i < num_triangles * (chunk_idx + 1) / chunks.size(); ++ i)
+                        if (i < num_mesh_triangles) {
+                            const stl_triangle_vertex_indices &tri = triangle_mesh.indices[i];
+                            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
+                            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
+                            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
+                            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
+                                insert_triangle(cubes_properties, a, b, c, cube_center, 0, root_bbox, 0, max_depth, chunk);
+                        } else {
+                            size_t j = 3 * (i - num_mesh_triangles);
+                            insert_triangle(cubes_properties, overhang_triangles[j], overhang_triangles[j + 1], overhang_triangles[j + 2],
+                                cube_center, 0, root_bbox, 0, max_depth, chunk);
+                        }
+                    sort_remove_duplicates(chunk.keys);
+                }
+            });
+            size_t num_keys = 0;
+            for (const CubeKeys &chunk : chunks)
+                num_keys += chunk.keys.size();
+            keys.reserve(num_keys);
+            for (CubeKeys &chunk : chunks) {
+                append(keys, std::move(chunk.keys));
+                chunk.keys.shrink_to_fit();
+            }
+            tbb::parallel_sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        }
+
+        // Linearize the octree. Keys are sorted by level, then by path, thus the cubes of the previous level
+        // are already stored and the children of a single cube are stored next to each other.
+        assert(keys.size() < size_t(std::numeric_limits<uint32_t>::max()));
+        octree->cubes.reserve(keys.size() + 1);
+        size_t parent_idx = 0;
+        for (uint64_t key : keys) {
+            const int      level = int(key >> cube_key_level_shift);
+            const uint64_t path  = key & cube_key_path_mask;
+            if (level == octree->num_levels()) {
+                // First cube of a new level.
+                parent_idx = octree->level_begin[level - 1];
+                octree->level_begin.emplace_back(octree->cubes.size());
+            }
+            assert(level + 1 == octree->num_levels());
+            // Parents are sorted the same way as their children, the parent is at or after the parent of the previous cube.
+            while (octree->cubes[parent_idx].path != (path >> 3)) {
+                ++ parent_idx;
+                assert(parent_idx < octree->level_begin[level]);
+            }
+            const int child_idx = int(path & 7);
+            Cube     &parent    = octree->cubes[parent_idx];
+            Cube      cube;
+            cube.path   = path;
+            cube.depth  = uint8_t(max_depth - level);
+            cube.center = parent.center + (child_centers[child_idx] * (cubes_properties[cube.depth].edge_length / 2.));
+            if (parent.child_mask == 0)
+                parent.first_child = uint32_t(octree->cubes.size());
+            parent.child_mask |= uint8_t(1 << child_idx);
+            octree->cubes.emplace_back(cube);
+            octree->level_begin.back() = octree->cubes.size();
+        }
+
+        {
+            // Transform the octree to world coordinates to reduce computation when extracting infill lines.
+            auto rot = transform_to_world().toRotationMatrix();
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, octree->cubes.size()), [&octree, &rot](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    Cube &cube = octree->cubes[i];
+#ifndef NDEBUG
+                    cube.center_octree = cube.center;
+#endif // NDEBUG
+                    cube.center = rot * cube.center;
+                }
+            });
+            octree->origin = rot * octree->origin;
+        }
+    }
+
+    // Index the cubes of each level by their Z coordinate.
+    octree->cubes_by_z.reserve(octree->cubes.size());
+    for (size_t i = 0; i < octree->cubes.size(); ++ i)
+        octree->cubes_by_z.emplace_back(octree->cubes[i].center.z(), uint32_t(i));
+    for (int level = 0; level < octree->num_levels(); ++ level)
+        tbb::parallel_sort(octree->cubes_by_z.begin() + octree->level_begin[level], octree->cubes_by_z.begin() + octree->level_begin[level + 1]);
+
+    return octree;
+}
+
 } // namespace FillAdaptive
 } // namespace Slic3r
@@ -12,6 +12,7 @@
 #include "../libslic3r.h"
 #include "../BoundingBox.hpp"
 #include "../Exception.hpp"
+#include "../PrintConfig.hpp"
 #include "../Utils.hpp"
 
 namespace Slic3r {
@@ -49,6 +50,8 @@ struct FillParams
 
     // Monotonic infill - strictly left to right for better surface quality of top infills.
     bool 		monotonic		{ false };
+    // Effort spent on ordering the regions of the monotonic infill.
+    MonotonicQuality monotonic_quality { MonotonicQuality::Normal };
 
     // For Honeycomb.
     // we were requested to complete each loop;
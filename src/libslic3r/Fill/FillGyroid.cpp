@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "FillGyroid.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -29,39 +30,6 @@ static inline double f(double x, double z_sin, double z_cos, bool vertical, bool
     }
 }
 
-static inline Polyline make_wave(
-    const std::vector<Vec2d>& one_period, double width, double height, double offset, double scaleFactor,
-    double z_cos, double z_sin, bool vertical, bool flip)
-{
-    std::vector<Vec2d> points = one_period;
-    double period = points.back()(0);
-    if (width != period) // do not extend if already truncated
-    {
-        points.reserve(one_period.size() * size_t(floor(width / period)));
-        points.pop_back();
-
-        size_t n = points.size();
-        do {
-            points.emplace_back(points[points.size()-n].x() + period, points[points.size()-n].y());
-        } while (points.back()(0) < width - EPSILON);
-
-        points.emplace_back(Vec2d(width, f(width, z_sin, z_cos, vertical, flip)));
-    }
-
-    // and construct the final polyline to return:
-    Polyline polyline;
-    polyline.points.reserve(points.size());
-    for (auto& point : points) {
-        point(1) += offset;
-        point(1) = std::clamp(double(point.y()), 0., height);
-        if (vertical)
-            std::swap(point(0), point(1));
-        polyline.points.emplace_back((point * scaleFactor).cast<coord_t>());
-    }
-
-    return polyline;
-}
-
 static std::vector<Vec2d> make_one_period(double width, double scaleFactor, double z_cos, double z_sin, bool vertical, bool flip, double tolerance)
 {
     std::vector<Vec2d> points;
@@ -102,7 +70,9 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
     return points;
 }
 
-static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+// Generate the gyroid waves covering the window. The waves are anchored to the origin of the coordinate system,
+// thus they do not depend on the window, and they extend beyond the window by at least a period.
+static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, const BoundingBox &window)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -117,29 +87,43 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
     const double z_cos = cos(z);
 
     bool vertical = (std::abs(z_sin) <= std::abs(z_cos));
-    double lower_bound = 0.;
-    double upper_bound = height;
-    bool flip = true;
-    if (vertical) {
-        flip = false;
-        lower_bound = -M_PI;
-        upper_bound = width - M_PI_2;
-        std::swap(width,height);
-    }
-
-    std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
+    // The waves run along the main axis and they are stacked along the cross axis.
+    const int    main_axis   = vertical ? 1 : 0;
+    const int    cross_axis  = 1 - main_axis;
+    // Offset of the odd waves, the even waves are shifted by M_PI.
+    const double lower_bound = vertical ? - M_PI : 0.;
+    bool flip = ! vertical;
+
+    std::vector<Vec2d> one_period_odd = make_one_period(2. * M_PI, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
     flip = !flip;                                                                   // even polylines are a bit shifted
-    std::vector<Vec2d> one_period_even = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
-    Polylines result;
+    std::vector<Vec2d> one_period_even = make_one_period(2. * M_PI, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
 
-    for (double y0 = lower_bound; y0 < upper_bound + EPSILON; y0 += M_PI) {
-        // creates odd polylines
-        result.emplace_back(make_wave(one_period_odd, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip));
-        // creates even polylines
-        y0 += M_PI;
-        if (y0 < upper_bound + EPSILON) {
-            result.emplace_back(make_wave(one_period_even, width, height, y0, scaleFactor, z_cos, z_sin, vertical, flip));
-        }
+    // Periods along the main axis covering the window with a margin of a period.
+    const int period_begin = int(std::floor(window.min(main_axis) / scaleFactor / (2. * M_PI))) - 1;
+    const int period_end   = int(std::ceil (window.max(main_axis) / scaleFactor / (2. * M_PI))) + 1;
+    // Waves along the cross axis intersecting the window. A wave spans <-M_PI/2, 2*M_PI> around its offset.
+    const int wave_begin   = int(std::floor((window.min(cross_axis) / scaleFactor - lower_bound) / M_PI)) - 2;
+    const int wave_end     = int(std::ceil ((window.max(cross_axis) / scaleFactor - lower_bound) / M_PI)) + 1;
+
+    Polylines result;
+    result.reserve(wave_end - wave_begin);
+    for (int wave = wave_begin; wave < wave_end; ++ wave) {
+        // Odd waves at even multiples of M_PI from lower_bound.
+        const std::vector<Vec2d> &one_period = (wave & 1) == 0 ? one_period_odd : one_period_even;
+        const double              offset     = lower_bound + wave * M_PI;
+        Polyline                  polyline;
+        polyline.points.reserve((period_end - period_begin) * (one_period.size() - 1) + 1);
+        auto add_point = [&polyline, main_axis, cross_axis, scaleFactor, offset](double x, double y) {
+            Point pt;
+            pt(main_axis)  = coord_t(lrint(x * scaleFactor));
+            pt(cross_axis) = coord_t(lrint((y + offset) * scaleFactor));
+            polyline.points.emplace_back(pt);
+        };
+        for (int period = period_begin; period < period_end; ++ period)
+            for (size_t i = 0; i + 1 < one_period.size(); ++ i)
+                add_point(one_period[i].x() + 2. * M_PI * period, one_period[i].y());
+        add_point(one_period.back().x() + 2. * M_PI * (period_end - 1), one_period.back().y());
+        result.emplace_back(std::move(polyline));
     }
 
     return result;
@@ -163,22 +147,16 @@ void FillGyroid::_fill_surface_single(
     // Density adjusted to have a good %of weight.
     double      density_adjusted = std::max(0., params.density * DensityAdjust);
     // Distance between the gyroid waves in scaled coordinates.
-    coord_t     distance = coord_t(scale_(this->spacing) / density_adjusted);
-
-    // align bounding box to a multiple of our grid module
-    bb.merge(align_to_grid(bb.min, Point(2*M_PI*distance, 2*M_PI*distance)));
-
-    // generate pattern
-    Polylines polylines = make_gyroid_waves(
-        scale_(this->z),
-        density_adjusted,
-        this->spacing,
-        ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
-
-	// shift the polyline to the grid origin
-	for (Polyline &pl : polylines)
-		pl.translate(bb.min);
+    double      scale_factor = scale_(this->spacing) / density_adjusted;
+    // The pattern is periodic in Z with a period of 2 PI in the pattern coordinates.
+    double      z_period = 2. * M_PI * scale_factor;
+    int         z_phase  = FillPatternCache::z_phase(scale_(this->z), z_period);
+
+    // Get the pattern cropped to the surface.
+    Polylines polylines = FillPatternCache::get({ ipGyroid, scale_factor, scale_(this->spacing), 0, z_phase }, bb,
+        [this, density_adjusted, z_period, z_phase](const BoundingBox &window) {
+            return make_gyroid_waves(FillPatternCache::z_of_phase(z_phase, z_period), density_adjusted, this->spacing, window);
+        });
 
 	polylines = intersection_pl(polylines, expolygon);
 
@@ -0,0 +1,167 @@
+#include "FillPatternCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace Slic3r {
+
+// Maximum number of points of the patterns cached (about 64MB). Patterns are mostly shared by the surfaces
+// of the same layer of the objects, as the Z phase of the neighbor layers differs. The objects and their layers
+// are filled in parallel, the patterns of the layers being filled at the same time shall fit.
+static constexpr size_t max_points_cached = 8 * 1024 * 1024;
+
+struct CachedPattern
+{
+    // Part of the XY plane covered by the pattern.
+    BoundingBox                 window;
+    Polylines                   polylines;
+    struct Info {
+        BoundingBox bbox;
+        // Axis along which the polyline is monotonic, -1 if not monotonic.
+        int         axis;
+        bool        increasing;
+    };
+    std::vector<Info>           infos;
+    size_t                      num_points { 0 };
+};
+
+static std::mutex                                                                               s_mutex;
+// Most recently used first.
+static std::list<std::pair<FillPatternCache::Key, std::shared_ptr<const CachedPattern>>>       s_patterns;
+static size_t                                                                                   s_num_points = 0;
+
+int FillPatternCache::z_phase(double z, double period)
+{
+    assert(period > 0.);
+    double phase = z / period;
+    int    step  = int(std::floor((phase - std::floor(phase)) * z_phase_steps + 0.5));
+    return step == z_phase_steps ? 0 : step;
+}
+
+static inline double area(const BoundingBox &bbox)
+{
+    return double(bbox.size().x()) * double(bbox.size().y());
+}
+
+static std::shared_ptr<const CachedPattern> make_cached_pattern(const BoundingBox &window, Polylines &&polylines)
+{
+    auto out = std::make_shared<CachedPattern>();
+    out->window    = window;
+    out->polylines = std::move(polylines);
+    out->infos.reserve(out->polylines.size());
+    for (const Polyline &pl : out->polylines) {
+        CachedPattern::Info info { get_extents(pl), -1, true };
+        if (pl.size() >= 2) {
+            // Prefer the axis of the larger extent, along which the cropping is more efficient.
+            const bool y_first = info.bbox.size().y() > info.bbox.size().x();
+            for (int iaxis = 0; iaxis < 2 && info.axis == -1; ++ iaxis) {
+                const int  axis       = y_first ? 1 - iaxis : iaxis;
+                const bool increasing = pl.points.front()(axis) <= pl.points.back()(axis);
+                bool       monotonic  = true;
+                for (size_t i = 1; monotonic && i < pl.points.size(); ++ i)
+                    monotonic = increasing ? pl.points[i - 1](axis) <= pl.points[i](axis) : pl.points[i - 1](axis) >= pl.points[i](axis);
+                if (monotonic) {
+                    info.axis       = axis;
+                    info.increasing = increasing;
+                }
+            }
+        }
+        out->infos.emplace_back(info);
+        out->num_points += pl.size();
+    }
+    return out;
+}
+
+static Polylines crop_cached_pattern(const CachedPattern &pattern, const BoundingBox &bbox)
+{
+    Polylines out;
+    for (size_t idx = 0; idx < pattern.polylines.size(); ++ idx) {
+        const CachedPattern::Info &info = pattern.infos[idx];
+        if (! info.bbox.overlap(bbox))
+            continue;
+        const Points &pts = pattern.polylines[idx].points;
+        if (info.axis == -1 || bbox.contains(info.bbox)) {
+            out.emplace_back(pts);
+            continue;
+        }
+        // Crop a polyline monotonic along axis, keep the first point outside bbox on both sides,
+        // so that the segments crossing the bbox boundary are retained.
+        const int     axis = info.axis;
+        const coord_t lo   = bbox.min(axis);
+        const coord_t hi   = bbox.max(axis);
+        Points::const_iterator first, last;
+        if (info.increasing) {
+            first = std::partition_point(pts.begin(), pts.end(), [axis, lo](const Point &pt) { return pt(axis) < lo; });
+            last  = std::partition_point(first, pts.end(), [axis, hi](const Point &pt) { return pt(axis) <= hi; });
+        } else {
+            first = std::partition_point(pts.begin(), pts.end(), [axis, hi](const Point &pt) { return pt(axis) > hi; });
+            last  = std::partition_point(first, pts.end(), [axis, lo](const Point &pt) { return pt(axis) >= lo; });
+        }
+        if (first != pts.begin())
+            -- first;
+        if (last != pts.end())
+            ++ last;
+        if (last - first >= 2)
+            out.emplace_back(Points(first, last));
+    }
+    return out;
+}
+
+Polylines FillPatternCache::get(const Key &key, const BoundingBox &bbox, const Generator &generate)
+{
+    std::shared_ptr<const CachedPattern> pattern;
+    // Cached pattern to be replaced by a grown one.
+    std::shared_ptr<const CachedPattern> pattern_to_grow;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for (auto it = s_patterns.begin(); it != s_patterns.end(); ++ it)
+            if (it->first == key) {
+                if (it->second->window.contains(bbox)) {
+                    pattern = it->second;
+                    s_patterns.splice(s_patterns.begin(), s_patterns, it);
+                    break;
+                }
+                // Grow a pattern close to bbox, so that the generated area is at most twice the area requested.
+                BoundingBox window = it->second->window;
+                window.merge(bbox);
+                if (! pattern_to_grow && area(window) <= 2. * (area(it->second->window) + area(bbox)))
+                    pattern_to_grow = it->second;
+            }
+    }
+
+    if (! pattern) {
+        BoundingBox window = bbox;
+        if (pattern_to_grow)
+            window.merge(pattern_to_grow->window);
+        pattern = make_cached_pattern(window, generate(window));
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (pattern_to_grow) {
+            // The grown pattern may have been released by another thread in the meantime.
+            auto it = std::find_if(s_patterns.begin(), s_patterns.end(), [&pattern_to_grow](const auto &kvp) { return kvp.second == pattern_to_grow; });
+            if (it != s_patterns.end()) {
+                s_num_points -= it->second->num_points;
+                s_patterns.erase(it);
+            }
+        }
+        s_patterns.emplace_front(key, pattern);
+        s_num_points += pattern->num_points;
+        while (s_num_points > max_points_cached && s_patterns.size() > 1) {
+            s_num_points -= s_patterns.back().second->num_points;
+            s_patterns.pop_back();
+        }
+    }
+
+    return crop_cached_pattern(*pattern, bbox);
+}
+
+void FillPatternCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_patterns.clear();
+    s_num_points = 0;
+}
+
+} // namespace Slic3r
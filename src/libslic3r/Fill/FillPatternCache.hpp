@@ -0,0 +1,63 @@
+#ifndef slic3r_FillPatternCache_hpp_
+#define slic3r_FillPatternCache_hpp_
+
+#include "../libslic3r.h"
+#include "../BoundingBox.hpp"
+#include "../Polyline.hpp"
+#include "../PrintConfig.hpp"
+
+#include <functional>
+
+namespace Slic3r {
+
+// Cache of the periodic infill patterns (gyroid, 3D honeycomb) shared by all layers and objects.
+// These patterns are anchored to a grid aligned to a multiple of the pattern module, thus they do not depend
+// on the surface being filled, only on the pattern parameters and on the phase of the print Z inside the pattern period.
+// The cache keeps the pattern polylines generated over windows of the XY plane, the surfaces sharing the pattern
+// parameters then only crop the cached polylines to their bounding box before clipping them with the surface.
+// Thread safe. Released by clear() once the infill of all objects is generated.
+class FillPatternCache
+{
+public:
+    struct Key {
+        InfillPattern   pattern;
+        // Distance of the pattern lines, scaled. Defines the pattern module.
+        double          distance;
+        // Extrusion spacing, scaled. May define the resolution of the pattern.
+        double          spacing;
+        // Pattern specific variant, for example the direction of the 3D honeycomb lines.
+        int             variant;
+        // Phase of the print Z inside the pattern period, see z_phase().
+        int             z_phase;
+
+        bool operator==(const Key &rhs) const {
+            return pattern == rhs.pattern && distance == rhs.distance && spacing == rhs.spacing && variant == rhs.variant && z_phase == rhs.z_phase;
+        }
+    };
+
+    // Number of phase steps per pattern period. The pattern is generated at the quantized Z, the error of
+    // 1 / (2 * z_phase_steps) of the pattern period is well below the printer resolution.
+    static constexpr int z_phase_steps = 1024;
+    // Quantize the phase of z inside a pattern period to one of z_phase_steps.
+    static int    z_phase(double z, double period);
+    // Z of the start of a pattern period plus the quantized phase.
+    static double z_of_phase(int z_phase, double period) { return period * double(z_phase) / double(z_phase_steps); }
+
+    // Generate the pattern polylines covering the window. The pattern shall be anchored to the origin of the coordinate system
+    // and it shall extend beyond the window, so that cropping the polylines to any bounding box inside the window
+    // produces the same result independently of the window. Then the filling does not depend on the cache history.
+    // The cropping is efficient if each polyline is monotonic along the X or the Y axis.
+    using Generator = std::function<Polylines(const BoundingBox &window)>;
+
+    // Return the pattern polylines covering bbox, cropped to bbox, generating the pattern if it is not cached yet.
+    // A cached pattern close to bbox is grown to cover bbox, as the surfaces of the neighbor islands and of the other objects
+    // (sharing the object coordinate system centered around the object) are likely to share the pattern.
+    static Polylines get(const Key &key, const BoundingBox &bbox, const Generator &generate);
+
+    // Release the cached patterns.
+    static void      clear();
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_FillPatternCache_hpp_
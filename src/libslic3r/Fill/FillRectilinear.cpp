@@ -5,6 +5,7 @@
 #include <cmath>
 #include <limits>
 #include <random>
+#include <unordered_map>
 
 #include <boost/container/small_vector.hpp>
 #include <boost/log/trivial.hpp>
@@ -1650,20 +1651,30 @@ public:
 		m_regions(regions),
 		m_poly_with_offset(poly_with_offset),
 		m_segs(segs),
+		m_initial_pheromone(initial_pheromone)
+	{
 		// From end of one region to the start of another region, both flipped or not flipped.
-		m_matrix(regions.size() * regions.size() * 4, AntPath{ -1., -1., initial_pheromone}) {}
+		// A dense matrix for a low number of regions, otherwise only the links actually evaluated are stored.
+		if (regions.size() <= max_regions_dense)
+			m_matrix.assign(regions.size() * regions.size() * 4, AntPath{ -1., -1., initial_pheromone });
+	}
 
 	void update_inital_pheromone(float initial_pheromone)
 	{
+		m_initial_pheromone = initial_pheromone;
 		for (AntPath &ap : m_matrix)
 			ap.pheromone = initial_pheromone;
+		for (auto &kvp : m_sparse)
+			kvp.second.pheromone = initial_pheromone;
 	}
 
 	AntPath& operator()(const MonotonicRegion &region_from, bool flipped_from, const MonotonicRegion &region_to, bool flipped_to)
 	{
 		int row = 2 * int(&region_from - m_regions.data()) + flipped_from;
 		int col = 2 * int(&region_to   - m_regions.data()) + flipped_to;
-		AntPath &path = m_matrix[row * m_regions.size() * 2 + col];
+		size_t   idx  = size_t(row) * m_regions.size() * 2 + size_t(col);
+		// References to the sparse entries stay valid, std::unordered_map does not move its nodes.
+		AntPath &path = m_matrix.empty() ? m_sparse.try_emplace(idx, AntPath{ -1., -1., m_initial_pheromone }).first->second : m_matrix[idx];
 		if (path.length == -1.) {
 			// This path is accessed for the first time. Update the length and cost.
 			int i_from = region_from.right_intersection_point(flipped_from);
@@ -1699,9 +1710,13 @@ private:
 	// To calculate the intersection points and contour lengths.
 	const ExPolygonWithOffset 						&m_poly_with_offset;
 	const std::vector<SegmentedIntersectionLine> 	&m_segs;
+	// Maximum number of regions to store the paths in a dense matrix, which takes 48 bytes per pair of regions.
+	static constexpr size_t const                    max_regions_dense = 512;
+	float                                            m_initial_pheromone;
 	// From end of one region to the start of another region, both flipped or not flipped.
-	//FIXME one may possibly use sparse representation of the matrix, likely using hashing.
 	std::vector<AntPath>					         m_matrix;
+	// Sparse representation of m_matrix for a high number of regions, where only a small fraction of the links is ever evaluated.
+	std::unordered_map<size_t, AntPath>              m_sparse;
 };
 
 static const SegmentIntersection& vertical_run_bottom(const SegmentedIntersectionLine &vline, const SegmentIntersection &start)
@@ -2202,6 +2217,62 @@ void monotonic_3_opt(std::vector<MonotonicRegionLink> &path, const std::vector<S
 	// exchange by copying the pieces.
 }
 
+// Flip the zig-zags of the individual regions along the path if it shortens the path. Flipping a region does not change the order
+// of the regions, thus the precedence constraints remain satisfied. The lengths of the links are cached by path_matrix,
+// thus evaluating a flip costs just a few lookups.
+static void monotonic_flip_opt(std::vector<MonotonicRegionLink> &path, AntPathMatrix &path_matrix)
+{
+	// Length of the i-th region and of its links to the neighbor regions on the path.
+	auto cost = [&path, &path_matrix](size_t i, bool flipped) {
+		const MonotonicRegionLink &link = path[i];
+		float c = link.region->length(flipped);
+		if (i > 0)
+			c += path_matrix(path[i - 1], *link.region, flipped).length;
+		if (i + 1 < path.size())
+			c += path_matrix(*link.region, flipped, path[i + 1]).length;
+		return c;
+	};
+	// Each flip shortens the path, a few passes converge.
+	constexpr int const num_passes_max = 4;
+	bool improved = true;
+	for (int pass = 0; pass < num_passes_max && improved; ++ pass) {
+		improved = false;
+		for (size_t i = 0; i < path.size(); ++ i)
+			if (cost(i, ! path[i].flipped) + float(EPSILON) < cost(i, path[i].flipped)) {
+				path[i].flipped = ! path[i].flipped;
+				improved = true;
+			}
+	}
+	for (size_t i = 0; i + 1 < path.size(); ++ i) {
+		path[i].next         = &path_matrix(path[i], path[i + 1]);
+		path[i].next_flipped = &path_matrix(*path[i].region, ! path[i].flipped, *path[i + 1].region, ! path[i + 1].flipped);
+	}
+}
+
+// Budget of the ant colony optimization for a MonotonicQuality level. The budget is measured by the number of links between regions
+// evaluated as candidates for the next step of an ant, not by time, so that the resulting path is deterministic.
+struct MonotonicChainingBudget
+{
+	// How many times to repeat the ant simulation (number of ant generations).
+	int 	num_rounds;
+	// After how many rounds without an improvement to exit?
+	int 	num_rounds_no_change_exit;
+	// Maximum number of ants of a single round.
+	int 	max_ants;
+	// No new ant is started after this number of candidate links was evaluated.
+	size_t 	max_link_evaluations;
+};
+
+static MonotonicChainingBudget monotonic_chaining_budget(MonotonicQuality quality)
+{
+	switch (quality) {
+	case MonotonicQuality::Fast: return { 0, 0, 0, 0 };
+	case MonotonicQuality::Best: return { 100, 20, 20, 64 * 1024 * 1024 };
+	case MonotonicQuality::Normal:
+	default:                     return { 25, 8, 10, 2 * 1024 * 1024 };
+	}
+}
+
 // #define SLIC3R_DEBUG_ANTS
 
 template<typename... TArgs>
@@ -2213,8 +2284,10 @@ inline void print_ant(const std::string& fmt, TArgs&&... args) {
 
 // Find a run through monotonic infill blocks using an 'Ant colony" optimization method.
 // http://www.scholarpedia.org/article/Ant_colony_optimization
+// The greedy path is improved by the ants within the budget given by quality.
 static std::vector<MonotonicRegionLink> chain_monotonic_regions(
-	std::vector<MonotonicRegion> &regions, const ExPolygonWithOffset &poly_with_offset, const std::vector<SegmentedIntersectionLine> &segs, std::mt19937_64 &rng)
+	std::vector<MonotonicRegion> &regions, const ExPolygonWithOffset &poly_with_offset, const std::vector<SegmentedIntersectionLine> &segs,
+	MonotonicQuality quality, std::mt19937_64 &rng)
 {
 	// Number of left neighbors (regions that this region depends on, this region cannot be printed before the regions left of it are printed) + self.
 	std::vector<int32_t>			left_neighbors_unprocessed(regions.size(), 1);
@@ -2302,12 +2375,15 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
         };
 #endif /* NDEBUG */
 
+	const MonotonicChainingBudget budget = monotonic_chaining_budget(quality);
 	// How many times to repeat the ant simulation (number of ant generations).
-	constexpr int const   num_rounds = 25;
+	const int             num_rounds = budget.num_rounds;
 	// After how many rounds without an improvement to exit?
-	constexpr int const   num_rounds_no_change_exit = 8;
+	const int             num_rounds_no_change_exit = budget.num_rounds_no_change_exit;
 	// With how many ants each of the run will be performed?
-	const int             num_ants = std::min(int(regions.size()), 10);
+	const int             num_ants = std::min(int(regions.size()), budget.max_ants);
+	// Number of links evaluated as candidates by the ants.
+	size_t                num_link_evaluations = 0;
 	// Base (initial) pheromone level. This value will be adjusted based on the length of the first greedy path found.
 	float                 pheromone_initial_deposit = 0.5f;
 	// Evaporation rate of pheromones.
@@ -2329,15 +2405,16 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
 		left_neighbors_unprocessed = left_neighbors_unprocessed_initial;
         assert(validate_unprocessed());
         // Pick the last of the queue.
-        MonotonicRegionLink path_end { queue.back(), false };
+        path.clear();
+        path.emplace_back(MonotonicRegionLink{ queue.back(), false });
         queue.pop_back();
-        -- left_neighbors_unprocessed[path_end.region - regions.data()];
+        -- left_neighbors_unprocessed[path.back().region - regions.data()];
 
-        float total_length = path_end.region->length(false);
-		while (! queue.empty() || ! path_end.region->right_neighbors.empty()) {
+        float total_length = path.back().region->length(false);
+		while (! queue.empty() || ! path.back().region->right_neighbors.empty()) {
             // Chain.
-			MonotonicRegion 		    &region = *path_end.region;
-			bool 			  			 dir    = path_end.flipped;
+			MonotonicRegion 		    &region = *path.back().region;
+			bool 			  			 dir    = path.back().flipped;
 			NextCandidate 				 next_candidate;
 			next_candidate.probability = 0;
 			for (MonotonicRegion *next : region.right_neighbors) {
@@ -2378,8 +2455,10 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
             assert(next_candidate.region);
 			MonotonicRegion *next_region = next_candidate.region;
 			bool              next_dir    = next_candidate.dir;
-            total_length += next_region->length(next_dir) + path_matrix(*path_end.region, path_end.flipped, *next_region, next_dir).length;
-            path_end = { next_region, next_dir };
+            total_length += next_region->length(next_dir) + next_candidate.link->length;
+            path.back().next         = next_candidate.link;
+            path.back().next_flipped = &path_matrix(region, ! dir, *next_region, ! next_dir);
+            path.emplace_back(MonotonicRegionLink{ next_region, next_dir });
             assert(left_neighbors_unprocessed[next_region - regions.data()] == 1);
             left_neighbors_unprocessed[next_region - regions.data()] = 0;          
         }
@@ -2389,6 +2468,23 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
         path_matrix.update_inital_pheromone(pheromone_initial_deposit);
     }
 
+    auto measure_path_length = [&path_matrix](const std::vector<MonotonicRegionLink> &path) {
+        assert(! path.empty());
+        return std::accumulate(path.begin(), path.end() - 1,
+            path.back().region->length(path.back().flipped),
+            [&path_matrix](const float l, const MonotonicRegionLink &r) { 
+                const MonotonicRegionLink &next = *(&r + 1);
+                return l + r.region->length(r.flipped) + path_matrix(*r.region, r.flipped, *next.region, next.flipped).length;
+            });
+    };
+
+    // The greedy path is the first best path, the ants search for a better one.
+    monotonic_flip_opt(path, path_matrix);
+    best_path_length = measure_path_length(path);
+    std::swap(best_path, path);
+    if (num_ants == 0 || best_path_length == 0)
+        return best_path;
+
     // Probability (unnormalized) of traversing a link between two monotonic regions.
 	auto path_probability = [
 #ifndef __APPLE__
@@ -2419,7 +2515,8 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
             // Pick randomly the first from the queue at random orientation.
             //FIXME picking the 1st monotonic region should likely be done based on accumulated pheromone level as well,
             // but the inefficiency caused by the random pick of the 1st monotonic region is likely insignificant.
-            int first_idx = std::uniform_int_distribution<>(0, int(queue.size()) - 1)(rng);
+            // Not using std::uniform_int_distribution, its implementation differs between the C++ standard libraries.
+            int first_idx = int(rng() % uint64_t(queue.size()));
             path.emplace_back(MonotonicRegionLink{ queue[first_idx], rng() > rng.max() / 2 });
             *(queue.begin() + first_idx) = std::move(queue.back());
             queue.pop_back();
@@ -2468,6 +2565,7 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
                         next_candidates.emplace_back(NextCandidate{ next, &path2, &path2_flipped, path_probability(path2), true  });
                     }
                 }
+                num_link_evaluations += next_candidates.size();
 				float dice = float(rng()) / float(rng.max());
                 std::vector<NextCandidate>::iterator take_path;
 				if (dice < probability_take_best) {
@@ -2534,15 +2632,10 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
 
 			// Perform 3-opt local optimization of the path.
 			monotonic_3_opt(path, segs);
+			monotonic_flip_opt(path, path_matrix);
 
 			// Measure path length.
-            assert(! path.empty());
-            float path_length = std::accumulate(path.begin(), path.end() - 1,
-                path.back().region->length(path.back().flipped),
-                [&path_matrix](const float l, const MonotonicRegionLink &r) { 
-                    const MonotonicRegionLink &next = *(&r + 1);
-                    return l + r.region->length(r.flipped) + path_matrix(*r.region, r.flipped, *next.region, next.flipped).length;
-                });
+            float path_length = measure_path_length(path);
 			// Save the shortest path.
 			print_ant("\tThis length: %1%, shortest length: %2%", path_length, best_path_length);
 			if (path_length < best_path_length) {
@@ -2558,6 +2651,9 @@ static std::vector<MonotonicRegionLink> chain_monotonic_regions(
                     goto end;
                 improved = true;
 			}
+			if (num_link_evaluations > budget.max_link_evaluations)
+				// Out of budget, keep the best path found so far.
+				goto end;
 		}
 
 		// Reinforce the path pheromones with the best path.
@@ -2841,7 +2937,7 @@ bool FillRectilinear::fill_surface_by_lines(const Surface *surface, const FillPa
 		connect_monotonic_regions(regions, poly_with_offset, segs);
         if (! regions.empty()) {
 		    std::mt19937_64 rng;
-		    std::vector<MonotonicRegionLink> path = chain_monotonic_regions(regions, poly_with_offset, segs, rng);
+		    std::vector<MonotonicRegionLink> path = chain_monotonic_regions(regions, poly_with_offset, segs, params.monotonic_quality, rng);
 		    polylines_from_paths(path, poly_with_offset, segs, polylines_out);
         }
 	} else
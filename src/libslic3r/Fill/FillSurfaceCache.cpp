@@ -0,0 +1,153 @@
+#include "../ExPolygon.hpp"
+#include "../Surface.hpp"
+
+#include "FillBase.hpp"
+#include "FillSurfaceCache.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+namespace Slic3r {
+
+// Maximum number of points of the infill and of the surfaces cached (about 128MB). The infill is mostly shared
+// by the same layer of identical objects, which are filled at about the same time.
+static constexpr size_t max_points_cached = 16 * 1024 * 1024;
+
+// All inputs of Fill::fill_surface().
+struct FillSurfaceKey
+{
+    InfillPattern   pattern;
+    // Fill
+    size_t          layer_id;
+    coordf_t        z;
+    coordf_t        spacing;
+    coordf_t        overlap;
+    float           angle;
+    coord_t         link_max_length;
+    coord_t         loop_clipping;
+    BoundingBox     bounding_box;
+    // FillParams
+    FillParams      params;
+    // Surface
+    SurfaceType     surface_type;
+    double          bridge_angle;
+    unsigned short  thickness_layers;
+    ExPolygon       expolygon;
+
+    bool operator==(const FillSurfaceKey &rhs) const {
+        return pattern == rhs.pattern && layer_id == rhs.layer_id && z == rhs.z && spacing == rhs.spacing && overlap == rhs.overlap &&
+               angle == rhs.angle && link_max_length == rhs.link_max_length && loop_clipping == rhs.loop_clipping &&
+               bounding_box.min == rhs.bounding_box.min && bounding_box.max == rhs.bounding_box.max &&
+               params.density == rhs.params.density && params.anchor_length == rhs.params.anchor_length &&
+               params.anchor_length_max == rhs.params.anchor_length_max && params.dont_adjust == rhs.params.dont_adjust &&
+               params.monotonic == rhs.params.monotonic && params.monotonic_quality == rhs.params.monotonic_quality && params.complete == rhs.params.complete &&
+               surface_type == rhs.surface_type && bridge_angle == rhs.bridge_angle && thickness_layers == rhs.thickness_layers &&
+               expolygon == rhs.expolygon;
+    }
+
+    size_t hash() const {
+        size_t seed = 0;
+        boost::hash_combine(seed, int(pattern));
+        boost::hash_combine(seed, layer_id);
+        boost::hash_combine(seed, spacing);
+        boost::hash_combine(seed, angle);
+        boost::hash_combine(seed, params.density);
+        auto hash_polygon = [&seed](const Polygon &polygon) {
+            boost::hash_combine(seed, polygon.size());
+            for (const Point &pt : polygon.points) {
+                boost::hash_combine(seed, pt.x());
+                boost::hash_combine(seed, pt.y());
+            }
+        };
+        hash_polygon(expolygon.contour);
+        for (const Polygon &hole : expolygon.holes)
+            hash_polygon(hole);
+        return seed;
+    }
+};
+
+struct FillSurfaceValue
+{
+    Polylines   polylines;
+    // Spacing as adjusted by the filler.
+    coordf_t    spacing;
+    size_t      num_points;
+};
+
+using FillSurfaceEntry = std::pair<FillSurfaceKey, std::shared_ptr<const FillSurfaceValue>>;
+
+static std::mutex                                                           s_mutex;
+// Most recently used first.
+static std::list<FillSurfaceEntry>                                          s_entries;
+// Hash of FillSurfaceKey to the cached entries.
+static std::unordered_multimap<size_t, std::list<FillSurfaceEntry>::iterator> s_index;
+static size_t                                                               s_num_points = 0;
+
+static inline size_t num_points(const ExPolygon &expolygon)
+{
+    size_t out = expolygon.contour.size();
+    for (const Polygon &hole : expolygon.holes)
+        out += hole.size();
+    return out;
+}
+
+Polylines FillSurfaceCache::fill_surface(Fill &fill, InfillPattern pattern, const Surface &surface, const FillParams &params)
+{
+    if (pattern == ipAdaptiveCubic || pattern == ipSupportCubic)
+        // The infill depends on the octree built over the object.
+        return fill.fill_surface(&surface, params);
+
+    FillSurfaceKey key { pattern, fill.layer_id, fill.z, fill.spacing, fill.overlap, fill.angle, fill.link_max_length, fill.loop_clipping, fill.bounding_box,
+                         params, surface.surface_type, surface.bridge_angle, surface.thickness_layers, surface.expolygon };
+    const size_t   hash = key.hash();
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto range = s_index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++ it)
+            if (it->second->first == key) {
+                std::shared_ptr<const FillSurfaceValue> value = it->second->second;
+                s_entries.splice(s_entries.begin(), s_entries, it->second);
+                fill.spacing = value->spacing;
+                return value->polylines;
+            }
+    }
+
+    auto value = std::make_shared<FillSurfaceValue>();
+    value->polylines  = fill.fill_surface(&surface, params);
+    value->spacing    = fill.spacing;
+    value->num_points = num_points(key.expolygon);
+    for (const Polyline &polyline : value->polylines)
+        value->num_points += polyline.size();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_entries.emplace_front(std::move(key), value);
+    s_index.emplace(hash, s_entries.begin());
+    s_num_points += value->num_points;
+    while (s_num_points > max_points_cached && s_entries.size() > 1) {
+        auto last  = std::prev(s_entries.end());
+        auto range = s_index.equal_range(last->first.hash());
+        for (auto it = range.first; it != range.second; ++ it)
+            if (it->second == last) {
+                s_index.erase(it);
+                break;
+            }
+        s_num_points -= last->second->num_points;
+        s_entries.erase(last);
+    }
+    return value->polylines;
+}
+
+void FillSurfaceCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_index.clear();
+    s_entries.clear();
+    s_num_points = 0;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,36 @@
+#ifndef slic3r_FillSurfaceCache_hpp_
+#define slic3r_FillSurfaceCache_hpp_
+
+#include "../libslic3r.h"
+#include "../Polyline.hpp"
+#include "../PrintConfig.hpp"
+
+namespace Slic3r {
+
+class Fill;
+class Surface;
+struct FillParams;
+
+// Cache of the infill polylines generated for the fill surfaces, shared by all layers and objects.
+// Each object is sliced in its own coordinate system centered around the object, thus the fill surfaces of identical
+// objects (model objects of the same geometry and configuration are printed as separate PrintObjects) coincide
+// and their infill is generated just once.
+// The infill is anchored to the object bounding box or to the origin of the object coordinate system. Surfaces identical
+// up to a translation would produce the same infill only if the translation was a period of the pattern, otherwise the reused
+// infill would be shifted against the infill of the neighbor layers. Therefore the surfaces are only matched exactly.
+// Thread safe. Released by clear() once the infill of all objects is generated.
+class FillSurfaceCache
+{
+public:
+    // Fill the surface as fill.fill_surface(&surface, params) would, reusing the infill of an identical surface
+    // filled before with the same filler parameters. Updates fill.spacing as fill.fill_surface() would.
+    // Throws InfillFailedException as fill.fill_surface() would.
+    static Polylines fill_surface(Fill &fill, InfillPattern pattern, const Surface &surface, const FillParams &params);
+
+    // Release the cached infill.
+    static void      clear();
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_FillSurfaceCache_hpp_
@@ -12,7 +12,9 @@
 
 #include "3mf.hpp"
 
+#include <charconv>
 #include <limits>
+#include <optional>
 #include <stdexcept>
 
 #include <boost/algorithm/string/classification.hpp>
@@ -26,6 +28,8 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/foreach.hpp>
+
+#include <tbb/parallel_for.h>
 namespace pt = boost::property_tree;
 
 #include <expat.h>
@@ -159,16 +163,71 @@ std::string get_attribute_value_string(const char** attributes, unsigned int att
     return (text != nullptr) ? text : "";
 }
 
+// Parse a decimal number with at most 15 significant digits and a small decimal exponent, as written by our exporter ("%.9g").
+// Both the mantissa and the power of ten are exactly representable in double, thus a single multiplication or division
+// produces a correctly rounded result, the same as atof() does. Returns false if the number does not fit the fast path.
+static bool parse_double_fast(const char *p, double &out)
+{
+    static constexpr double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    bool negative = false;
+    if (*p == '-' || *p == '+')
+        negative = *p ++ == '-';
+    uint64_t mantissa   = 0;
+    int      exponent   = 0;
+    int      num_digits = 0;
+    for (; *p >= '0' && *p <= '9'; ++ p, ++ num_digits)
+        if ((mantissa = mantissa * 10 + uint64_t(*p - '0')) >= (uint64_t(1) << 53))
+            return false;
+    if (*p == '.')
+        for (++ p; *p >= '0' && *p <= '9'; ++ p, ++ num_digits, -- exponent)
+            if ((mantissa = mantissa * 10 + uint64_t(*p - '0')) >= (uint64_t(1) << 53))
+                return false;
+    if (num_digits == 0)
+        return false;
+    if (*p == 'e' || *p == 'E') {
+        ++ p;
+        bool negative_exp = false;
+        if (*p == '-' || *p == '+')
+            negative_exp = *p ++ == '-';
+        if (*p < '0' || *p > '9')
+            return false;
+        int exp = 0;
+        for (; *p >= '0' && *p <= '9'; ++ p)
+            if ((exp = exp * 10 + (*p - '0')) > 100)
+                return false;
+        exponent += negative_exp ? - exp : exp;
+    }
+    if (*p != 0 || exponent < -22 || exponent > 22)
+        return false;
+    double value = double(mantissa);
+    value = exponent < 0 ? value / pow10[- exponent] : value * pow10[exponent];
+    out = negative ? - value : value;
+    return true;
+}
+
+static float parse_attribute_float(const char* text)
+{
+    double value;
+    return (float)(parse_double_fast(text, value) ? value : ::atof(text));
+}
+
+static int parse_attribute_int(const char* text)
+{
+    int value;
+    auto [ptr, error_code] = std::from_chars(text, text + ::strlen(text), value);
+    return error_code == std::errc() ? value : ::atoi(text);
+}
+
 float get_attribute_value_float(const char** attributes, unsigned int attributes_size, const char* attribute_key)
 {
     const char* text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
-    return (text != nullptr) ? (float)::atof(text) : 0.0f;
+    return (text != nullptr) ? parse_attribute_float(text) : 0.0f;
 }
 
 int get_attribute_value_int(const char** attributes, unsigned int attributes_size, const char* attribute_key)
 {
     const char* text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
-    return (text != nullptr) ? ::atoi(text) : 0;
+    return (text != nullptr) ? parse_attribute_int(text) : 0;
 }
 
 bool get_attribute_value_bool(const char** attributes, unsigned int attributes_size, const char* attribute_key)
@@ -289,9 +348,11 @@ namespace Slic3r {
         {
             std::vector<float> vertices;
             std::vector<unsigned int> triangles;
-            std::vector<std::string> custom_supports;
-            std::vector<std::string> custom_seam;
-            std::vector<std::string> mmu_segmentation;
+            // Painted facets are stored for the painted triangles only, as pairs of <triangle index, serialized TriangleSelector>
+            // sorted by the triangle index.
+            std::vector<std::pair<unsigned int, std::string>> custom_supports;
+            std::vector<std::pair<unsigned int, std::string>> custom_seam;
+            std::vector<std::pair<unsigned int, std::string>> mmu_segmentation;
 
             bool empty() { return vertices.empty() || triangles.empty(); }
 
@@ -389,6 +450,24 @@ namespace Slic3r {
         typedef std::map<int, std::vector<sla::SupportPoint>> IdToSlaSupportPointsMap;
         typedef std::map<int, std::vector<sla::DrainHole>> IdToSlaDrainHolesMap;
 
+        // Volume collected by _add_volumes_to_generate(). The meshes of all the volumes of all the objects are built, repaired
+        // and their convex hulls calculated in parallel by _generate_volumes(), then the ModelVolumes are created serially,
+        // as ObjectIDs and the config timestamps are not assigned in a thread safe manner.
+        struct VolumeToGenerate
+        {
+            ModelObject                    *object;
+            const Geometry                 *geometry;
+            ObjectMetadata::VolumeMetadata  volume_data;
+            // Transformation of the only instance of an object of a 3MF not produced by PrusaSlicer, to be baked into the mesh.
+            std::optional<Transform3d>      bake_transformation;
+            TriangleMesh                    mesh;
+            TriangleMesh                    convex_hull;
+            bool                            malformed { false };
+
+            VolumeToGenerate(ModelObject *object, const Geometry *geometry, const ObjectMetadata::VolumeMetadata &volume_data)
+                : object(object), geometry(geometry), volume_data(volume_data) {}
+        };
+
         // Version of the 3mf file
         unsigned int m_version;
         bool m_check_version;
@@ -405,6 +484,7 @@ namespace Slic3r {
         IdToAliasesMap m_objects_aliases;
         InstancesList m_instances;
         IdToGeometryMap m_geometries;
+        std::vector<VolumeToGenerate> m_volumes_to_generate;
         CurrentConfig m_curr_config;
         IdToMetadataMap m_objects_metadata;
         IdToLayerHeightsProfileMap m_layer_heights_profiles;
@@ -510,7 +590,8 @@ namespace Slic3r {
         bool _handle_start_config_metadata(const char** attributes, unsigned int num_attributes);
         bool _handle_end_config_metadata();
 
-        bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions);
+        bool _add_volumes_to_generate(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes);
+        bool _generate_volumes(ConfigSubstitutionContext& config_substitutions);
 
         // callbacks to parse the .model file
         static void XMLCALL _handle_start_model_xml_element(void* userData, const char* name, const char** attributes);
@@ -550,6 +631,7 @@ namespace Slic3r {
         m_objects_aliases.clear();
         m_instances.clear();
         m_geometries.clear();
+        m_volumes_to_generate.clear();
         m_curr_config.object_id = -1;
         m_curr_config.volume_id = -1;
         m_objects_metadata.clear();
@@ -704,7 +786,7 @@ namespace Slic3r {
                         new_model_object->clear_instances();
                         new_model_object->add_instance(*model_object->instances.back());
                         model_object->delete_last_instance();
-                        if (!_generate_volumes(*new_model_object, *geometry, volumes, config_substitutions))
+                        if (!_add_volumes_to_generate(*new_model_object, *geometry, volumes))
                             return false;
                     }
                 }
@@ -775,10 +857,13 @@ namespace Slic3r {
                 volumes_ptr = &volumes;
             }
 
-            if (!_generate_volumes(*model_object, obj_geometry->second, *volumes_ptr, config_substitutions))
+            if (!_add_volumes_to_generate(*model_object, obj_geometry->second, *volumes_ptr))
                 return false;
         }
 
+        if (!_generate_volumes(config_substitutions))
+            return false;
+
 #if ENABLE_RELOAD_FROM_DISK_FOR_3MF
         int object_idx = 0;
         for (ModelObject* o : model.objects) {
@@ -1528,9 +1613,16 @@ namespace Slic3r {
     {
         // appends the vertex coordinates
         // missing values are set equal to ZERO
-        m_curr_object.geometry.vertices.push_back(m_unit_factor * get_attribute_value_float(attributes, num_attributes, X_ATTR));
-        m_curr_object.geometry.vertices.push_back(m_unit_factor * get_attribute_value_float(attributes, num_attributes, Y_ATTR));
-        m_curr_object.geometry.vertices.push_back(m_unit_factor * get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+        // This is the hot path of the import, the attributes are parsed in a single pass.
+        float xyz[3] = { 0.f, 0.f, 0.f };
+        for (unsigned int a = 0; a + 1 < num_attributes; a += 2) {
+            const char *key = attributes[a];
+            if (key[0] != 0 && key[1] == 0 && key[0] >= 'x' && key[0] <= 'z')
+                xyz[key[0] - 'x'] = parse_attribute_float(attributes[a + 1]);
+        }
+        m_curr_object.geometry.vertices.push_back(m_unit_factor * xyz[0]);
+        m_curr_object.geometry.vertices.push_back(m_unit_factor * xyz[1]);
+        m_curr_object.geometry.vertices.push_back(m_unit_factor * xyz[2]);
         return true;
     }
 
@@ -1564,13 +1656,25 @@ namespace Slic3r {
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V1_ATTR));
-        m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V2_ATTR));
-        m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V3_ATTR));
-
-        m_curr_object.geometry.custom_supports.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-        m_curr_object.geometry.custom_seam.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
-        m_curr_object.geometry.mmu_segmentation.push_back(get_attribute_value_string(attributes, num_attributes, MMU_SEGMENTATION_ATTR));
+        // This is the hot path of the import, the attributes are parsed in a single pass.
+        Geometry     &geometry    = m_curr_object.geometry;
+        unsigned int  triangle_id = (unsigned int)geometry.triangles.size() / 3;
+        unsigned int  v[3]        = { 0, 0, 0 };
+        for (unsigned int a = 0; a + 1 < num_attributes; a += 2) {
+            const char *key   = attributes[a];
+            const char *value = attributes[a + 1];
+            if (key[0] == 'v' && key[1] >= '1' && key[1] <= '3' && key[2] == 0)
+                v[key[1] - '1'] = (unsigned int)parse_attribute_int(value);
+            else if (value[0] != 0) {
+                if (::strcmp(key, CUSTOM_SUPPORTS_ATTR) == 0)
+                    geometry.custom_supports.emplace_back(triangle_id, value);
+                else if (::strcmp(key, CUSTOM_SEAM_ATTR) == 0)
+                    geometry.custom_seam.emplace_back(triangle_id, value);
+                else if (::strcmp(key, MMU_SEGMENTATION_ATTR) == 0)
+                    geometry.mmu_segmentation.emplace_back(triangle_id, value);
+            }
+        }
+        geometry.triangles.insert(geometry.triangles.end(), v, v + 3);
         return true;
     }
 
@@ -1824,9 +1928,9 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    bool _3MF_Importer::_add_volumes_to_generate(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes)
     {
-        if (!object.volumes.empty()) {
+        if (!object.volumes.empty() || std::any_of(m_volumes_to_generate.begin(), m_volumes_to_generate.end(), [&object](const VolumeToGenerate &v) { return v.object == &object; })) {
             add_error("Found invalid volumes count");
             return false;
         }
@@ -1839,81 +1943,112 @@ namespace Slic3r {
                 return false;
             }
 
-            Transform3d volume_matrix_to_object = Transform3d::Identity();
-            bool        has_transform 		    = false;
-            // extract the volume transformation from the volume's metadata, if present
-            for (const Metadata& metadata : volume_data.metadata) {
-                if (metadata.key == MATRIX_KEY) {
-                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
-                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
-                    break;
-                }
-            }
-
-            // splits volume out of imported geometry
-			TriangleMesh triangle_mesh;
-            stl_file    &stl             = triangle_mesh.stl;
-			unsigned int triangles_count = volume_data.last_triangle_id - volume_data.first_triangle_id + 1;
-			stl.stats.type = inmemory;
-            stl.stats.number_of_facets = (uint32_t)triangles_count;
-            stl.stats.original_num_facets = (int)stl.stats.number_of_facets;
-            stl_allocate(&stl);
-
-            unsigned int src_start_id = volume_data.first_triangle_id * 3;
-
-            for (unsigned int i = 0; i < triangles_count; ++i) {
-                unsigned int ii = i * 3;
-                stl_facet& facet = stl.facet_start[i];
-                for (unsigned int v = 0; v < 3; ++v) {
-                    unsigned int tri_id = geometry.triangles[src_start_id + ii + v] * 3;
-                    if (tri_id + 2 >= geometry.vertices.size()) {
-                        add_error("Malformed triangle mesh");
-                        return false;
-                    }
-                    facet.vertex[v] = Vec3f(geometry.vertices[tri_id + 0], geometry.vertices[tri_id + 1], geometry.vertices[tri_id + 2]);
-                }
-            }
-
-			stl_get_size(&stl);
-			triangle_mesh.repair();
-
+            VolumeToGenerate &volume = m_volumes_to_generate.emplace_back(&object, &geometry, volume_data);
 #if ENABLE_RELOAD_FROM_DISK_FOR_3MF
             if (m_version == 0) {
                 // if the 3mf was not produced by PrusaSlicer and there is only one instance,
                 // bake the transformation into the geometry to allow the reload from disk command
                 // to work properly
                 if (object.instances.size() == 1) {
-                    triangle_mesh.transform(object.instances.front()->get_transformation().get_matrix());
+                    volume.bake_transformation = object.instances.front()->get_transformation().get_matrix();
                     object.instances.front()->set_transformation(Slic3r::Geometry::Transformation());
                 }
             }
 #endif // ENABLE_RELOAD_FROM_DISK_FOR_3MF
+        }
+
+        return true;
+    }
+
+    // Recreate custom supports, seam or mmu segmentation of a volume from the previously loaded attributes.
+    static void set_facets_from_strings(FacetsAnnotation &facets, const std::vector<std::pair<unsigned int, std::string>> &strings, unsigned int first_triangle_id, unsigned int last_triangle_id)
+    {
+        auto begin = std::lower_bound(strings.begin(), strings.end(), first_triangle_id,
+            [](const std::pair<unsigned int, std::string> &l, unsigned int r) { return l.first < r; });
+        auto end   = std::upper_bound(begin, strings.end(), last_triangle_id,
+            [](unsigned int l, const std::pair<unsigned int, std::string> &r) { return l < r.first; });
+        if (begin == end)
+            return;
+        facets.reserve(int(end - begin));
+        for (auto it = begin; it != end; ++ it)
+            facets.set_triangle_from_string(int(it->first - first_triangle_id), it->second);
+        facets.shrink_to_fit();
+    }
+
+    bool _3MF_Importer::_generate_volumes(ConfigSubstitutionContext& config_substitutions)
+    {
+        // Split the volumes out of the imported geometries, repair them and calculate their convex hulls, all volumes of all objects in parallel.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_volumes_to_generate.size(), 1),
+            [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t volume_idx = range.begin(); volume_idx < range.end(); ++ volume_idx) {
+                VolumeToGenerate &volume   = m_volumes_to_generate[volume_idx];
+                const Geometry   &geometry = *volume.geometry;
+                stl_file         &stl      = volume.mesh.stl;
+                unsigned int triangles_count = volume.volume_data.last_triangle_id - volume.volume_data.first_triangle_id + 1;
+                stl.stats.type = inmemory;
+                stl.stats.number_of_facets = (uint32_t)triangles_count;
+                stl.stats.original_num_facets = (int)stl.stats.number_of_facets;
+                stl_allocate(&stl);
+
+                unsigned int src_start_id = volume.volume_data.first_triangle_id * 3;
+
+                for (unsigned int i = 0; i < triangles_count; ++i) {
+                    unsigned int ii = i * 3;
+                    stl_facet& facet = stl.facet_start[i];
+                    for (unsigned int v = 0; v < 3; ++v) {
+                        unsigned int tri_id = geometry.triangles[src_start_id + ii + v] * 3;
+                        if (tri_id + 2 >= geometry.vertices.size()) {
+                            volume.malformed = true;
+                            break;
+                        }
+                        facet.vertex[v] = Vec3f(geometry.vertices[tri_id + 0], geometry.vertices[tri_id + 1], geometry.vertices[tri_id + 2]);
+                    }
+                    if (volume.malformed)
+                        break;
+                }
+                if (volume.malformed) {
+                    volume.mesh = TriangleMesh();
+                    continue;
+                }
+
+                stl_get_size(&stl);
+                volume.mesh.repair();
+                if (volume.bake_transformation)
+                    volume.mesh.transform(*volume.bake_transformation);
+                volume.convex_hull = volume.mesh.convex_hull_3d();
+            }
+        });
+
+        // Create the ModelVolumes in the order of the objects and their volumes.
+        for (VolumeToGenerate &volume_to_generate : m_volumes_to_generate) {
+            if (volume_to_generate.malformed) {
+                add_error("Malformed triangle mesh");
+                return false;
+            }
+
+            const ObjectMetadata::VolumeMetadata &volume_data = volume_to_generate.volume_data;
+            const Geometry                       &geometry    = *volume_to_generate.geometry;
+
+            Transform3d volume_matrix_to_object = Transform3d::Identity();
+            bool        has_transform 		    = false;
+            // extract the volume transformation from the volume's metadata, if present
+            for (const Metadata& metadata : volume_data.metadata) {
+                if (metadata.key == MATRIX_KEY) {
+                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
+                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
+                    break;
+                }
+            }
 
-			ModelVolume* volume = object.add_volume(std::move(triangle_mesh));
+            ModelVolume* volume = volume_to_generate.object->add_volume(std::move(volume_to_generate.mesh), std::move(volume_to_generate.convex_hull));
             // stores the volume matrix taken from the metadata, if present
             if (has_transform)
                 volume->source.transform = Slic3r::Geometry::Transformation(volume_matrix_to_object);
-            volume->calculate_convex_hull();
 
             // recreate custom supports, seam and mmu segmentation from previously loaded attribute
-            volume->supported_facets.reserve(triangles_count);
-            volume->seam_facets.reserve(triangles_count);
-            volume->mmu_segmentation_facets.reserve(triangles_count);
-            for (unsigned i=0; i<triangles_count; ++i) {
-                size_t index = src_start_id/3 + i;
-                assert(index < geometry.custom_supports.size());
-                assert(index < geometry.custom_seam.size());
-                assert(index < geometry.mmu_segmentation.size());
-                if (! geometry.custom_supports[index].empty())
-                    volume->supported_facets.set_triangle_from_string(i, geometry.custom_supports[index]);
-                if (! geometry.custom_seam[index].empty())
-                    volume->seam_facets.set_triangle_from_string(i, geometry.custom_seam[index]);
-                if (! geometry.mmu_segmentation[index].empty())
-                    volume->mmu_segmentation_facets.set_triangle_from_string(i, geometry.mmu_segmentation[index]);
-            }
-            volume->supported_facets.shrink_to_fit();
-            volume->seam_facets.shrink_to_fit();
-            volume->mmu_segmentation_facets.shrink_to_fit();
+            set_facets_from_strings(volume->supported_facets,        geometry.custom_supports,  volume_data.first_triangle_id, volume_data.last_triangle_id);
+            set_facets_from_strings(volume->seam_facets,             geometry.custom_seam,      volume_data.first_triangle_id, volume_data.last_triangle_id);
+            set_facets_from_strings(volume->mmu_segmentation_facets, geometry.mmu_segmentation, volume_data.first_triangle_id, volume_data.last_triangle_id);
 
             // apply the remaining volume's metadata
             for (const Metadata& metadata : volume_data.metadata) {
@@ -2028,6 +2163,21 @@ namespace Slic3r {
         typedef std::vector<BuildItem> BuildItemsList;
         typedef std::map<int, ObjectData> IdToObjectDataMap;
 
+        // Piece of the model XML file: Text, optionally followed by a range of vertices or triangles of a ModelVolume.
+        // The pieces are formatted and compressed in parallel by _add_model_file_to_archive().
+        struct ModelFilePiece
+        {
+            enum class Type { Text, Vertices, Triangles };
+            std::string        text;
+            Type               type            { Type::Text };
+            const ModelVolume *volume          { nullptr };
+            // Offset of the vertex indices of the volume in the 3MF object, used by Type::Triangles.
+            unsigned int       first_vertex_id { 0 };
+            size_t             begin           { 0 };
+            size_t             end             { 0 };
+        };
+        typedef std::vector<ModelFilePiece> ModelFilePieces;
+
         bool m_fullpath_sources{ true };
         bool m_zip64 { true };
 
@@ -2040,8 +2190,10 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_object_to_model_pieces(ModelFilePieces& pieces, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_model_pieces(ModelFilePieces& pieces, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
+        static void _append_model_file_text(ModelFilePieces& pieces, const std::string& text);
+        static void _format_model_file_piece(const ModelFilePiece& piece, std::string& output_buffer);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_config_ranges_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2246,22 +2398,146 @@ namespace Slic3r {
         stream << std::setprecision(std::numeric_limits<float>::max_digits10);
     }
 
-    bool _3MF_Exporter::_add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data)
+#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
+    template <typename Num>
+    struct coordinate_policy_fixed : boost::spirit::karma::real_policies<Num>
     {
-        mz_zip_writer_staged_context context;
-        if (!mz_zip_writer_add_staged_open(&archive, &context, MODEL_FILE.c_str(), 
-            m_zip64 ? 
-                // Maximum expected and allowed 3MF file size is 16GiB.
-                // This switches the ZIP file to a 64bit mode, which adds a tiny bit of overhead to file records.
-                (uint64_t(1) << 30) * 16 : 
-                // Maximum expected 3MF file size is 4GB-1. This is a workaround for interoperability with Windows 10 3D model fixing API, see
-                // GH issue #6193.
-                (uint64_t(1) << 32) - 1,
-            nullptr, nullptr, 0, MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0)) {
-            add_error("Unable to add model file to archive");
-            return false;
+        static int floatfield(Num n) { return fmtflags::fixed; }
+        // Number of decimal digits to maintain float accuracy when storing into a text file and parsing back.
+        static unsigned precision(Num /* n */) { return std::numeric_limits<Num>::max_digits10 + 1; }
+        // No trailing zeros, thus for fmtflags::fixed usually much less than max_digits10 decimal numbers will be produced.
+        static bool trailing_zeros(Num /* n */) { return false; }
+    };
+    template <typename Num>
+    struct coordinate_policy_scientific : coordinate_policy_fixed<Num>
+    {
+        static int floatfield(Num n) { return fmtflags::scientific; }
+    };
+    // Define a new generator type based on the new coordinate policy.
+    using coordinate_type_fixed      = boost::spirit::karma::real_generator<float, coordinate_policy_fixed<float>>;
+    using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
+#endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
+
+    // Round-trippable float, shortest possible.
+    static char* format_coordinate(float f, char *buf)
+    {
+        assert(is_decimal_separator_point());
+#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
+        // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
+        // https://github.com/boostorg/spirit/pull/586
+        // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
+        // The code is left here for the ocasion boost guys improve.
+        coordinate_type_fixed      const coordinate_fixed      = coordinate_type_fixed();
+        coordinate_type_scientific const coordinate_scientific = coordinate_type_scientific();
+        // Format "f" in a fixed format.
+        char *ptr = buf;
+        boost::spirit::karma::generate(ptr, coordinate_fixed, f);
+        // Format "f" in a scientific format.
+        char *ptr2 = ptr;
+        boost::spirit::karma::generate(ptr2, coordinate_scientific, f);
+        // Return end of the shorter string.
+        auto len2 = ptr2 - ptr;
+        if (ptr - buf > len2) {
+            // Move the shorter scientific form to the front.
+            memcpy(buf, ptr, len2);
+            ptr = buf + len2;
+        }
+        // Return pointer to the end.
+        return ptr;
+#else
+        return buf + sprintf(buf, "%.9g", f);
+#endif
+    }
+
+    // Format a piece of the model XML file, called in parallel for all the pieces.
+    void _3MF_Exporter::_format_model_file_piece(const ModelFilePiece& piece, std::string& output_buffer)
+    {
+        using Type = ModelFilePiece::Type;
+        output_buffer = piece.text;
+        if (piece.type == Type::Text)
+            return;
+
+        const ModelVolume          &volume = *piece.volume;
+        const indexed_triangle_set &its    = volume.mesh().its;
+        char buf[256];
+        if (piece.type == Type::Vertices) {
+            const Transform3d& matrix = volume.get_matrix();
+            for (size_t i = piece.begin; i < piece.end; ++i) {
+                Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
+                char *ptr = buf;
+                boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
+                ptr = format_coordinate(v.x(), ptr);
+                boost::spirit::karma::generate(ptr, "\" y=\"");
+                ptr = format_coordinate(v.y(), ptr);
+                boost::spirit::karma::generate(ptr, "\" z=\"");
+                ptr = format_coordinate(v.z(), ptr);
+                boost::spirit::karma::generate(ptr, "\"/>\n");
+                *ptr = '\0';
+                output_buffer += buf;
+            }
+            return;
+        }
+
+        for (int i = int(piece.begin); i < int(piece.end); ++ i) {
+            {
+                const Vec3i &idx = its.indices[i];
+                char *ptr = buf;
+                boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << TRIANGLE_TAG <<
+                    " v1=\"" << boost::spirit::int_ <<
+                    "\" v2=\"" << boost::spirit::int_ <<
+                    "\" v3=\"" << boost::spirit::int_ << "\"",
+                    idx[0] + piece.first_vertex_id,
+                    idx[1] + piece.first_vertex_id,
+                    idx[2] + piece.first_vertex_id);
+                *ptr = '\0';
+                output_buffer += buf;
+            }
+
+            std::string custom_supports_data_string = volume.supported_facets.get_triangle_as_string(i);
+            if (! custom_supports_data_string.empty()) {
+                output_buffer += " ";
+                output_buffer += CUSTOM_SUPPORTS_ATTR;
+                output_buffer += "=\"";
+                output_buffer += custom_supports_data_string;
+                output_buffer += "\"";
+            }
+
+            std::string custom_seam_data_string = volume.seam_facets.get_triangle_as_string(i);
+            if (! custom_seam_data_string.empty()) {
+                output_buffer += " ";
+                output_buffer += CUSTOM_SEAM_ATTR;
+                output_buffer += "=\"";
+                output_buffer += custom_seam_data_string;
+                output_buffer += "\"";
+            }
+
+            std::string mmu_painting_data_string = volume.mmu_segmentation_facets.get_triangle_as_string(i);
+            if (! mmu_painting_data_string.empty()) {
+                output_buffer += " ";
+                output_buffer += MMU_SEGMENTATION_ATTR;
+                output_buffer += "=\"";
+                output_buffer += mmu_painting_data_string;
+                output_buffer += "\"";
+            }
+
+            output_buffer += "/>\n";
         }
+    }
+
+    // Number of vertices or triangles formatted and compressed by a single task.
+    static constexpr const size_t model_file_piece_size = 1 << 16;
 
+    void _3MF_Exporter::_append_model_file_text(ModelFilePieces& pieces, const std::string& text)
+    {
+        if (pieces.empty() || pieces.back().type != ModelFilePiece::Type::Text)
+            pieces.emplace_back();
+        pieces.back().text += text;
+    }
+
+    bool _3MF_Exporter::_add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data)
+    {
+        // The model file is split into pieces, which are formatted and compressed in parallel.
+        ModelFilePieces pieces;
         {
             std::stringstream stream;
             reset_stream(stream);
@@ -2282,11 +2558,7 @@ namespace Slic3r {
             stream << " <" << METADATA_TAG << " name=\"ModificationDate\">" << date << "</" << METADATA_TAG << ">\n";
             stream << " <" << METADATA_TAG << " name=\"Application\">" << SLIC3R_APP_KEY << "-" << SLIC3R_VERSION << "</" << METADATA_TAG << ">\n";
             stream << " <" << RESOURCES_TAG << ">\n";
-            std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
-                add_error("Unable to add model file to archive");
-                return false;
-            }
+            _append_model_file_text(pieces, stream.str());
         }
 
         // Instance transformations, indexed by the 3MF object ID (which is a linear serialization of all instances of all ModelObjects).
@@ -2306,9 +2578,8 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_pieces(pieces, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
                 add_error("Unable to add object to archive");
-                mz_zip_writer_add_staged_finish(&context);
                 return false;
             }
         }
@@ -2321,25 +2592,35 @@ namespace Slic3r {
             // Store the transformations of all the ModelInstances of all ModelObjects, indexed in a linear fashion.
             if (!_add_build_to_model_stream(stream, build_items)) {
                 add_error("Unable to add build to archive");
-                mz_zip_writer_add_staged_finish(&context);
                 return false;
             }
 
             stream << "</" << MODEL_TAG << ">\n";
-           
-            std::string buf = stream.str();
-
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                ! mz_zip_writer_add_staged_finish(&context)) {
-                add_error("Unable to add model file to archive");
-                return false;
-            }
+            _append_model_file_text(pieces, stream.str());
+        }
+
+        if (! add_file_to_zip_parallel(&archive, MODEL_FILE.c_str(),
+                m_zip64 ? 
+                    // Maximum expected and allowed 3MF file size is 16GiB.
+                    // This switches the ZIP file to a 64bit mode, which adds a tiny bit of overhead to file records.
+                    (uint64_t(1) << 30) * 16 : 
+                    // Maximum expected 3MF file size is 4GB-1. This is a workaround for interoperability with Windows 10 3D model fixing API, see
+                    // GH issue #6193.
+                    (uint64_t(1) << 32) - 1,
+                MZ_DEFAULT_COMPRESSION, pieces.size(), 
+                [&pieces](size_t idx, std::string &out) {
+                    // The locales are set per thread, the coordinates are formatted with sprintf().
+                    CNumericLocalesSetter locales_setter;
+                    _format_model_file_piece(pieces[idx], out);
+                })) {
+            add_error("Unable to add model file to archive");
+            return false;
         }
 
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_pieces(ModelFilePieces& pieces, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -2353,10 +2634,9 @@ namespace Slic3r {
             stream << "  <" << OBJECT_TAG << " id=\"" << instance_id << "\" type=\"model\">\n";
 
             if (id == 0) {
-                std::string buf = stream.str();
+                _append_model_file_text(pieces, stream.str());
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                if (! _add_mesh_to_model_pieces(pieces, object, volumes_offsets)) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
@@ -2378,81 +2658,14 @@ namespace Slic3r {
         }
 
         object_id += id;
-        std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
+        _append_model_file_text(pieces, stream.str());
+        return true;
     }
 
-#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
-    template <typename Num>
-    struct coordinate_policy_fixed : boost::spirit::karma::real_policies<Num>
+    bool _3MF_Exporter::_add_mesh_to_model_pieces(ModelFilePieces& pieces, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
     {
-        static int floatfield(Num n) { return fmtflags::fixed; }
-        // Number of decimal digits to maintain float accuracy when storing into a text file and parsing back.
-        static unsigned precision(Num /* n */) { return std::numeric_limits<Num>::max_digits10 + 1; }
-        // No trailing zeros, thus for fmtflags::fixed usually much less than max_digits10 decimal numbers will be produced.
-        static bool trailing_zeros(Num /* n */) { return false; }
-    };
-    template <typename Num>
-    struct coordinate_policy_scientific : coordinate_policy_fixed<Num>
-    {
-        static int floatfield(Num n) { return fmtflags::scientific; }
-    };
-    // Define a new generator type based on the new coordinate policy.
-    using coordinate_type_fixed      = boost::spirit::karma::real_generator<float, coordinate_policy_fixed<float>>;
-    using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
-#endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
-
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
-    {
-        std::string output_buffer;
-        output_buffer += "   <";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n";
+        _append_model_file_text(pieces, std::string("   <") + MESH_TAG + ">\n    <" + VERTICES_TAG + ">\n");
 
-        auto flush = [this, &output_buffer, &context](bool force = false) {
-            if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
-                    add_error("Error during writing or compression");
-                    return false;
-                }
-                output_buffer.clear();
-            }
-            return true;
-        };
-
-        auto format_coordinate = [](float f, char *buf) -> char* {
-            assert(is_decimal_separator_point());
-#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
-            // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
-            // https://github.com/boostorg/spirit/pull/586
-            // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
-            // The code is left here for the ocasion boost guys improve.
-            coordinate_type_fixed      const coordinate_fixed      = coordinate_type_fixed();
-            coordinate_type_scientific const coordinate_scientific = coordinate_type_scientific();
-            // Format "f" in a fixed format.
-            char *ptr = buf;
-            boost::spirit::karma::generate(ptr, coordinate_fixed, f);
-            // Format "f" in a scientific format.
-            char *ptr2 = ptr;
-            boost::spirit::karma::generate(ptr2, coordinate_scientific, f);
-            // Return end of the shorter string.
-            auto len2 = ptr2 - ptr;
-            if (ptr - buf > len2) {
-                // Move the shorter scientific form to the front.
-                memcpy(buf, ptr, len2);
-                ptr = buf + len2;
-            }
-            // Return pointer to the end.
-            return ptr;
-#else
-            // Round-trippable float, shortest possible.
-            return buf + sprintf(buf, "%.9g", f);
-#endif
-        };
-
-        char buf[256];
         unsigned int vertices_count = 0;
         for (ModelVolume* volume : object.volumes) {
             if (volume == nullptr)
@@ -2473,30 +2686,16 @@ namespace Slic3r {
 
             vertices_count += (int)its.vertices.size();
 
-            const Transform3d& matrix = volume->get_matrix();
-
-            for (size_t i = 0; i < its.vertices.size(); ++i) {
-                Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
-                char *ptr = buf;
-                boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
-                ptr = format_coordinate(v.x(), ptr);
-                boost::spirit::karma::generate(ptr, "\" y=\"");
-                ptr = format_coordinate(v.y(), ptr);
-                boost::spirit::karma::generate(ptr, "\" z=\"");
-                ptr = format_coordinate(v.z(), ptr);
-                boost::spirit::karma::generate(ptr, "\"/>\n");
-                *ptr = '\0';
-                output_buffer += buf;
-                if (! flush())
-                    return false;
+            for (size_t begin = 0; begin < its.vertices.size(); begin += model_file_piece_size) {
+                ModelFilePiece &piece = pieces.emplace_back();
+                piece.type   = ModelFilePiece::Type::Vertices;
+                piece.volume = volume;
+                piece.begin  = begin;
+                piece.end    = std::min(begin + model_file_piece_size, its.vertices.size());
             }
         }
 
-        output_buffer += "    </";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n";
+        _append_model_file_text(pieces, std::string("    </") + VERTICES_TAG + ">\n    <" + TRIANGLES_TAG + ">\n");
 
         unsigned int triangles_count = 0;
         for (ModelVolume* volume : object.volumes) {
@@ -2513,63 +2712,18 @@ namespace Slic3r {
             triangles_count += (int)its.indices.size();
             volume_it->second.last_triangle_id = triangles_count - 1;
 
-            for (int i = 0; i < int(its.indices.size()); ++ i) {
-                {
-                    const Vec3i &idx = its.indices[i];
-                    char *ptr = buf;
-                    boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << TRIANGLE_TAG <<
-                        " v1=\"" << boost::spirit::int_ <<
-                        "\" v2=\"" << boost::spirit::int_ <<
-                        "\" v3=\"" << boost::spirit::int_ << "\"",
-                        idx[0] + volume_it->second.first_vertex_id,
-                        idx[1] + volume_it->second.first_vertex_id,
-                        idx[2] + volume_it->second.first_vertex_id);
-                    *ptr = '\0';
-                    output_buffer += buf;
-                }
-
-                std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
-                if (! custom_supports_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SUPPORTS_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_supports_data_string;
-                    output_buffer += "\"";
-                }
-
-                std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
-                if (! custom_seam_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SEAM_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_seam_data_string;
-                    output_buffer += "\"";
-                }
-
-                std::string mmu_painting_data_string = volume->mmu_segmentation_facets.get_triangle_as_string(i);
-                if (! mmu_painting_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += MMU_SEGMENTATION_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += mmu_painting_data_string;
-                    output_buffer += "\"";
-                }
-
-                output_buffer += "/>\n";
-
-                if (! flush())
-                    return false;
+            for (size_t begin = 0; begin < its.indices.size(); begin += model_file_piece_size) {
+                ModelFilePiece &piece = pieces.emplace_back();
+                piece.type            = ModelFilePiece::Type::Triangles;
+                piece.volume          = volume;
+                piece.first_vertex_id = volume_it->second.first_vertex_id;
+                piece.begin           = begin;
+                piece.end             = std::min(begin + model_file_piece_size, its.indices.size());
             }
         }
 
-        output_buffer += "    </";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n   </";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n";
-
-        // Force flush.
-        return flush(true);
+        _append_model_file_text(pieces, std::string("    </") + TRIANGLES_TAG + ">\n   </" + MESH_TAG + ">\n");
+        return true;
     }
 
     bool _3MF_Exporter::_add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items)
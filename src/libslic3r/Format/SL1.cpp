@@ -473,14 +473,18 @@ void SL1Archive::export_print(Zipper& zipper,
         zipper.add_entry("prusaslicer.ini");
         zipper << to_ini(slicerconf);
         
+        // The layers are compressed in parallel.
+        std::vector<Zipper::Entry> layers;
+        layers.reserve(m_layers.size());
         size_t i = 0;
         for (const sla::EncodedRaster &rst : m_layers) {
 
             std::string imgname = project + string_printf("%.5d", i++) + "." +
                                   rst.extension();
             
-            zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+            layers.push_back({ std::move(imgname), rst.data(), rst.size() });
         }
+        zipper.add_entries(layers);
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
         // Rethrow the exception
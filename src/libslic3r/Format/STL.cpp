@@ -1,11 +1,27 @@
 #include "../libslic3r.h"
+#include "../LocalesUtils.hpp"
 #include "../Model.hpp"
 #include "../TriangleMesh.hpp"
 
 #include "STL.hpp"
 
+#include <algorithm>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <string>
 
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/predef/other/endian.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
 #ifdef _WIN32
 #define DIR_SEPARATOR '\\'
 #else
@@ -14,6 +30,272 @@
 
 namespace Slic3r {
 
+// Bounding box of the loaded facets, reduced over the parallel chunks of a binary STL.
+struct StlBBox
+{
+    stl_vertex min { stl_vertex::Constant(std::numeric_limits<float>::max()) };
+    stl_vertex max { stl_vertex::Constant(- std::numeric_limits<float>::max()) };
+    void merge(const stl_facet &facet) {
+        for (size_t i = 0; i < 3; ++ i) {
+            this->min = this->min.cwiseMin(facet.vertex[i]);
+            this->max = this->max.cwiseMax(facet.vertex[i]);
+        }
+    }
+    void merge(const StlBBox &rhs) {
+        this->min = this->min.cwiseMin(rhs.min);
+        this->max = this->max.cwiseMax(rhs.max);
+    }
+};
+
+static void stl_update_stats(stl_file &stl, const StlBBox &bbox)
+{
+    if (! stl.facet_start.empty()) {
+        const stl_facet &facet = stl.facet_start.front();
+        stl_vertex       diff  = (facet.vertex[1] - facet.vertex[0]).cwiseAbs();
+        stl.stats.shortest_edge = std::max(diff(0), std::max(diff(1), diff(2)));
+        stl.stats.min = bbox.min;
+        stl.stats.max = bbox.max;
+    }
+    stl.stats.number_of_facets    = uint32_t(stl.facet_start.size());
+    stl.stats.original_num_facets = int(stl.stats.number_of_facets);
+    stl.stats.size                = stl.stats.max - stl.stats.min;
+    stl.stats.bounding_diameter   = stl.stats.size.norm();
+    stl.neighbors_start.assign(stl.facet_start.size(), stl_neighbors());
+}
+
+// Facets of a binary STL have a fixed size, thus they are copied from the memory mapped file in parallel chunks.
+static bool read_stl_binary(const char *path, const char *data, size_t size, stl_file &stl)
+{
+    if ((size - HEADER_SIZE) % SIZEOF_STL_FACET != 0 || size < STL_MIN_FILE_SIZE) {
+        BOOST_LOG_TRIVIAL(error) << "read_stl_file: The file " << path << " has the wrong size.";
+        return false;
+    }
+    size_t num_facets = (size - HEADER_SIZE) / SIZEOF_STL_FACET;
+    memcpy(stl.stats.header, data, LABEL_SIZE);
+    stl.stats.header[LABEL_SIZE] = '\0';
+    uint32_t header_num_facets;
+    memcpy(&header_num_facets, data + LABEL_SIZE, sizeof(uint32_t));
+    if (num_facets != header_num_facets)
+        BOOST_LOG_TRIVIAL(info) << "read_stl_file: Warning: File size doesn't match number of facets in the header: " << path;
+
+    stl.facet_start.assign(num_facets, stl_facet());
+    const char *facets = data + HEADER_SIZE;
+    StlBBox bbox = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, num_facets), StlBBox(),
+        [&stl, facets](const tbb::blocked_range<size_t> &range, StlBBox bbox) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                stl_facet &facet = stl.facet_start[i];
+                memcpy(reinterpret_cast<char*>(&facet), facets + i * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
+                bbox.merge(facet);
+            }
+            return bbox;
+        },
+        [](StlBBox bbox1, const StlBBox &bbox2) { bbox1.merge(bbox2); return bbox1; });
+    stl_update_stats(stl, bbox);
+    return true;
+}
+
+// Parse a decimal number with at most 7 significant digits and a small decimal exponent, as written by admesh
+// and most STL exporters. Both the mantissa and the power of ten are exactly representable in float,
+// thus a single float multiplication or division produces a correctly rounded result, the same as strtof() does.
+// Returns false if the number does not fit the fast path.
+static bool parse_float_fast(const char *begin, const char *end, float &out)
+{
+    static constexpr float pow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    const char *p        = begin;
+    bool        negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+        negative = *p ++ == '-';
+    uint32_t mantissa   = 0;
+    int      exponent   = 0;
+    int      num_digits = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++ p, ++ num_digits)
+        if ((mantissa = mantissa * 10 + uint32_t(*p - '0')) >= (1 << 24))
+            return false;
+    if (p != end && *p == '.')
+        for (++ p; p != end && *p >= '0' && *p <= '9'; ++ p, ++ num_digits, -- exponent)
+            if ((mantissa = mantissa * 10 + uint32_t(*p - '0')) >= (1 << 24))
+                return false;
+    if (num_digits == 0)
+        return false;
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++ p;
+        bool negative_exp = false;
+        if (p != end && (*p == '-' || *p == '+'))
+            negative_exp = *p ++ == '-';
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+        int exp = 0;
+        for (; p != end && *p >= '0' && *p <= '9'; ++ p)
+            if ((exp = exp * 10 + (*p - '0')) > 100)
+                return false;
+        exponent += negative_exp ? - exp : exp;
+    }
+    if (p != end || exponent < -10 || exponent > 10)
+        return false;
+    float value = float(mantissa);
+    value = exponent < 0 ? value / pow10[- exponent] : value * pow10[exponent];
+    out = negative ? - value : value;
+    return true;
+}
+
+#if __has_include(<charconv>)
+    template <typename T, typename = void>
+    struct is_from_chars_convertible : std::false_type {};
+    template <typename T>
+    struct is_from_chars_convertible<T, std::void_t<decltype(std::from_chars(std::declval<const char*>(), std::declval<const char*>(), std::declval<T&>()))>> : std::true_type {};
+#endif
+
+// Tokenizer of an ASCII STL in memory, replacing the fscanf() based parser of admesh.
+// Numbers not handled by parse_float_fast() or std::from_chars() are parsed with strtof(),
+// thus the caller has to set the "C" numeric locale.
+class StlAsciiParser
+{
+public:
+    StlAsciiParser(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+
+    bool eof() { this->skip_whitespaces(); return m_ptr == m_end; }
+    // Match a keyword at the current position after skipping white spaces, consume it if matched.
+    bool keyword(const char *kw) {
+        this->skip_whitespaces();
+        size_t len = strlen(kw);
+        if (size_t(m_end - m_ptr) < len || strncmp(m_ptr, kw, len) != 0)
+            return false;
+        m_ptr += len;
+        return true;
+    }
+    // Match a keyword at the current position followed by a white space or end of file, skip the rest of the line.
+    bool line_keyword(const char *kw) {
+        if (! this->keyword(kw) || (m_ptr != m_end && ! is_whitespace(*m_ptr)))
+            return false;
+        this->skip_line();
+        return true;
+    }
+    bool number(float &out) {
+        this->skip_whitespaces();
+        const char *begin = m_ptr;
+        while (m_ptr != m_end && ! is_whitespace(*m_ptr))
+            ++ m_ptr;
+        if (parse_float_fast(begin, m_ptr, out))
+            return true;
+#if __has_include(<charconv>)
+        // OSX compiler that we use only implements std::from_chars just for ints.
+        if constexpr (is_from_chars_convertible<float>::value) {
+            auto [end_ptr, error_code] = std::from_chars(begin, m_ptr, out);
+            if (error_code == std::errc() && end_ptr == m_ptr)
+                return true;
+        }
+#endif
+        // A valid number does not need that many characters, and parsing just a prefix of the token would be wrong.
+        char   buf[64];
+        size_t len = size_t(m_ptr - begin);
+        if (len == 0 || len >= sizeof(buf))
+            return false;
+        memcpy(buf, begin, len);
+        buf[len] = 0;
+        char *endptr = nullptr;
+        out = strtof(buf, &endptr);
+        return endptr == buf + len;
+    }
+    // Skip up to the end of line, accepting LF, CRLF and CR line endings.
+    void skip_line() {
+        while (m_ptr != m_end && *m_ptr != '\n' && *m_ptr != '\r')
+            ++ m_ptr;
+    }
+
+private:
+    static bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+    void skip_whitespaces() { while (m_ptr != m_end && is_whitespace(*m_ptr)) ++ m_ptr; }
+
+    const char *m_ptr;
+    const char *m_end;
+};
+
+static bool read_stl_ascii(const char *path, const char *data, size_t size, stl_file &stl)
+{
+    CNumericLocalesSetter locales_setter;
+    // The header is the first line of the file.
+    size_t i = 0;
+    for (; i < LABEL_SIZE && i < size && data[i] != '\n'; ++ i)
+        stl.stats.header[i] = data[i];
+    stl.stats.header[i] = '\0';
+
+    // Reserve for a typical ASCII STL, each facet takes 7 lines of approximately 40 characters.
+    stl.facet_start.reserve(size / 256);
+    StlBBox         bbox;
+    StlAsciiParser  parser(data, data + size);
+    while (! parser.eof()) {
+        // Skip solid / endsolid lines, broken STL file generators may put several of them into a single file.
+        if (parser.keyword("endsolid") || parser.keyword("solid")) {
+            parser.skip_line();
+            continue;
+        }
+        stl_facet facet;
+        memset(facet.extra, 0, sizeof(facet.extra));
+        bool ok = parser.keyword("facet") && parser.keyword("normal");
+        if (ok) {
+            // Consume all three tokens of the normal, even if some of them could not be parsed.
+            bool normal_ok = true;
+            for (int j = 0; j < 3; ++ j)
+                normal_ok &= parser.number(facet.normal(j));
+            if (! normal_ok)
+                // Normal was mangled. Maybe denormals or "not a number" were stored?
+                // Just reset the normal and silently ignore it.
+                facet.normal = stl_normal::Zero();
+        }
+        ok = ok && parser.keyword("outer") && parser.keyword("loop");
+        for (size_t j = 0; ok && j < 3; ++ j)
+            ok = parser.keyword("vertex") && parser.number(facet.vertex[j](0)) && parser.number(facet.vertex[j](1)) && parser.number(facet.vertex[j](2));
+        // Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
+        ok = ok && parser.line_keyword("endloop") && parser.line_keyword("endfacet");
+        if (! ok) {
+            BOOST_LOG_TRIVIAL(error) << "read_stl_file: Something is syntactically very wrong with this ASCII STL: " << path;
+            return false;
+        }
+        stl.facet_start.emplace_back(facet);
+        bbox.merge(facet);
+    }
+    stl_update_stats(stl, bbox);
+    return true;
+}
+
+bool read_stl_file(const char *path, stl_file &stl)
+{
+#if BOOST_ENDIAN_BIG_BYTE
+    // The binary STL is little endian, let admesh swap the bytes.
+    return stl_open(&stl, path);
+#else
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        // Mapping an empty file fails.
+        if (boost::filesystem::file_size(boost::filesystem::path(path)) > 0)
+            mapped.open(boost::filesystem::path(path));
+    } catch (const std::exception &) {
+        // Not a regular file, or the file could not be mapped. Fall back to reading the file with admesh.
+    }
+    if (! mapped.is_open())
+        return stl_open(&stl, path);
+
+    stl.clear();
+    const char *data = mapped.data();
+    size_t      size = mapped.size();
+    // Check for binary or ASCII file the same way admesh does.
+    if (size < HEADER_SIZE + 128) {
+        BOOST_LOG_TRIVIAL(error) << "read_stl_file: The input is an empty file: " << path;
+        return false;
+    }
+    stl.stats.type = ascii;
+    for (size_t i = HEADER_SIZE; i < HEADER_SIZE + 128; ++ i)
+        if ((unsigned char)data[i] > 127) {
+            stl.stats.type = binary;
+            break;
+        }
+    bool result = stl.stats.type == binary ? read_stl_binary(path, data, size, stl) : read_stl_ascii(path, data, size, stl);
+    if (! result)
+        stl.clear();
+    return result;
+#endif
+}
+
 bool load_stl(const char *path, Model *model, const char *object_name_in)
 {
     TriangleMesh mesh;
@@ -1,11 +1,18 @@
 #ifndef slic3r_Format_STL_hpp_
 #define slic3r_Format_STL_hpp_
 
+struct stl_file;
+
 namespace Slic3r {
 
 class TriangleMesh;
+class Model;
 class ModelObject;
 
+// Read a binary or ASCII STL file into stl. The file is memory mapped, facets of a binary STL are copied in parallel.
+// Falls back to admesh stl_open() if the file could not be mapped.
+extern bool read_stl_file(const char *path, stl_file &stl);
+
 // Load an STL file into a provided model.
 extern bool load_stl(const char *path, Model *model, const char *object_name = nullptr);
 
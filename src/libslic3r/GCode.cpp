@@ -34,6 +34,7 @@
 #include "SVG.hpp"
 
 #include <tbb/parallel_for.h>
+#include <tbb/pipeline.h>
 
 #include <Shiny/Shiny.h>
 
@@ -791,7 +792,8 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessor::Result* re
     }
 
     BOOST_LOG_TRIVIAL(debug) << "Start processing gcode, " << log_memory_info();
-    m_processor.process_file(path_tmp, true, [print]() { print->throw_if_canceled(); });
+    // The G-code has been processed while being exported, finish the time estimates and insert them into the file.
+    m_processor.finalize(path_tmp, true);
 //    DoExport::update_print_estimated_times_stats(m_processor, print->m_print_statistics);
     DoExport::update_print_estimated_stats(m_processor, m_writer.extruders(), print->m_print_statistics);
 #if ENABLE_GCODE_WINDOW
@@ -1066,6 +1068,8 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
 
     // modifies m_silent_time_estimator_enabled
     DoExport::init_gcode_processor(print.config(), m_processor, m_silent_time_estimator_enabled);
+    // The G-code processor is fed with the exported G-code by GCode::_write().
+    m_processor.initialize();
 
     // resets analyzer's tracking data
     m_last_height  = 0.f;
@@ -1358,14 +1362,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
             m_cooling_buffer->reset();
             m_cooling_buffer->set_current_extruder(initial_extruder_id);
             // Pair the object layers with the support layers by z, extrude them.
-            std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
-            for (const LayerToPrint &ltp : layers_to_print) {
-                std::vector<LayerToPrint> lrs;
-                lrs.emplace_back(std::move(ltp));
-                this->process_layer(file, print, lrs, tool_ordering.tools_for_layer(ltp.print_z()), &ltp == &layers_to_print.back(), 
-                    nullptr, *print_object_instance_sequential_active - object.instances().data());
-                print.throw_if_canceled();
-            }
+            this->process_layers(print, tool_ordering, collect_layers_to_print(object), *print_object_instance_sequential_active - object.instances().data(), file);
 #ifdef HAS_PRESSURE_EQUALIZER
             if (m_pressure_equalizer)
                 _write(file, m_pressure_equalizer->process("", true));
@@ -1423,13 +1420,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
             print.throw_if_canceled();
         }
         // Extrude the layers.
-        for (auto &layer : layers_to_print) {
-            const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
-            if (m_wipe_tower && layer_tools.has_wipe_tower)
-                m_wipe_tower->next_layer();
-            this->process_layer(file, print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
-            print.throw_if_canceled();
-        }
+        this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, file);
 #ifdef HAS_PRESSURE_EQUALIZER
         if (m_pressure_equalizer)
             _write(file, m_pressure_equalizer->process("", true));
@@ -1596,17 +1587,17 @@ static bool custom_gcode_sets_temperature(const std::string &gcode, const int mc
 }
 
 // Print the machine envelope G-code for the Marlin firmware based on the "machine_max_xxx" parameters.
-// Do not process this piece of G-code by the time estimator, it already knows the values through another sources.
+// The lines are passed to the G-code processor by _write_format() as if the G-code was read back from the file.
 void GCode::print_machine_envelope(FILE *file, Print &print)
 {
     if ((print.config().gcode_flavor.value == gcfMarlinLegacy || print.config().gcode_flavor.value == gcfMarlinFirmware)
      && print.config().machine_limits_usage.value == MachineLimitsUsage::EmitToGCode) {
-        fprintf(file, "M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
+        _write_format(file, "M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
             int(print.config().machine_max_acceleration_x.values.front() + 0.5),
             int(print.config().machine_max_acceleration_y.values.front() + 0.5),
             int(print.config().machine_max_acceleration_z.values.front() + 0.5),
             int(print.config().machine_max_acceleration_e.values.front() + 0.5));
-        fprintf(file, "M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
+        _write_format(file, "M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
             int(print.config().machine_max_feedrate_x.values.front() + 0.5),
             int(print.config().machine_max_feedrate_y.values.front() + 0.5),
             int(print.config().machine_max_feedrate_z.values.front() + 0.5),
@@ -1619,18 +1610,18 @@ void GCode::print_machine_envelope(FILE *file, Print &print)
         int travel_acc = print.config().gcode_flavor == gcfMarlinLegacy
                        ? int(print.config().machine_max_acceleration_extruding.values.front() + 0.5)
                        : int(print.config().machine_max_acceleration_travel.values.front() + 0.5);
-        fprintf(file, "M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
+        _write_format(file, "M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5),
             int(print.config().machine_max_acceleration_retracting.values.front() + 0.5),
             travel_acc);
 
         assert(is_decimal_separator_point());
-        fprintf(file, "M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
+        _write_format(file, "M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
             print.config().machine_max_jerk_x.values.front(),
             print.config().machine_max_jerk_y.values.front(),
             print.config().machine_max_jerk_z.values.front(),
             print.config().machine_max_jerk_e.values.front());
-        fprintf(file, "M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
+        _write_format(file, "M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
             int(print.config().machine_min_extruding_rate.values.front() + 0.5),
             int(print.config().machine_min_travel_rate.values.front() + 0.5));
     }
@@ -1924,14 +1915,128 @@ namespace Skirt {
 
 } // namespace Skirt
 
+// Run the G-code of layers produced by the generator filter through the post-processors and write it into the file.
+// The post-processors are stateful, thus each of them runs as a serial in order stage of the pipeline.
+// The G-code generator updates m_config per object and region and the state of m_writer while the CoolingBuffer
+// processes the preceding layers, therefore the CoolingBuffer works with its own copy of the configuration and extruders.
+// The only state of the G-code generator accessed by the CoolingBuffer is the fan speed of m_writer, which is not touched
+// by the G-code generator while the pipeline runs.
+template<typename Generator>
+void GCode::run_layer_pipeline(const Generator &generator, FILE *file)
+{
+    m_cooling_buffer->apply_gcodegen_config();
+    const auto spiral_vase = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(tbb::filter::serial_in_order,
+        [this](GCode::LayerResult in) -> GCode::LayerResult {
+            if (in.is_nop_layer_result())
+                return in;
+            CNumericLocalesSetter locales_setter;
+            // Apply spiral vase post-processing if this layer contains suitable geometry
+            // (we must feed all the G-code into the post-processor, including the first
+            // bottom non-spiral layers otherwise it will mess with positions)
+            // we apply spiral vase at this stage because it requires a full layer.
+            // Just a reminder: A spiral vase mode is allowed for a single object per layer, single material print only.
+            m_spiral_vase->enable(in.spiral_vase_enable);
+            in.gcode = m_spiral_vase->process_layer(std::move(in.gcode));
+            return in;
+        });
+    const auto cooling = tbb::make_filter<GCode::LayerResult, std::string>(tbb::filter::serial_in_order,
+        [this](GCode::LayerResult in) -> std::string {
+            if (in.is_nop_layer_result())
+                return std::string();
+            CNumericLocalesSetter locales_setter;
+            // Apply cooling logic; this may alter speeds.
+            return m_cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+        });
+    const auto output = tbb::make_filter<std::string, void>(tbb::filter::serial_in_order,
+        [this, file](std::string s) {
+            // Both the pressure equalizer and the G-code processor fed by _write() parse numbers.
+            CNumericLocalesSetter locales_setter;
+#ifdef HAS_PRESSURE_EQUALIZER
+            // Apply pressure equalization if enabled;
+            if (m_pressure_equalizer && ! s.empty())
+                s = m_pressure_equalizer->process(s.c_str(), false);
+#endif /* HAS_PRESSURE_EQUALIZER */
+            _write(file, s);
+        });
+
+    // The number of layers in flight limits the memory consumed by the G-code waiting for post-processing.
+    const size_t max_layers_in_flight = 12;
+    if (m_spiral_vase)
+        tbb::parallel_pipeline(max_layers_in_flight, generator & spiral_vase & cooling & output);
+    else
+        tbb::parallel_pipeline(max_layers_in_flight, generator & cooling & output);
+}
+
+// Process all layers of all objects (non-sequential mode) with a parallel pipeline:
+// Generate G-code, run through the SpiralVase, CoolingBuffer and PressureEqualizer post-processors
+// and write to the output file.
+// The G-code generator itself is stateful (GCodeWriter position, extruder state, wipe tower, seam placement),
+// therefore the layers are generated in order, but the post-processing and writing of a layer runs
+// on other threads concurrently with the generation of the following layers.
+// The output is identical to the output of processing the layers one by one.
+void GCode::process_layers(
+    const Print                                                         &print,
+    const ToolOrdering                                                  &tool_ordering,
+    const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
+    const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+    FILE                                                                *file)
+{
+    // The pipeline is variable: The vase mode filter is optional.
+    size_t layer_to_print_idx = 0;
+    const auto generator = tbb::make_filter<void, GCode::LayerResult>(tbb::filter::serial_in_order,
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control &fc) -> GCode::LayerResult {
+            if (layer_to_print_idx == layers_to_print.size()) {
+                fc.stop();
+                return {};
+            } else {
+                const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[layer_to_print_idx ++];
+                const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
+                if (m_wipe_tower && layer_tools.has_wipe_tower)
+                    m_wipe_tower->next_layer();
+                // The locales are set per thread.
+                CNumericLocalesSetter locales_setter;
+                GCode::LayerResult result = this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                print.throw_if_canceled();
+                return result;
+            }
+        });
+    this->run_layer_pipeline(generator, file);
+}
+
+// Process all layers of a single object instance (sequential mode) with a parallel pipeline.
+void GCode::process_layers(
+    const Print                             &print,
+    const ToolOrdering                      &tool_ordering,
+    std::vector<LayerToPrint>                layers_to_print,
+    const size_t                             single_object_idx,
+    FILE                                    *file)
+{
+    size_t layer_to_print_idx = 0;
+    const auto generator = tbb::make_filter<void, GCode::LayerResult>(tbb::filter::serial_in_order,
+        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx](tbb::flow_control &fc) -> GCode::LayerResult {
+            if (layer_to_print_idx == layers_to_print.size()) {
+                fc.stop();
+                return {};
+            } else {
+                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
+                CNumericLocalesSetter locales_setter;
+                std::vector<LayerToPrint> lrs;
+                lrs.emplace_back(std::move(layer));
+                GCode::LayerResult result = this->process_layer(print, lrs, tool_ordering.tools_for_layer(lrs.front().print_z()), 
+                    layer_to_print_idx == layers_to_print.size(), nullptr, single_object_idx);
+                print.throw_if_canceled();
+                return result;
+            }
+        });
+    this->run_layer_pipeline(generator, file);
+}
+
 // In sequential mode, process_layer is called once per each object and its copy,
 // therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
 // For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
 // and performing the extruder specific extrusions together.
-void GCode::process_layer(
-    // Write into the output file.
-    FILE                            		*file,
+GCode::LayerResult GCode::process_layer(
     const Print                    			&print,
     // Set of object & print layers of the same PrintObject and with the same print_z.
     const std::vector<LayerToPrint> 		&layers,
@@ -1949,7 +2054,7 @@ void GCode::process_layer(
 
     if (layer_tools.extruders.empty())
         // Nothing to extrude.
-        return;
+        return LayerResult::make_nop_layer_result();
 
     // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
     const Layer         *object_layer  = nullptr;
@@ -1968,6 +2073,9 @@ void GCode::process_layer(
     // Initialize config with the 1st object to be printed at this layer.
     m_config.apply(layer.object()->config(), true);
 
+    LayerResult   result { {}, layer.id(), false, last_layer };
+    std::string  &gcode = result.gcode;
+
     // Check whether it is possible to apply the spiral vase logic for this layer.
     // Just a reminder: A spiral vase mode is allowed for a single object, single material print only.
     m_enable_loop_clipping = true;
@@ -1982,12 +2090,11 @@ void GCode::process_layer(
                     break;
                 }
         }
-        m_spiral_vase->enable(enable);
+        result.spiral_vase_enable = enable;
         // If we're going to apply spiralvase to this layer, disable loop clipping.
         m_enable_loop_clipping = !enable;
     }
 
-    std::string gcode;
     assert(is_decimal_separator_point()); // for the sprintfs
 
     // add tag for processor
@@ -2324,31 +2431,14 @@ void GCode::process_layer(
         }
     }
 
-    // Apply spiral vase post-processing if this layer contains suitable geometry
-    // (we must feed all the G-code into the post-processor, including the first
-    // bottom non-spiral layers otherwise it will mess with positions)
-    // we apply spiral vase at this stage because it requires a full layer.
-    // Just a reminder: A spiral vase mode is allowed for a single object per layer, single material print only.
-    if (m_spiral_vase)
-        gcode = m_spiral_vase->process_layer(std::move(gcode));
-
-    // Apply cooling logic; this may alter speeds.
-    if (m_cooling_buffer)
-        gcode = m_cooling_buffer->process_layer(std::move(gcode), layer.id(),
-            // Flush the cooling buffer at each object layer or possibly at the last layer, even if it contains just supports (This should not happen).
-            object_layer || last_layer);
+    // The G-code is passed through the SpiralVase, CoolingBuffer and PressureEqualizer post-processors by GCode::process_layers().
+    // Flush the cooling buffer at each object layer or possibly at the last layer, even if it contains just supports (This should not happen).
+    result.cooling_buffer_flush = object_layer || last_layer;
 
-#ifdef HAS_PRESSURE_EQUALIZER
-    // Apply pressure equalization if enabled;
-    // printf("G-code before filter:\n%s\n", gcode.c_str());
-    if (m_pressure_equalizer)
-        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
-    // printf("G-code after filter:\n%s\n", out.c_str());
-#endif /* HAS_PRESSURE_EQUALIZER */
-
-    _write(file, gcode);
     BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
     log_memory_info();
+
+    return result;
 }
 
 void GCode::apply_print_config(const PrintConfig &print_config)
@@ -2686,8 +2776,12 @@ void GCode::_write(FILE* file, const char *what)
 {
     if (what != nullptr) {
         const char* gcode = what;
+        size_t      len   = ::strlen(gcode);
         // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), file);
+        fwrite(gcode, 1, len, file);
+        // and updates the G-code processor (time estimates, tool paths) while the data is at hand,
+        // so that the exported file does not need to be read back.
+        m_processor.process_buffer(std::string_view(gcode, len));
     }
 }
 
@@ -187,9 +187,40 @@ private:
 
     static std::vector<LayerToPrint>        		                   collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
-    void            process_layer(
-        // Write into the output file.
-        FILE                            *file,
+
+    // G-code of a single layer as produced by process_layer(), before being passed through
+    // the SpiralVase, CoolingBuffer and PressureEqualizer post-processors.
+    struct LayerResult {
+        std::string gcode;
+        size_t      layer_id { size_t(-1) };
+        // Is spiral vase post processing enabled for this layer?
+        bool        spiral_vase_enable { false };
+        // Should the cooling buffer content be flushed at the end of this layer?
+        bool        cooling_buffer_flush { false };
+
+        // Nothing was extruded at this layer, the post-processors shall skip it.
+        static LayerResult make_nop_layer_result() { return { "", size_t(-1), false, false }; }
+        bool        is_nop_layer_result() const { return layer_id == size_t(-1); }
+    };
+    // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
+    // Generate G-code, run it through the post-processors and write it into the output file.
+    void            process_layers(
+        const Print                                                         &print,
+        const ToolOrdering                                                  &tool_ordering,
+        const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
+        const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+        FILE                                                                *file);
+    // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
+    // Generate G-code, run it through the post-processors and write it into the output file.
+    void            process_layers(
+        const Print                             &print,
+        const ToolOrdering                      &tool_ordering,
+        std::vector<LayerToPrint>                layers_to_print,
+        const size_t                             single_object_idx,
+        FILE                                    *file);
+    template<typename Generator>
+    void            run_layer_pipeline(const Generator &generator, FILE *file);
+    LayerResult     process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
@@ -2,8 +2,10 @@
 #define slic3r_CoolingBuffer_hpp_
 
 #include "../libslic3r.h"
+#include "../PrintConfig.hpp"
 #include <map>
 #include <string>
+#include <vector>
 
 namespace Slic3r {
 
@@ -24,6 +26,9 @@ class CoolingBuffer {
 public:
     CoolingBuffer(GCode &gcodegen);
     void        reset();
+    // Copy the configuration and the extruders of the G-code generator. To be called before the layers are processed:
+    // The layers are processed concurrently with the G-code generator, which updates its configuration per object and region.
+    void        apply_gcodegen_config();
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
     std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
     GCode* 	    gcodegen() { return &m_gcodegen; }
@@ -37,6 +42,10 @@ private:
     std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
 
     GCode&              m_gcodegen;
+    // Copy of the G-code generator configuration and extruders, see apply_gcodegen_config().
+    FullPrintConfig             m_config;
+    std::vector<unsigned int>   m_extruder_ids;
+    std::string                 m_toolchange_prefix;
     // G-code snippet cached for the support layers preceding an object layer.
     std::string         m_gcode;
     // Internal data.
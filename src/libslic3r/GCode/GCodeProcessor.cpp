@@ -13,6 +13,7 @@
 #include <boost/nowide/cstdio.hpp>
 #if ENABLE_GCODE_WINDOW
 #include <boost/filesystem/path.hpp>
+#include <boost/functional/hash.hpp>
 #endif // ENABLE_GCODE_WINDOW
 
 #include <float.h>
@@ -362,7 +363,7 @@ void GCodeProcessor::TimeProcessor::reset()
 }
 
 #if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
-void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, std::vector<MoveVertex>& moves)
+void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, MoveVertices& moves)
 #else
 void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
 #endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
@@ -711,12 +712,13 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
     // updates moves' gcode ids which have been modified by the insertion of the M73 lines
     unsigned int curr_offset_id = 0;
     unsigned int total_offset = 0;
-    for (MoveVertex& move : moves) {
-        while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= move.gcode_id) {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        unsigned int gcode_id = moves.gcode_id(i);
+        while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= gcode_id) {
             total_offset += offsets[curr_offset_id].second;
             ++curr_offset_id;
         }
-        move.gcode_id += total_offset;
+        moves.set_gcode_id(i, gcode_id + total_offset);
     }
 #endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
 
@@ -793,7 +795,7 @@ void GCodeProcessor::UsedFilaments::process_caches(GCodeProcessor* processor)
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
 void GCodeProcessor::Result::reset() {
-    moves = std::vector<GCodeProcessor::MoveVertex>();
+    moves.clear();
     bed_shape = Pointfs();
     settings_ids.reset();
     extruders_count = 0;
@@ -804,7 +806,7 @@ void GCodeProcessor::Result::reset() {
 }
 #else
 void GCodeProcessor::Result::reset() {
-    moves = std::vector<GCodeProcessor::MoveVertex>();
+    moves.clear();
     bed_shape = Pointfs();
     settings_ids.reset();
     extruders_count = 0;
@@ -814,6 +816,113 @@ void GCodeProcessor::Result::reset() {
 }
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
+GCodeProcessor::MoveVertex GCodeProcessor::MoveVertices::operator[](size_t id) const
+{
+    const Attributes& attributes = m_attributes[m_attributes_ids[id]];
+    MoveVertex move;
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    move.gcode_id = m_gcode_ids[id];
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    move.type = attributes.type;
+    move.extrusion_role = attributes.extrusion_role;
+    move.extruder_id = attributes.extruder_id;
+    move.cp_color_id = attributes.cp_color_id;
+    move.position = m_positions[id];
+    move.delta_extruder = m_delta_extruders[id];
+    move.feedrate = attributes.feedrate;
+    move.width = m_widths[id];
+    move.height = attributes.height;
+    move.mm3_per_mm = m_mm3_per_mms[id];
+    move.fan_speed = attributes.fan_speed;
+    move.temperature = attributes.temperature;
+    // the time of a move is its index, see GCodeProcessor::store_move_vertex()
+    move.time = static_cast<float>(id);
+    return move;
+}
+
+void GCodeProcessor::MoveVertices::push_back(const MoveVertex& move)
+{
+    const Attributes attributes = { move.type, move.extrusion_role, move.extruder_id, move.cp_color_id,
+        move.feedrate, move.height, move.fan_speed, move.temperature };
+    uint32_t attributes_id;
+    if (! m_attributes_ids.empty() && m_attributes[m_attributes_ids.back()] == attributes)
+        // most of the moves share the attributes with the previous one
+        attributes_id = m_attributes_ids.back();
+    else {
+        auto [it, inserted] = m_attributes_map.insert({ attributes, static_cast<uint32_t>(m_attributes.size()) });
+        if (inserted)
+            m_attributes.emplace_back(attributes);
+        attributes_id = it->second;
+    }
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    m_gcode_ids.emplace_back(move.gcode_id);
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    m_positions.emplace_back(move.position);
+    m_delta_extruders.emplace_back(move.delta_extruder);
+    m_widths.emplace_back(move.width);
+    m_mm3_per_mms.emplace_back(move.mm3_per_mm);
+    m_attributes_ids.emplace_back(attributes_id);
+}
+
+void GCodeProcessor::MoveVertices::clear()
+{
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    m_gcode_ids = std::vector<unsigned int>();
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    m_positions = std::vector<Vec3f>();
+    m_delta_extruders = std::vector<float>();
+    m_widths = std::vector<float>();
+    m_mm3_per_mms = std::vector<float>();
+    m_attributes_ids = std::vector<uint32_t>();
+    m_attributes = std::vector<Attributes>();
+    m_attributes_map = std::unordered_map<Attributes, uint32_t, AttributesHash>();
+}
+
+void GCodeProcessor::MoveVertices::shrink_to_fit()
+{
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    m_gcode_ids.shrink_to_fit();
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+    m_positions.shrink_to_fit();
+    m_delta_extruders.shrink_to_fit();
+    m_widths.shrink_to_fit();
+    m_mm3_per_mms.shrink_to_fit();
+    m_attributes_ids.shrink_to_fit();
+    m_attributes.shrink_to_fit();
+    m_attributes_map = std::unordered_map<Attributes, uint32_t, AttributesHash>();
+}
+
+size_t GCodeProcessor::MoveVertices::memsize() const
+{
+    return
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+        m_gcode_ids.capacity() * sizeof(unsigned int) +
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+        m_positions.capacity() * sizeof(Vec3f) +
+        m_delta_extruders.capacity() * sizeof(float) +
+        m_widths.capacity() * sizeof(float) +
+        m_mm3_per_mms.capacity() * sizeof(float) +
+        m_attributes_ids.capacity() * sizeof(uint32_t) +
+        m_attributes.capacity() * sizeof(Attributes) +
+        m_attributes_map.size() * (sizeof(Attributes) + sizeof(uint32_t) + 2 * sizeof(void*));
+}
+
+bool GCodeProcessor::MoveVertices::Attributes::operator==(const Attributes& rhs) const
+{
+    return type == rhs.type && extrusion_role == rhs.extrusion_role && extruder_id == rhs.extruder_id && cp_color_id == rhs.cp_color_id &&
+        feedrate == rhs.feedrate && height == rhs.height && fan_speed == rhs.fan_speed && temperature == rhs.temperature;
+}
+
+size_t GCodeProcessor::MoveVertices::AttributesHash::operator()(const Attributes& attributes) const
+{
+    size_t seed = (size_t(attributes.type) << 24) ^ (size_t(attributes.extrusion_role) << 16) ^ (size_t(attributes.extruder_id) << 8) ^ size_t(attributes.cp_color_id);
+    boost::hash_combine(seed, attributes.feedrate);
+    boost::hash_combine(seed, attributes.height);
+    boost::hash_combine(seed, attributes.fan_speed);
+    boost::hash_combine(seed, attributes.temperature);
+    return seed;
+}
+
 const std::vector<std::pair<GCodeProcessor::EProducer, std::string>> GCodeProcessor::Producers = {
     { EProducer::PrusaSlicer, "PrusaSlicer" },
     { EProducer::Slic3rPE,    "Slic3r Prusa Edition" },
@@ -834,7 +943,7 @@ bool GCodeProcessor::contains_reserved_tag(const std::string& gcode, std::string
 
     GCodeReader parser;
     parser.parse_buffer(gcode, [&ret, &found_tag](GCodeReader& parser, const GCodeReader::GCodeLine& line) {
-        std::string comment = line.raw();
+        std::string comment(line.raw());
         if (comment.length() > 2 && comment.front() == ';') {
             comment = comment.substr(1);
             for (const std::string& s : Reserved_Tags) {
@@ -861,7 +970,7 @@ bool GCodeProcessor::contains_reserved_tags(const std::string& gcode, unsigned i
 
     GCodeReader parser;
     parser.parse_buffer(gcode, [&ret, &found_tag, max_count](GCodeReader& parser, const GCodeReader::GCodeLine& line) {
-        std::string comment = line.raw();
+        std::string comment(line.raw());
         if (comment.length() > 2 && comment.front() == ';') {
             comment = comment.substr(1);
             for (const std::string& s : Reserved_Tags) {
@@ -1308,13 +1417,8 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
     }
 
     // process gcode
-#if ENABLE_GCODE_WINDOW
-    m_result.filename = filename;
-#endif // ENABLE_GCODE_WINDOW
-    m_result.id = ++s_result_id;
-    // 1st move must be a dummy move
-    m_result.moves.emplace_back(MoveVertex());
-    m_parser.parse_file(filename, [this, cancel_callback, &last_cancel_callback_time](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    this->initialize();
+    auto process_line = [this, cancel_callback, &last_cancel_callback_time](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (cancel_callback != nullptr) {
             // call the cancel callback every 100 ms
             auto curr_time = std::chrono::high_resolution_clock::now();
@@ -1324,15 +1428,70 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
             }
         }
         process_gcode_line(line);
-        });
+    };
+    if (m_parallel_parsing)
+        // The lines are tokenized in parallel, process_gcode_line() is called sequentially in the file order.
+        m_parser.parse_file_parallel(filename, process_line);
+    else
+        m_parser.parse_file(filename, process_line);
+
+    this->finalize(filename, apply_postprocess);
 
-    // update width/height of wipe moves
-    for (MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+}
+
+void GCodeProcessor::initialize()
+{
+    m_result.id = ++s_result_id;
+    // 1st move must be a dummy move
+    m_result.moves.push_back(MoveVertex());
+    m_line_buffer.clear();
+}
+
+void GCodeProcessor::process_buffer(std::string_view buffer)
+{
+    auto process_line = [this](GCodeReader&, const GCodeReader::GCodeLine& line) { this->process_gcode_line(line); };
+    const char* ptr = buffer.data();
+    const char* end = ptr + buffer.size();
+    GCodeReader::GCodeLine gline;
+    if (! m_line_buffer.empty()) {
+        // Complete the line started by the previous call.
+        const char* eol = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+        if (eol == nullptr) {
+            m_line_buffer.append(ptr, end);
+            return;
         }
+        m_line_buffer.append(ptr, eol + 1);
+        m_parser.parse_line(m_line_buffer.c_str(), gline, process_line);
+        m_line_buffer.clear();
+        ptr = eol + 1;
     }
+    // Process the complete lines, keep the unterminated last line for the next call.
+    const char* last = end;
+    while (last != ptr && last[-1] != '\n')
+        -- last;
+    m_line_buffer.assign(last, end);
+    while (ptr < last) {
+        gline.reset();
+        ptr = m_parser.parse_line(ptr, gline, process_line);
+    }
+}
+
+void GCodeProcessor::finalize(const std::string& filename, bool apply_postprocess)
+{
+    if (! m_line_buffer.empty()) {
+        // The last line was not terminated by a newline.
+        GCodeReader::GCodeLine gline;
+        auto process_line = [this](GCodeReader&, const GCodeReader::GCodeLine& line) { this->process_gcode_line(line); };
+        m_parser.parse_line(m_line_buffer.c_str(), gline, process_line);
+        m_line_buffer.clear();
+    }
+
+#if ENABLE_GCODE_WINDOW
+    m_result.filename = filename;
+#endif // ENABLE_GCODE_WINDOW
 
     // process the time blocks
     for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
@@ -1347,6 +1506,8 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
 
     update_estimated_times_stats();
 
+    m_result.moves.shrink_to_fit();
+
     // post-process to add M73 lines into the gcode
     if (apply_postprocess)
 #if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
@@ -1361,10 +1522,6 @@ void GCodeProcessor::process_file(const std::string& filename, bool apply_postpr
     m_height_compare.output();
     m_width_compare.output();
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
-
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
 }
 
 float GCodeProcessor::get_time(PrintEstimatedStatistics::ETimeMode mode) const
@@ -1467,8 +1624,8 @@ void GCodeProcessor::apply_config_simplify3d(const std::string& filename)
             return false;
         };
 
-        const std::string& comment = line.raw();
-        if (comment.length() > 2 && comment.front() == ';') {
+        if (line.raw().length() > 2 && line.raw().front() == ';') {
+            const std::string comment(line.raw());
             if (bed_size.x == 0.0 && comment.find("strokeXoverride") != comment.npos)
                 extract_double(comment, "strokeXoverride", bed_size.x);
             else if (bed_size.y == 0.0 && comment.find("strokeYoverride") != comment.npos)
@@ -1568,7 +1725,7 @@ void GCodeProcessor::process_gcode_line(const GCodeReader::GCodeLine& line)
         }
     }
     else {
-        const std::string &comment = line.raw();
+        const std::string_view comment = line.raw();
         if (comment.length() > 2 && comment.front() == ';')
             // Process tags embedded into comments. Tag comments always start at the start of a line
             // with a comment and continue with a tag without any whitespace separator.
@@ -2582,7 +2739,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && !m_seams_detector.has_first_vertex())
-            m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id]);
+            m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id]);
         // check for seam ending vertex and store the resulting move
         else if ((type != EMoveType::Extrude || m_extrusion_role != erExternalPerimeter) && m_seams_detector.has_first_vertex()) {
             auto set_end_position = [this](const Vec3f& pos) {
@@ -2590,7 +2747,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
             };
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id];
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id];
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
             if ((new_pos - *first_vertex).squaredNorm() < 0.0625f) {
@@ -2764,7 +2921,7 @@ void GCodeProcessor::process_M108(const GCodeReader::GCodeLine& line)
     if (m_flavor != gcfSailfish)
         return;
 
-    std::string cmd = line.raw();
+    std::string cmd(line.raw());
     size_t pos = cmd.find("T");
     if (pos != std::string::npos)
         process_T(cmd.substr(pos));
@@ -2813,7 +2970,7 @@ void GCodeProcessor::process_M135(const GCodeReader::GCodeLine& line)
     if (m_flavor != gcfMakerWare)
         return;
 
-    std::string cmd = line.raw();
+    std::string cmd(line.raw());
     size_t pos = cmd.find("T");
     if (pos != std::string::npos)
         process_T(cmd.substr(pos));
@@ -3089,7 +3246,12 @@ void GCodeProcessor::store_move_vertex(EMoveType type)
         m_extruder_temps[m_extruder_id],
         static_cast<float>(m_result.moves.size())
     };
-    m_result.moves.emplace_back(vertex);
+    if (type == EMoveType::Wipe) {
+        // wipe moves are rendered with a fixed width/height
+        vertex.width = Wipe_Width;
+        vertex.height = Wipe_Height;
+    }
+    m_result.moves.push_back(vertex);
 
 #if ENABLE_EXTENDED_M73_LINES
     // stores stop time placeholders for later use
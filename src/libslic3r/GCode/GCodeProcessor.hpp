@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #if ENABLE_SEAMS_VISUALIZATION
 #include <optional>
 #endif // ENABLE_SEAMS_VISUALIZATION
@@ -210,10 +211,11 @@ namespace Slic3r {
             float time() const;
         };
 
-#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
         struct MoveVertex
         {
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
             unsigned int gcode_id{ 0 };
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
             EMoveType type{ EMoveType::Noop };
             ExtrusionRole extrusion_role{ erNone };
             unsigned char extruder_id{ 0 };
@@ -230,8 +232,92 @@ namespace Slic3r {
 
             float volumetric_rate() const { return feedrate * mm3_per_mm; }
         };
+
+        // Compact storage of the moves produced by the processor.
+        // The position, the extruded length, the gcode line id, the width and the mm3_per_mm are stored per move:
+        // mm3_per_mm is recalculated from the extruded length of every extrusion move and the width is recalculated
+        // with it for G-code not annotated by PrusaSlicer. The remaining attributes (type, role, extruder, color,
+        // feedrate, height, fan speed, temperature) stay the same over long sequences of moves, thus each unique
+        // combination of them is stored once and the moves reference it by index.
+        // The moves are decoded into MoveVertex on access, the storage is lossless.
+        class MoveVertices
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = const MoveVertex*;
+                using reference         = MoveVertex;
+
+                const_iterator(const MoveVertices* moves, size_t id) : m_moves(moves), m_id(id) {}
+                MoveVertex      operator*() const { return (*m_moves)[m_id]; }
+                const_iterator& operator++() { ++m_id; return *this; }
+                const_iterator  operator++(int) { const_iterator it = *this; ++m_id; return it; }
+                bool            operator==(const const_iterator& rhs) const { return m_id == rhs.m_id; }
+                bool            operator!=(const const_iterator& rhs) const { return m_id != rhs.m_id; }
+
+            private:
+                const MoveVertices* m_moves;
+                size_t              m_id;
+            };
+
+            size_t size() const { return m_positions.size(); }
+            bool empty() const { return m_positions.empty(); }
+            MoveVertex operator[](size_t id) const;
+            MoveVertex back() const { assert(! this->empty()); return (*this)[this->size() - 1]; }
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, this->size()); }
+
+            const Vec3f& position(size_t id) const { return m_positions[id]; }
+            EMoveType type(size_t id) const { return m_attributes[m_attributes_ids[id]].type; }
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+            unsigned int gcode_id(size_t id) const { return m_gcode_ids[id]; }
+            void set_gcode_id(size_t id, unsigned int gcode_id) { m_gcode_ids[id] = gcode_id; }
 #endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
 
+            void push_back(const MoveVertex& move);
+            void clear();
+            // Release the memory reserved for further push_back() calls and the lookup table of unique attributes.
+            void shrink_to_fit();
+            // Memory allocated by the moves, in bytes.
+            size_t memsize() const;
+
+        private:
+            // Attributes shared by sequences of moves.
+            struct Attributes
+            {
+                EMoveType type;
+                ExtrusionRole extrusion_role;
+                unsigned char extruder_id;
+                unsigned char cp_color_id;
+                float feedrate;
+                float height;
+                float fan_speed;
+                float temperature;
+
+                bool operator==(const Attributes& rhs) const;
+            };
+            struct AttributesHash
+            {
+                size_t operator()(const Attributes& attributes) const;
+            };
+
+#if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+            std::vector<unsigned int> m_gcode_ids;
+#endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
+            std::vector<Vec3f> m_positions;
+            std::vector<float> m_delta_extruders;
+            std::vector<float> m_widths;
+            std::vector<float> m_mm3_per_mms;
+            std::vector<uint32_t> m_attributes_ids;
+            std::vector<Attributes> m_attributes;
+            // Only used while pushing the moves.
+            std::unordered_map<Attributes, uint32_t, AttributesHash> m_attributes_map;
+        };
+
     private:
         struct TimeMachine
         {
@@ -328,7 +414,7 @@ namespace Slic3r {
             // post process the file with the given filename to add remaining time lines M73
 #if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
             // and updates moves' gcode ids accordingly
-            void post_process(const std::string& filename, std::vector<MoveVertex>& moves);
+            void post_process(const std::string& filename, MoveVertices& moves);
 #else
             void post_process(const std::string& filename);
 #endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
@@ -358,27 +444,6 @@ namespace Slic3r {
         };
 
     public:
-#if !ENABLE_GCODE_LINES_ID_IN_H_SLIDER
-        struct MoveVertex
-        {
-            EMoveType type{ EMoveType::Noop };
-            ExtrusionRole extrusion_role{ erNone };
-            unsigned char extruder_id{ 0 };
-            unsigned char cp_color_id{ 0 };
-            Vec3f position{ Vec3f::Zero() }; // mm
-            float delta_extruder{ 0.0f }; // mm
-            float feedrate{ 0.0f }; // mm/s
-            float width{ 0.0f }; // mm
-            float height{ 0.0f }; // mm
-            float mm3_per_mm{ 0.0f };
-            float fan_speed{ 0.0f }; // percentage
-            float temperature{ 0.0f }; // Celsius degrees
-            float time{ 0.0f }; // s
-
-            float volumetric_rate() const { return feedrate * mm3_per_mm; }
-        };
-#endif // !ENABLE_GCODE_LINES_ID_IN_H_SLIDER
-
         struct Result
         {
             struct SettingsIds
@@ -397,7 +462,7 @@ namespace Slic3r {
             std::string filename;
 #endif // ENABLE_GCODE_WINDOW
             unsigned int id;
-            std::vector<MoveVertex> moves;
+            MoveVertices moves;
             Pointfs bed_shape;
             SettingsIds settings_ids;
             size_t extruders_count;
@@ -564,6 +629,10 @@ namespace Slic3r {
         static const std::vector<std::pair<GCodeProcessor::EProducer, std::string>> Producers;
         EProducer m_producer;
         bool m_producers_enabled;
+        // Tokenize the G-code lines in parallel, see GCodeReader::parse_file_parallel().
+        bool m_parallel_parsing{ true };
+        // Unterminated last line of the buffer passed to process_buffer(), to be completed by the next call.
+        std::string m_line_buffer;
 
         TimeProcessor m_time_processor;
         UsedFilaments m_used_filaments;
@@ -587,6 +656,7 @@ namespace Slic3r {
         }
         void enable_machine_envelope_processing(bool enabled) { m_time_processor.machine_envelope_processing_enabled = enabled; }
         void enable_producers(bool enabled) { m_producers_enabled = enabled; }
+        void enable_parallel_parsing(bool enabled) { m_parallel_parsing = enabled; }
         void reset();
 
         const Result& get_result() const { return m_result; }
@@ -596,6 +666,13 @@ namespace Slic3r {
         // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
         void process_file(const std::string& filename, bool apply_postprocess, std::function<void()> cancel_callback = nullptr);
 
+        // Process the gcode while it is being generated, without reading it back from the file:
+        // initialize(), then process_buffer() with consecutive pieces of the gcode (not necessarily split at line boundaries),
+        // finally finalize() with the name of the file the gcode was written into.
+        void initialize();
+        void process_buffer(std::string_view buffer);
+        void finalize(const std::string& filename, bool apply_postprocess);
+
         float get_time(PrintEstimatedStatistics::ETimeMode mode) const;
         std::string get_time_dhm(PrintEstimatedStatistics::ETimeMode mode) const;
         std::vector<std::pair<CustomGCode::Type, std::pair<float, float>>> get_custom_gcode_times(PrintEstimatedStatistics::ETimeMode mode, bool include_remaining) const;
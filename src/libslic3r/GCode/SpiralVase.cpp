@@ -64,7 +64,8 @@ std::string SpiralVase::process_layer(const std::string &gcode)
                 // If this is the initial Z move of the layer, replace it with a
                 // (redundant) move to the last Z of previous layer.
                 line.set(reader, Z, z);
-                new_gcode += line.raw() + '\n';
+                new_gcode += line.raw();
+                new_gcode += '\n';
                 return;
             } else {
                 float dist_XY = line.dist_XY(reader);
@@ -76,7 +77,8 @@ std::string SpiralVase::process_layer(const std::string &gcode)
                         if (transition && line.has(E))
                             // Transition layer, modulate the amount of extrusion from zero to the final value.
                             line.set(reader, E, line.value(E) * len / total_layer_length);
-                        new_gcode += line.raw() + '\n';
+                        new_gcode += line.raw();
+                        new_gcode += '\n';
                     }
                     return;
                 
@@ -88,7 +90,8 @@ std::string SpiralVase::process_layer(const std::string &gcode)
                 }
             }
         }
-        new_gcode += line.raw() + '\n';
+        new_gcode += line.raw();
+        new_gcode += '\n';
     });
     
     return new_gcode;
@@ -1,8 +1,14 @@
 #include "GCodeReader.hpp"
+#include <atomic>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/nowide/fstream.hpp>
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <iostream>
 #include <iomanip>
 
@@ -10,6 +16,9 @@
 
 #include <Shiny/Shiny.h>
 
+#include <tbb/pipeline.h>
+#include <tbb/task_arena.h>
+
 namespace Slic3r {
 
 void GCodeReader::apply_config(const GCodeConfig &config)
@@ -24,7 +33,7 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_extrusion_axis = get_extrusion_axis(m_config)[0];
 }
 
-const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command)
+const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command) const
 {
     PROFILE_FUNC();
 
@@ -78,17 +87,12 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
         }
     }
     
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
-
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
 
-    // Copy the raw string including the comment, without the trailing newlines.
-    if (c > ptr) {
-        PROFILE_BLOCK(copy_raw_string);
-        gline.m_raw.assign(ptr, c);
-    }
+    // Reference the raw string including the comment, without the trailing newlines.
+    if (c > ptr)
+        gline.m_raw = std::string_view(ptr, c - ptr);
 
     // Skip the trailing newlines.
 	if (*c == '\r')
@@ -96,9 +100,6 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
 	if (*c == '\n')
 		++ c;
 
-    if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
-
     return c;
 }
 
@@ -118,21 +119,143 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 
 void GCodeReader::parse_file(const std::string &file, callback_t callback)
 {
-    boost::nowide::ifstream f(file);
-    std::string line;
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        // Mapping an empty file fails.
+        if (boost::filesystem::file_size(boost::filesystem::path(file)) > 0)
+            mapped.open(boost::filesystem::path(file));
+    } catch (const std::exception &) {
+        // Not a regular file, or the file could not be mapped. Fall back to reading the file line by line.
+    }
+    if (! mapped.is_open()) {
+        boost::nowide::ifstream f(file);
+        std::string line;
+#if ENABLE_VALIDATE_CUSTOM_GCODE
+        m_parsing = true;
+        while (m_parsing && std::getline(f, line))
+#else
+        m_parsing_file = true;
+        while (m_parsing_file && std::getline(f, line))
+#endif // ENABLE_VALIDATE_CUSTOM_GCODE
+            this->parse_line(line, callback);
+        return;
+    }
+
+    const char *ptr = mapped.data();
+    const char *end = ptr + mapped.size();
+    GCodeLine   gline;
 #if ENABLE_VALIDATE_CUSTOM_GCODE
     m_parsing = true;
-    while (m_parsing && std::getline(f, line))
+    while (m_parsing && ptr != end) {
 #else
     m_parsing_file = true;
-    while (m_parsing_file && std::getline(f, line))
+    while (m_parsing_file && ptr != end) {
 #endif // ENABLE_VALIDATE_CUSTOM_GCODE
-        this->parse_line(line, callback);
+        // Lines are split at newlines only, the same way std::getline() does.
+        const char *eol = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+        gline.reset();
+        if (eol == nullptr) {
+            // The last line is not terminated by a newline. The parser expects the line to be terminated,
+            // thus copy the line to be zero terminated instead of reading past the end of the mapping.
+            std::string last_line(ptr, end);
+            this->parse_line(last_line.c_str(), gline, callback);
+            break;
+        }
+        // The line is terminated by a newline inside the mapping, it is parsed in place.
+        this->parse_line(ptr, gline, callback);
+        ptr = eol + 1;
+    }
+}
+
+void GCodeReader::parse_file_parallel(const std::string &file, callback_t callback)
+{
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        if (boost::filesystem::file_size(boost::filesystem::path(file)) > 0)
+            mapped.open(boost::filesystem::path(file));
+    } catch (const std::exception &) {
+    }
+    if (! mapped.is_open()) {
+        // Empty file or the file could not be mapped.
+        this->parse_file(file, callback);
+        return;
+    }
+
+    // A chunk of lines tokenized by a worker thread. The lines reference the memory mapped file.
+    struct Chunk {
+        const char                                      *begin { nullptr };
+        const char                                      *end   { nullptr };
+        std::vector<GCodeLine>                           lines;
+        std::vector<std::pair<const char*, const char*>> commands;
+        // Copy of the last line if it is not terminated by a newline.
+        std::string                                      last_line;
+    };
+
+    // 4MB chunks: Large enough to amortize the scheduling overhead, small enough to keep all threads busy
+    // and to limit the memory consumed by the pre-parsed lines.
+    static constexpr const size_t chunk_size = 4 * 1024 * 1024;
+    const char *ptr = mapped.data();
+    const char *end = ptr + mapped.size();
+    this->set_parsing(true);
+    // m_parsing / m_parsing_file are only accessed by the stage running the callback, which may call quit_parsing().
+    // The stage reading the chunks runs on another thread and it is stopped through this flag.
+    std::atomic<bool> quit { false };
+
+    tbb::parallel_pipeline(2 * tbb::this_task_arena::max_concurrency(),
+        tbb::make_filter<void, std::shared_ptr<Chunk>>(tbb::filter::serial_in_order,
+            [&ptr, end, &quit](tbb::flow_control &fc) -> std::shared_ptr<Chunk> {
+                if (ptr == end || quit.load(std::memory_order_relaxed)) {
+                    fc.stop();
+                    return nullptr;
+                }
+                auto chunk = std::make_shared<Chunk>();
+                chunk->begin = ptr;
+                if (size_t(end - ptr) <= chunk_size)
+                    ptr = end;
+                else {
+                    // Split at a line boundary.
+                    const char *eol = static_cast<const char*>(memchr(ptr + chunk_size, '\n', end - ptr - chunk_size));
+                    ptr = eol == nullptr ? end : eol + 1;
+                }
+                chunk->end = ptr;
+                return chunk;
+            }) &
+        tbb::make_filter<std::shared_ptr<Chunk>, std::shared_ptr<Chunk>>(tbb::filter::parallel,
+            [this](std::shared_ptr<Chunk> chunk) -> std::shared_ptr<Chunk> {
+                // The locales are set per thread, strtod() is called with the numeric locale set to "C".
+                CNumericLocalesSetter locales_setter;
+                const char *ptr = chunk->begin;
+                while (ptr != chunk->end) {
+                    // Lines are split at newlines only, the same way std::getline() does.
+                    const char *eol = static_cast<const char*>(memchr(ptr, '\n', chunk->end - ptr));
+                    const char *line = ptr;
+                    if (eol == nullptr) {
+                        // The last line of the file is not terminated by a newline, make a zero terminated copy.
+                        chunk->last_line.assign(ptr, chunk->end);
+                        line = chunk->last_line.c_str();
+                        ptr  = chunk->end;
+                    } else
+                        ptr = eol + 1;
+                    chunk->lines.emplace_back();
+                    chunk->commands.emplace_back();
+                    this->parse_line_internal(line, chunk->lines.back(), chunk->commands.back());
+                }
+                return chunk;
+            }) &
+        tbb::make_filter<std::shared_ptr<Chunk>, void>(tbb::filter::serial_in_order,
+            [this, &callback, &quit](std::shared_ptr<Chunk> chunk) {
+                // The callback may parse numbers as well.
+                CNumericLocalesSetter locales_setter;
+                for (size_t i = 0; i < chunk->lines.size() && this->parsing(); ++ i)
+                    this->process_parsed_line(chunk->lines[i], chunk->commands[i], callback);
+                if (! this->parsing())
+                    quit.store(true, std::memory_order_relaxed);
+            }));
 }
 
 bool GCodeReader::GCodeLine::has(char axis) const
 {
-    const char *c = m_raw.c_str();
+    const char *c = this->raw_begin();
     // Skip the whitespaces.
     c = skip_whitespaces(c);
     // Skip the command.
@@ -155,7 +278,7 @@ bool GCodeReader::GCodeLine::has(char axis) const
 bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
 {
     assert(is_decimal_separator_point());
-    const char *c = m_raw.c_str();
+    const char *c = this->raw_begin();
     // Skip the whitespaces.
     c = skip_whitespaces(c);
     // Skip the command.
@@ -198,17 +321,21 @@ void GCodeReader::GCodeLine::set(const GCodeReader &reader, const Axis axis, con
         match[1] = reader.extrusion_axis();
     }
 
+    // Make a copy of the raw G-code to be modified.
+    std::string raw(m_raw);
     if (this->has(axis)) {
-        size_t pos = m_raw.find(match)+2;
-        size_t end = m_raw.find(' ', pos+1);
-        m_raw = m_raw.replace(pos, end-pos, ss.str());
+        size_t pos = raw.find(match)+2;
+        size_t end = raw.find(' ', pos+1);
+        raw = raw.replace(pos, end-pos, ss.str());
     } else {
-        size_t pos = m_raw.find(' ');
+        size_t pos = raw.find(' ');
         if (pos == std::string::npos)
-            m_raw += std::string(match) + ss.str();
+            raw += std::string(match) + ss.str();
         else
-            m_raw = m_raw.replace(pos, 0, std::string(match) + ss.str());
+            raw = raw.replace(pos, 0, std::string(match) + ss.str());
     }
+    m_raw_owned = std::move(raw);
+    m_raw       = m_raw_owned;
     m_axis[axis] = new_value;
     m_mask |= 1 << int(axis);
 }
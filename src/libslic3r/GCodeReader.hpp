@@ -4,7 +4,9 @@
 #include "libslic3r.h"
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <iostream>
 #include <string>
 #include <string_view>
 #include "PrintConfig.hpp"
@@ -13,18 +15,35 @@ namespace Slic3r {
 
 class GCodeReader {
 public:
+    // A single G-code line. The raw G-code is not copied, it points into the buffer or into the memory mapped file being parsed,
+    // thus it is only valid during the callback. Only a line modified by set() owns a copy of its raw G-code.
+    // The raw G-code is always followed by an end of line character (a newline, carriage return or zero),
+    // which terminates the scanning of the line.
     class GCodeLine {
     public:
         GCodeLine() { reset(); }
-        void reset() { m_mask = 0; memset(m_axis, 0, sizeof(m_axis)); m_raw.clear(); }
+        GCodeLine(const GCodeLine &rhs) { *this = rhs; }
+        GCodeLine& operator=(const GCodeLine &rhs) {
+            if (this != &rhs) {
+                if (rhs.owns_raw()) {
+                    m_raw_owned = rhs.m_raw_owned;
+                    m_raw       = m_raw_owned;
+                } else
+                    m_raw       = rhs.m_raw;
+                memcpy(m_axis, rhs.m_axis, sizeof(m_axis));
+                m_mask = rhs.m_mask;
+            }
+            return *this;
+        }
+        void reset() { m_mask = 0; memset(m_axis, 0, sizeof(m_axis)); m_raw = std::string_view(); }
 
-        const std::string&      raw() const { return m_raw; }
+        const std::string_view  raw() const { return m_raw; }
         const std::string_view  cmd() const { 
-            const char *cmd = GCodeReader::skip_whitespaces(m_raw.c_str());
+            const char *cmd = GCodeReader::skip_whitespaces(this->raw_begin());
             return std::string_view(cmd, GCodeReader::skip_word(cmd) - cmd);
         }
         const std::string_view  comment() const
-            { size_t pos = m_raw.find(';'); return (pos == std::string::npos) ? std::string_view() : std::string_view(m_raw).substr(pos + 1); }
+            { size_t pos = m_raw.find(';'); return (pos == std::string_view::npos) ? std::string_view() : m_raw.substr(pos + 1); }
 
         bool  has(Axis axis) const { return (m_mask & (1 << int(axis))) != 0; }
         float value(Axis axis) const { return m_axis[axis]; }
@@ -45,7 +64,7 @@ public:
             return sqrt(x*x + y*y);
         }
         bool cmd_is(const char *cmd_test) const {
-            const char *cmd = GCodeReader::skip_whitespaces(m_raw.c_str());
+            const char *cmd = GCodeReader::skip_whitespaces(this->raw_begin());
             size_t len = strlen(cmd_test); 
             return strncmp(cmd, cmd_test, len) == 0 && GCodeReader::is_end_of_word(cmd[len]);
         }
@@ -67,7 +86,13 @@ public:
         float f() const { return m_axis[F]; }
 
     private:
-        std::string      m_raw;
+        // Pointer to the start of the raw G-code. An empty line points to a terminating zero.
+        const char*      raw_begin() const { return m_raw.empty() ? "" : m_raw.data(); }
+        bool             owns_raw() const { return ! m_raw_owned.empty() && m_raw.data() == m_raw_owned.data(); }
+
+        std::string_view m_raw;
+        // Storage of the raw G-code modified by set().
+        std::string      m_raw_owned;
         float            m_axis[NUM_AXES];
         uint32_t         m_mask;
         friend class GCodeReader;
@@ -103,8 +128,7 @@ public:
     {
         std::pair<const char*, const char*> cmd;
         const char *end = parse_line_internal(ptr, gline, cmd);
-        callback(*this, gline);
-        update_coordinates(gline, cmd);
+        this->process_parsed_line(gline, cmd, callback);
         return end;
     }
 
@@ -112,7 +136,13 @@ public:
     void parse_line(const std::string &line, Callback callback)
         { GCodeLine gline; this->parse_line(line.c_str(), gline, callback); }
 
+    // Parse a G-code file. The file is memory mapped and the lines passed to the callback point directly into the mapping.
     void parse_file(const std::string &file, callback_t callback);
+    // Parse a G-code file the same way as parse_file(), producing the same sequence of callbacks.
+    // The memory mapped file is split into chunks at line boundaries, the chunks are tokenized in parallel
+    // (splitting into lines, finding the command and parsing the axis values), while the callback
+    // and the update of the reader state (the current position) run sequentially over the pre-parsed lines in the file order.
+    void parse_file_parallel(const std::string &file, callback_t callback);
 #if ENABLE_VALIDATE_CUSTOM_GCODE
     void quit_parsing() { m_parsing = false; }
 #else
@@ -134,8 +164,34 @@ public:
     void   set_extrusion_axis(char axis) { m_extrusion_axis = axis; }
 
 private:
-    const char* parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Tokenize a single line. Does not modify the state of the reader, thus it may be called in parallel.
+    const char* parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command) const;
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Update the reader state by a tokenized line, call the callback.
+    template<typename Callback>
+    void        process_parsed_line(GCodeLine &gline, std::pair<const char*, const char*> &command, Callback &callback)
+    {
+        if (gline.has(E) && m_config.use_relative_e_distances)
+            m_position[E] = 0;
+        if (m_verbose)
+            std::cout << gline.raw() << std::endl;
+        callback(*this, gline);
+        update_coordinates(gline, command);
+    }
+    bool        parsing() const {
+#if ENABLE_VALIDATE_CUSTOM_GCODE
+        return m_parsing;
+#else
+        return m_parsing_file;
+#endif // ENABLE_VALIDATE_CUSTOM_GCODE
+    }
+    void        set_parsing(bool parsing) {
+#if ENABLE_VALIDATE_CUSTOM_GCODE
+        m_parsing = parsing;
+#else
+        m_parsing_file = parsing;
+#endif // ENABLE_VALIDATE_CUSTOM_GCODE
+    }
 
     static bool         is_whitespace(char c)           { return c == ' ' || c == '\t'; }
     static bool         is_end_of_line(char c)          { return c == '\r' || c == '\n' || c == 0; }
@@ -156,6 +212,7 @@ private:
     char        m_extrusion_axis;
     float       m_position[NUM_AXES];
     bool        m_verbose;
+    // Only accessed by the thread running the callback, parse_file_parallel() stops reading the file through its own atomic flag.
 #if ENABLE_VALIDATE_CUSTOM_GCODE
     bool        m_parsing{ false };
 #else
@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <string>
+#include <string_view>
 #include "Extruder.hpp"
 #include "Point.hpp"
 #include "PrintConfig.hpp"
@@ -88,6 +89,51 @@ private:
     std::string _retract(double length, double restart_extra, const std::string &comment);
 };
 
+// Formatter of the G-code lines emitted for every move (G1 X.. Y.. E.. F..).
+// Produces exactly the same output as std::ostringstream with std::fixed and std::setprecision(),
+// but without the iostream machinery, locale lookups and repeated heap allocations:
+// The numbers are formatted with std::to_chars() into a stack buffer and appended to a single pre-reserved string.
+class GCodeFormatter {
+public:
+    GCodeFormatter(const char *command = nullptr) { m_out.reserve(64); if (command) m_out = command; }
+    GCodeFormatter(const GCodeFormatter&) = delete;
+    GCodeFormatter& operator=(const GCodeFormatter&) = delete;
+
+    // Number of decimal digits of the exported coordinates and feed rates.
+    static constexpr const int XYZF_EXPORT_DIGITS = 3;
+    // Number of decimal digits of the exported extrusion values.
+    static constexpr const int E_EXPORT_DIGITS    = 5;
+
+    // Emit " <axis><value>" with the value formatted with a fixed number of decimal digits.
+    void emit_axis(const std::string_view axis, const double v, const int digits);
+    void emit_xy(const Vec2d &point) { this->emit_axis("X", point.x(), XYZF_EXPORT_DIGITS); this->emit_axis("Y", point.y(), XYZF_EXPORT_DIGITS); }
+    void emit_xyz(const Vec3d &point) { this->emit_xy(Vec2d(point.x(), point.y())); this->emit_z(point.z()); }
+    void emit_z(const double z) { this->emit_axis("Z", z, XYZF_EXPORT_DIGITS); }
+    void emit_e(const std::string_view axis, const double v) { this->emit_axis(axis, v, E_EXPORT_DIGITS); }
+    void emit_f(const double speed) { this->emit_axis("F", speed, XYZF_EXPORT_DIGITS); }
+    void emit_string(const std::string_view s) { m_out.append(s.data(), s.size()); }
+    void emit_comment(const bool allow_comments, const std::string &comment) {
+        if (allow_comments && ! comment.empty()) {
+            m_out += " ; ";
+            m_out += comment;
+        }
+    }
+    // Terminate the line and pass the G-code to the caller, the formatter shall not be used afterwards.
+    std::string string() { m_out += '\n'; return std::move(m_out); }
+
+    // Append a value formatted the same way as std::ostringstream << std::fixed << std::setprecision(digits) << v.
+    static void append_fixed(std::string &out, const double v, const int digits);
+
+private:
+    std::string m_out;
+};
+
+// G1 move formatter.
+class GCodeG1Formatter : public GCodeFormatter {
+public:
+    GCodeG1Formatter() : GCodeFormatter("G1") {}
+};
+
 } /* namespace Slic3r */
 
 #endif /* slic3r_GCodeWriter_hpp_ */
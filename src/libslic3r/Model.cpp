@@ -108,8 +108,14 @@ Model Model::read_from_file(const std::string& input_file, DynamicPrintConfig* c
     if (config_substitutions == nullptr)
         config_substitutions = &temp_config_substitutions_context;
 
+    const std::string cache_key         = Model::cache_key(input_file, options, false);
+    const size_t      num_substitutions = config_substitutions->substitutions.size();
+    const bool        cached            = ! cache_key.empty() && model.load_from_cache(cache_key, *config);
+
     bool result = false;
-    if (boost::algorithm::iends_with(input_file, ".stl"))
+    if (cached)
+        result = true;
+    else if (boost::algorithm::iends_with(input_file, ".stl"))
         result = load_stl(input_file.c_str(), &model);
     else if (boost::algorithm::iends_with(input_file, ".obj"))
         result = load_obj(input_file.c_str(), &model);
@@ -128,6 +134,10 @@ Model Model::read_from_file(const std::string& input_file, DynamicPrintConfig* c
 
     if (model.objects.empty())
         throw Slic3r::RuntimeError("The supplied file couldn't be read because it's empty");
+
+    // Substitutions would not be reported when loading from the cache, thus such models are not cached.
+    if (! cache_key.empty() && ! cached && config_substitutions->substitutions.size() == num_substitutions)
+        model.save_to_cache(cache_key, *config);
     
     for (ModelObject *o : model.objects)
         o->input_file = input_file;
@@ -150,8 +160,14 @@ Model Model::read_from_archive(const std::string& input_file, DynamicPrintConfig
 
     Model model;
 
+    const std::string cache_key         = Model::cache_key(input_file, options, true);
+    const size_t      num_substitutions = config_substitutions->substitutions.size();
+    const bool        cached            = ! cache_key.empty() && model.load_from_cache(cache_key, *config);
+
     bool result = false;
-    if (boost::algorithm::iends_with(input_file, ".3mf"))
+    if (cached)
+        result = true;
+    else if (boost::algorithm::iends_with(input_file, ".3mf"))
         result = load_3mf(input_file.c_str(), *config, *config_substitutions, &model, options & LoadAttribute::CheckVersion);
     else if (boost::algorithm::iends_with(input_file, ".zip.amf"))
         result = load_amf(input_file.c_str(), config, config_substitutions, &model, options & LoadAttribute::CheckVersion);
@@ -164,6 +180,9 @@ Model Model::read_from_archive(const std::string& input_file, DynamicPrintConfig
     if (model.objects.empty())
         throw Slic3r::RuntimeError("The supplied file couldn't be read because it's empty");
 
+    if (! cache_key.empty() && ! cached && config_substitutions->substitutions.size() == num_substitutions)
+        model.save_to_cache(cache_key, *config);
+
     for (ModelObject *o : model.objects)
     {
 //        if (boost::algorithm::iends_with(input_file, ".zip.amf"))
@@ -671,6 +690,15 @@ ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, ModelVolumeType type /
     return v;
 }
 
+ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull, ModelVolumeType type /*= ModelVolumeType::MODEL_PART*/)
+{
+    ModelVolume* v = new ModelVolume(this, std::move(mesh), std::move(convex_hull), type);
+    this->volumes.push_back(v);
+    v->center_geometry_after_creation();
+    this->invalidate_bounding_box();
+    return v;
+}
+
 ModelVolume* ModelObject::add_volume(const ModelVolume &other, ModelVolumeType type /*= ModelVolumeType::INVALID*/)
 {
     ModelVolume* v = new ModelVolume(this, other);
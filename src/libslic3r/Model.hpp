@@ -279,6 +279,8 @@ public:
 
     ModelVolume*            add_volume(const TriangleMesh &mesh);
     ModelVolume*            add_volume(TriangleMesh &&mesh, ModelVolumeType type = ModelVolumeType::MODEL_PART);
+    // The convex hull of the mesh is provided by the caller, for example when loading many volumes in parallel.
+    ModelVolume*            add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull, ModelVolumeType type = ModelVolumeType::MODEL_PART);
     ModelVolume*            add_volume(const ModelVolume &volume, ModelVolumeType type = ModelVolumeType::INVALID);
     ModelVolume*            add_volume(const ModelVolume &volume, TriangleMesh &&mesh);
     void                    delete_volume(size_t idx);
@@ -531,10 +533,15 @@ enum class ConversionType : int {
 
 class FacetsAnnotation final : public ObjectWithTimestamp {
 public:
+    // Serialized TriangleSelector: Pairs of <triangle_id, bitstream offset> and the bitstream.
+    using Data = std::pair<std::vector<std::pair<int, int>>, std::vector<bool>>;
+
     // Assign the content if the timestamp differs, don't assign an ObjectID.
     void assign(const FacetsAnnotation& rhs) { if (! this->timestamp_matches(rhs)) { m_data = rhs.m_data; this->copy_timestamp(rhs); } }
     void assign(FacetsAnnotation&& rhs) { if (! this->timestamp_matches(rhs)) { m_data = std::move(rhs.m_data); this->copy_timestamp(rhs); } }
-    const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>>& get_data() const throw() { return m_data; }
+    const Data& get_data() const throw() { return m_data; }
+    // Assign data returned by get_data(), used by the model cache.
+    void set_data(Data &&data) { m_data = std::move(data); this->touch(); }
     bool set(const TriangleSelector& selector);
     indexed_triangle_set get_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
     indexed_triangle_set get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const;
@@ -576,7 +583,7 @@ private:
         ar(cereal::base_class<ObjectWithTimestamp>(this), m_data);
     }
 
-    std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> m_data;
+    Data m_data;
 
     // To access set_new_unique_id() when copy / pasting a ModelVolume.
     friend class ModelVolume;
@@ -1071,6 +1078,12 @@ public:
         DynamicPrintConfig* config, ConfigSubstitutionContext* config_substitutions,
         LoadAttributes options = LoadAttribute::AddDefaultInstances);
 
+    // On disk cache of the loaded models, see ModelCache.cpp. The cache is disabled if the directory is empty (default).
+    // read_from_file() and read_from_archive() load a model from the cache if the content of the input file did not change,
+    // otherwise the loaded model is stored into the cache. To be set at application start, not thread safe.
+    static void               set_cache_dir(const std::string &dir);
+    static const std::string& cache_dir();
+
     // Add a new ModelObject to this Model, generate a new ID for this ModelObject.
     ModelObject* add_object();
     ModelObject* add_object(const char *name, const char *path, const TriangleMesh &mesh);
@@ -1123,6 +1136,13 @@ public:
 
 private:
     explicit Model(int) : ObjectBase(-1) { assert(this->id().invalid()); }
+    // Hash of the content of the input file and of the loading parameters.
+    // Returns an empty string if the model cache is disabled or if the input file could not be read.
+    static std::string cache_key(const std::string &input_file, LoadAttributes options, bool archive);
+    // Load the model and the config loaded with it from the model cache. Returns false if not cached or on failure.
+    bool        load_from_cache(const std::string &key, DynamicPrintConfig &config);
+    // Failing to store the model cache is only logged.
+    void        save_to_cache(const std::string &key, const DynamicPrintConfig &config) const;
 	void assign_new_unique_ids_recursive();
 	void update_links_bottom_up_recursive();
 
@@ -0,0 +1,417 @@
+#include "CacheFile.hpp"
+#include "Exception.hpp"
+#include "Model.hpp"
+#include "libslic3r_version.h"
+
+#include <algorithm>
+#include <ctime>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/trivial.hpp>
+
+// On disk cache of the models loaded by Model::read_from_file() and Model::read_from_archive().
+// Opening the same model file over and over (for example a library of parts) loads the repaired meshes
+// with their convex hulls, the transformations, the configs and the painted facets from a binary file
+// instead of parsing the text / XML file and repairing the meshes again.
+// The cache key is a hash of the content of the input file, therefore a modified file is never loaded from the cache.
+
+namespace Slic3r {
+
+// Increase whenever the layout of the cache file or the data produced by the model loaders changes.
+static constexpr const uint32_t MODEL_CACHE_VERSION   = 1;
+static constexpr const char     MODEL_CACHE_MAGIC[4]  = { 'P', 'S', 'M', 'C' };
+// Once the cache grows over this limit, the least recently used files are removed.
+static constexpr const uintmax_t MODEL_CACHE_MAX_SIZE = uintmax_t(2048) << 20;
+
+static std::string s_model_cache_dir;
+
+void Model::set_cache_dir(const std::string &dir)
+{
+    s_model_cache_dir = dir;
+}
+
+const std::string& Model::cache_dir()
+{
+    return s_model_cache_dir;
+}
+
+namespace {
+
+// Extends the plain cache file writer with meshes, transformations and configs.
+class CacheWriter : public CacheFileWriter
+{
+public:
+    explicit CacheWriter(const CacheFileWriter &out) : CacheFileWriter(out) {}
+
+    template<typename Derived> void vec(const Eigen::MatrixBase<Derived> &v) {
+        for (int i = 0; i < v.size(); ++ i)
+            this->pod(v(i));
+    }
+    void transformation(const Geometry::Transformation &trafo) {
+        this->vec(trafo.get_offset());
+        this->vec(trafo.get_rotation());
+        this->vec(trafo.get_scaling_factor());
+        this->vec(trafo.get_mirror());
+    }
+    void config(const DynamicPrintConfig &config) {
+        const t_config_option_keys keys = config.keys();
+        this->count(keys.size());
+        for (const std::string &key : keys) {
+            this->string(key);
+            this->string(config.opt_serialize(key));
+        }
+    }
+    void config(const ModelConfig &config) { this->config(config.get()); }
+    void facets(const FacetsAnnotation &facets) {
+        const FacetsAnnotation::Data &data = facets.get_data();
+        this->vector(data.first);
+        this->count(data.second.size());
+        for (bool b : data.second)
+            this->pod(b);
+    }
+    // The repaired mesh is stored including its connectivity and statistics, so that it does not need to be repaired when loaded.
+    void mesh(const TriangleMesh &mesh) {
+        this->vector(mesh.stl.facet_start);
+        this->vector(mesh.stl.neighbors_start);
+        this->write(&mesh.stl.stats, sizeof(stl_stats));
+        this->vector(mesh.its.indices);
+        this->vector(mesh.its.vertices);
+        this->pod(mesh.repaired);
+    }
+};
+
+class CacheReader : public CacheFileReader
+{
+public:
+    explicit CacheReader(const CacheFileReader &in) : CacheFileReader(in) {}
+
+    template<typename Derived> void vec(Eigen::MatrixBase<Derived> &v) {
+        for (int i = 0; i < v.size(); ++ i)
+            this->pod(v(i));
+    }
+    Vec3d vec3d() { Vec3d v; this->vec(v); return v; }
+    Geometry::Transformation transformation() {
+        Geometry::Transformation trafo;
+        trafo.set_offset(this->vec3d());
+        trafo.set_rotation(this->vec3d());
+        trafo.set_scaling_factor(this->vec3d());
+        trafo.set_mirror(this->vec3d());
+        return trafo;
+    }
+    template<typename ConfigType> void config(ConfigType &config) {
+        size_t n = this->count();
+        for (size_t i = 0; i < n; ++ i) {
+            std::string key   = this->string();
+            std::string value = this->string();
+            config.set_deserialize(key, value, m_substitutions);
+        }
+    }
+    FacetsAnnotation::Data facets() {
+        FacetsAnnotation::Data data;
+        this->vector(data.first);
+        data.second.assign(this->count(), false);
+        for (size_t i = 0; i < data.second.size(); ++ i)
+            data.second[i] = this->pod<bool>();
+        return data;
+    }
+    TriangleMesh mesh() {
+        TriangleMesh mesh;
+        this->vector(mesh.stl.facet_start);
+        this->vector(mesh.stl.neighbors_start);
+        this->read(&mesh.stl.stats, sizeof(stl_stats));
+        this->vector(mesh.its.indices);
+        this->vector(mesh.its.vertices);
+        this->pod(mesh.repaired);
+        if (mesh.stl.facet_start.size() != mesh.stl.stats.number_of_facets || mesh.stl.neighbors_start.size() != mesh.stl.facet_start.size())
+            throw Slic3r::RuntimeError("Corrupted model cache file");
+        return mesh;
+    }
+
+private:
+    // The values were serialized from valid configs, any substitution means the cache is stale.
+    ConfigSubstitutionContext m_substitutions { ForwardCompatibilitySubstitutionRule::Disable };
+};
+
+static std::string model_cache_path(const std::string &key)
+{
+    return (boost::filesystem::path(s_model_cache_dir) / (key + ".model")).string();
+}
+
+// Remove the least recently used cache files until the cache fits MODEL_CACHE_MAX_SIZE.
+// A cache file is touched whenever it is loaded.
+static void model_cache_trim()
+{
+    struct CacheFile {
+        boost::filesystem::path path;
+        uintmax_t               size;
+        std::time_t             time;
+    };
+    std::vector<CacheFile> files;
+    uintmax_t              total_size = 0;
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator it(s_model_cache_dir, ec), end; ! ec && it != end; it.increment(ec))
+        if (boost::filesystem::is_regular_file(it->status()) && it->path().extension() == ".model") {
+            CacheFile file { it->path(), boost::filesystem::file_size(it->path(), ec), boost::filesystem::last_write_time(it->path(), ec) };
+            if (! ec) {
+                total_size += file.size;
+                files.emplace_back(std::move(file));
+            }
+            ec.clear();
+        }
+    if (total_size <= MODEL_CACHE_MAX_SIZE)
+        return;
+    std::sort(files.begin(), files.end(), [](const CacheFile &l, const CacheFile &r) { return l.time < r.time; });
+    for (const CacheFile &file : files) {
+        if (total_size <= MODEL_CACHE_MAX_SIZE)
+            break;
+        if (boost::filesystem::remove(file.path, ec))
+            total_size -= file.size;
+        ec.clear();
+    }
+}
+
+} // anonymous namespace
+
+std::string Model::cache_key(const std::string &input_file, LoadAttributes options, bool archive)
+{
+    if (s_model_cache_dir.empty())
+        return {};
+    try {
+        CacheHasher hasher;
+        hasher.string(SLIC3R_BUILD_ID);
+        hasher.pod(MODEL_CACHE_VERSION);
+        hasher.pod(archive);
+        hasher.pod(options);
+        // Object and volume names and ModelVolume::source are derived from the path of the input file.
+        hasher.string(boost::filesystem::absolute(input_file).string());
+        hasher.file(input_file);
+        return hasher.hex_digest();
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Model cache is not used for " << input_file << ": " << ex.what();
+        return {};
+    }
+}
+
+void Model::save_to_cache(const std::string &key, const DynamicPrintConfig &config) const
+{
+    const std::string path = model_cache_path(key);
+    try {
+        write_cache_file(path, [this, &key, &config](CacheFileWriter &file) {
+            CacheWriter out(file);
+            out.write(MODEL_CACHE_MAGIC, sizeof(MODEL_CACHE_MAGIC));
+            out.pod(MODEL_CACHE_VERSION);
+            out.string(key);
+            out.config(config);
+            out.count(this->materials.size());
+            for (const std::pair<const t_model_material_id, ModelMaterial*> &material : this->materials) {
+                out.string(material.first);
+                out.count(material.second->attributes.size());
+                for (const std::pair<const t_model_material_attribute, std::string> &attribute : material.second->attributes) {
+                    out.string(attribute.first);
+                    out.string(attribute.second);
+                }
+                out.config(material.second->config);
+            }
+            out.pod(this->custom_gcode_per_print_z.mode);
+            out.count(this->custom_gcode_per_print_z.gcodes.size());
+            for (const CustomGCode::Item &item : this->custom_gcode_per_print_z.gcodes) {
+                out.pod(item.print_z);
+                out.pod(item.type);
+                out.pod(item.extruder);
+                out.string(item.color);
+                out.string(item.extra);
+            }
+            out.vec(this->wipe_tower.position);
+            out.pod(this->wipe_tower.rotation);
+            out.count(this->objects.size());
+            for (const ModelObject *object : this->objects) {
+                out.string(object->name);
+                out.config(object->config);
+                out.count(object->layer_config_ranges.size());
+                for (const std::pair<const t_layer_height_range, ModelConfig> &range : object->layer_config_ranges) {
+                    out.pod(range.first.first);
+                    out.pod(range.first.second);
+                    out.config(range.second);
+                }
+                out.vector(object->layer_height_profile.get());
+                out.pod(object->printable);
+                out.count(object->sla_support_points.size());
+                for (const sla::SupportPoint &pt : object->sla_support_points) {
+                    out.vec(pt.pos);
+                    out.pod(pt.head_front_radius);
+                    out.pod(pt.is_new_island);
+                }
+                out.pod(object->sla_points_status);
+                out.count(object->sla_drain_holes.size());
+                for (const sla::DrainHole &hole : object->sla_drain_holes) {
+                    out.vec(hole.pos);
+                    out.vec(hole.normal);
+                    out.pod(hole.radius);
+                    out.pod(hole.height);
+                }
+                out.vec(object->origin_translation);
+                out.count(object->instances.size());
+                for (const ModelInstance *instance : object->instances) {
+                    out.transformation(instance->get_transformation());
+                    out.pod(instance->printable);
+                }
+                out.count(object->volumes.size());
+                for (const ModelVolume *volume : object->volumes) {
+                    out.string(volume->name);
+                    out.string(volume->source.input_file);
+                    out.pod(volume->source.object_idx);
+                    out.pod(volume->source.volume_idx);
+                    out.vec(volume->source.mesh_offset);
+                    out.transformation(volume->source.transform);
+                    out.pod(volume->source.is_converted_from_inches);
+                    out.pod(volume->source.is_converted_from_meters);
+                    out.pod(volume->source.is_from_builtin_objects);
+                    out.pod(volume->type());
+                    out.string(volume->material_id());
+                    out.transformation(volume->get_transformation());
+                    out.config(volume->config);
+                    out.facets(volume->supported_facets);
+                    out.facets(volume->seam_facets);
+                    out.facets(volume->mmu_segmentation_facets);
+                    out.mesh(volume->mesh());
+                    out.pod(volume->m_convex_hull != nullptr);
+                    if (volume->m_convex_hull)
+                        out.mesh(*volume->m_convex_hull);
+                }
+            }
+            out.write(MODEL_CACHE_MAGIC, sizeof(MODEL_CACHE_MAGIC));
+        });
+        BOOST_LOG_TRIVIAL(info) << "Model stored into the model cache " << path;
+    } catch (const std::exception &ex) {
+        // Failing to store the cache is not fatal.
+        BOOST_LOG_TRIVIAL(error) << "Failed storing a model into the model cache: " << ex.what();
+        return;
+    }
+    model_cache_trim();
+}
+
+bool Model::load_from_cache(const std::string &key, DynamicPrintConfig &config)
+{
+    assert(this->objects.empty() && this->materials.empty());
+    const std::string path = model_cache_path(key);
+    if (! boost::filesystem::exists(path))
+        return false;
+
+    // The config is only applied if the whole file was loaded successfully.
+    DynamicPrintConfig cached_config;
+    try {
+        read_cache_file(path, [this, &key, &cached_config](CacheFileReader &file) {
+            CacheReader in(file);
+            in.magic(MODEL_CACHE_MAGIC, sizeof(MODEL_CACHE_MAGIC));
+            if (in.pod<uint32_t>() != MODEL_CACHE_VERSION || in.string() != key)
+                throw Slic3r::RuntimeError("Cache file version or key mismatch");
+            in.config(cached_config);
+            for (size_t num_materials = in.count(); num_materials > 0; -- num_materials) {
+                ModelMaterial *material = this->add_material(in.string());
+                for (size_t num_attributes = in.count(); num_attributes > 0; -- num_attributes) {
+                    std::string attribute = in.string();
+                    material->attributes[attribute] = in.string();
+                }
+                in.config(material->config);
+            }
+            in.pod(this->custom_gcode_per_print_z.mode);
+            this->custom_gcode_per_print_z.gcodes.assign(in.count(), CustomGCode::Item());
+            for (CustomGCode::Item &item : this->custom_gcode_per_print_z.gcodes) {
+                in.pod(item.print_z);
+                in.pod(item.type);
+                in.pod(item.extruder);
+                item.color = in.string();
+                item.extra = in.string();
+            }
+            in.vec(this->wipe_tower.position);
+            in.pod(this->wipe_tower.rotation);
+            for (size_t num_objects = in.count(); num_objects > 0; -- num_objects) {
+                ModelObject *object = this->add_object();
+                object->name = in.string();
+                in.config(object->config);
+                for (size_t num_ranges = in.count(); num_ranges > 0; -- num_ranges) {
+                    auto min_z = in.pod<coordf_t>();
+                    auto max_z = in.pod<coordf_t>();
+                    in.config(object->layer_config_ranges[{ min_z, max_z }]);
+                }
+                std::vector<coordf_t> layer_height_profile;
+                in.vector(layer_height_profile);
+                object->layer_height_profile.set(std::move(layer_height_profile));
+                in.pod(object->printable);
+                object->sla_support_points.assign(in.count(), sla::SupportPoint());
+                for (sla::SupportPoint &pt : object->sla_support_points) {
+                    in.vec(pt.pos);
+                    in.pod(pt.head_front_radius);
+                    in.pod(pt.is_new_island);
+                }
+                in.pod(object->sla_points_status);
+                object->sla_drain_holes.assign(in.count(), sla::DrainHole());
+                for (sla::DrainHole &hole : object->sla_drain_holes) {
+                    in.vec(hole.pos);
+                    in.vec(hole.normal);
+                    in.pod(hole.radius);
+                    in.pod(hole.height);
+                }
+                in.vec(object->origin_translation);
+                for (size_t num_instances = in.count(); num_instances > 0; -- num_instances) {
+                    ModelInstance *instance = object->add_instance();
+                    instance->set_transformation(in.transformation());
+                    in.pod(instance->printable);
+                }
+                for (size_t num_volumes = in.count(); num_volumes > 0; -- num_volumes) {
+                    ModelVolume::Source source;
+                    std::string name = in.string();
+                    source.input_file = in.string();
+                    in.pod(source.object_idx);
+                    in.pod(source.volume_idx);
+                    in.vec(source.mesh_offset);
+                    source.transform = in.transformation();
+                    in.pod(source.is_converted_from_inches);
+                    in.pod(source.is_converted_from_meters);
+                    in.pod(source.is_from_builtin_objects);
+                    auto                     type           = in.pod<ModelVolumeType>();
+                    t_model_material_id      material_id    = in.string();
+                    Geometry::Transformation transformation = in.transformation();
+                    // The volume is created at the end, once its mesh and convex hull are available.
+                    ModelConfig      config;
+                    in.config(config);
+                    FacetsAnnotation::Data supported_facets        = in.facets();
+                    FacetsAnnotation::Data seam_facets             = in.facets();
+                    FacetsAnnotation::Data mmu_segmentation_facets = in.facets();
+                    TriangleMesh mesh = in.mesh();
+                    // The meshes are already centered, don't call ModelObject::add_volume(), which would center them again.
+                    ModelVolume *volume = in.pod<bool>() ?
+                        new ModelVolume(object, std::move(mesh), in.mesh(), type) :
+                        new ModelVolume(object, mesh, type);
+                    object->volumes.emplace_back(volume);
+                    volume->name   = std::move(name);
+                    volume->source = std::move(source);
+                    volume->set_material_id(material_id);
+                    volume->set_transformation(transformation);
+                    volume->config.assign_config(std::move(config));
+                    volume->supported_facets.set_data(std::move(supported_facets));
+                    volume->seam_facets.set_data(std::move(seam_facets));
+                    volume->mmu_segmentation_facets.set_data(std::move(mmu_segmentation_facets));
+                }
+                object->invalidate_bounding_box();
+            }
+            in.magic(MODEL_CACHE_MAGIC, sizeof(MODEL_CACHE_MAGIC));
+        });
+    } catch (const std::exception &ex) {
+        this->clear_objects();
+        this->clear_materials();
+        this->custom_gcode_per_print_z = CustomGCode::Info();
+        BOOST_LOG_TRIVIAL(error) << "Failed loading a model from the model cache " << path << ": " << ex.what();
+        return false;
+    }
+
+    config.apply(cached_config);
+    // Mark the file as recently used for model_cache_trim().
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    BOOST_LOG_TRIVIAL(info) << "Model loaded from the model cache " << path;
+    return true;
+}
+
+} // namespace Slic3r
@@ -5,6 +5,8 @@
 #include "ClipperUtils.hpp"
 #include "Extruder.hpp"
 #include "Flow.hpp"
+#include "Fill/FillPatternCache.hpp"
+#include "Fill/FillSurfaceCache.hpp"
 #include "Geometry.hpp"
 #include "I18N.hpp"
 #include "ShortestPath.hpp"
@@ -23,6 +25,8 @@
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/task_group.h>
+
 // Mark string for localization and translate.
 #define L(s) Slic3r::I18N::translate(s)
 
@@ -256,6 +260,43 @@ bool Print::is_step_done(PrintObjectStep step) const
     return true;
 }
 
+const char* Print::step_name(int step) const
+{
+    switch (PrintStep(step)) {
+    case psWipeTower:   return "psWipeTower";
+    case psSkirtBrim:   return "psSkirtBrim";
+    case psGCodeExport: return "psGCodeExport";
+    default:            return "";
+    }
+}
+
+const char* Print::object_step_name(int step) const
+{
+    switch (PrintObjectStep(step)) {
+    case posSlice:              return "posSlice";
+    case posPerimeters:         return "posPerimeters";
+    case posPrepareInfill:      return "posPrepareInfill";
+    case posInfill:             return "posInfill";
+    case posIroning:            return "posIroning";
+    case posSupportMaterial:    return "posSupportMaterial";
+    default:                    return "";
+    }
+}
+
+void Print::step_stats_output(int step, PrintStepStats &stats) const
+{
+    switch (PrintStep(step)) {
+    case psWipeTower:
+        stats.layers     = m_wipe_tower_data.tool_changes.size();
+        break;
+    case psSkirtBrim:
+        stats.extrusions = m_skirt.items_count() + m_brim.items_count();
+        break;
+    default:
+        break;
+    }
+}
+
 // returns 0-based indices of used extruders
 std::vector<unsigned int> Print::object_extruders() const
 {
@@ -822,15 +863,40 @@ void Print::process()
     name_tbb_thread_pool_threads();
 
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
-    for (PrintObject *obj : m_objects)
-        obj->make_perimeters();
-    this->set_status(70, L("Infilling layers"));
-    for (PrintObject *obj : m_objects)
-        obj->infill();
-    for (PrintObject *obj : m_objects)
-        obj->ironing();
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_material();
+    {
+        // The PrintObject steps (posSlice .. posSupportMaterial) of one PrintObject do not depend on any other PrintObject,
+        // thus each PrintObject is processed as an independent pipeline of its own steps. A plate with a single tall object
+        // and many small objects will not wait for the tall object to finish each step before the small objects
+        // may advance to the next step. The per layer parallelization inside the steps is nested into these tasks.
+        // Only the wipe tower and skirt / brim depend on all PrintObjects, they are generated once all the pipelines finish.
+        // Start the tallest objects first, they are likely to take the longest time to finish.
+        std::vector<PrintObject*> objects_by_height(m_objects);
+        std::stable_sort(objects_by_height.begin(), objects_by_height.end(),
+            [](const PrintObject *l, const PrintObject *r) { return l->height() > r->height(); });
+        // Release the infill patterns and the infill shared by the objects, also if the pipelines were canceled or failed.
+        // Declared before object_pipelines, so that it runs after all the pipelines have been finished.
+        ScopeGuard clear_fill_caches([]() {
+            FillPatternCache::clear();
+            FillSurfaceCache::clear();
+        });
+        tbb::task_group object_pipelines;
+        for (PrintObject *obj : objects_by_height)
+            object_pipelines.run([this, obj]() {
+                // Only reuse the cached results if none of the steps of this object is valid.
+                bool use_cache = ! m_object_cache_dir.empty() && ! obj->is_step_done(posSlice);
+                if (use_cache && obj->load_from_cache(m_object_cache_dir))
+                    return;
+                obj->make_perimeters();
+                obj->infill();
+                obj->ironing();
+                obj->generate_support_material();
+                if (use_cache)
+                    obj->save_to_cache(m_object_cache_dir);
+            });
+        // Rethrows the first exception thrown by any of the pipelines (for example CanceledException or SlicingError),
+        // the other pipelines are canceled by TBB.
+        object_pipelines.wait();
+    }
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
@@ -332,6 +332,15 @@ public:
     // Helpers to project custom facets on slices
     void project_and_append_custom_facets(bool seam, EnforcerBlockerType type, std::vector<Polygons>& expolys) const;
 
+    // On disk cache of the results of the PrintObject steps, see PrintObjectCache.cpp.
+    // Hash of the object geometry and of all the settings the PrintObject steps depend on.
+    std::string cache_key() const;
+    // Load all the PrintObject steps from <cache_dir>/<cache_key>.bin and mark them as done.
+    // Returns false if the cache file does not exist or it could not be loaded.
+    bool        load_from_cache(const std::string &cache_dir);
+    // Store the results of the PrintObject steps. Failing to store the cache is only logged.
+    void        save_to_cache(const std::string &cache_dir) const;
+
 private:
     // to be called from Print only.
     friend class Print;
@@ -373,6 +382,7 @@ private:
     void combine_infill();
     void _generate_support_material();
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> prepare_adaptive_infill_data();
+    void step_stats_output(int step, PrintStepStats &stats) const override;
 
     // XYZ in scaled coordinates
     Vec3crd									m_size;
@@ -514,6 +524,11 @@ public:
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessor::Result* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
 
+    // Directory of the on disk cache of the PrintObject steps. If empty (default), the cache is not used.
+    // The results of the PrintObject steps are loaded from the cache by process() if available, otherwise they are stored into the cache.
+    void                set_object_cache_dir(const std::string &dir) { m_object_cache_dir = dir; }
+    const std::string&  object_cache_dir() const { return m_object_cache_dir; }
+
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
     // Returns true if an object step is done on all objects and there's at least one object.    
@@ -521,6 +536,9 @@ public:
     // Returns true if the last step was finished with success.
     bool                finished() const override { return this->is_step_done(psGCodeExport); }
 
+    const char*         step_name(int step) const override;
+    const char*         object_step_name(int step) const override;
+
     bool                has_infinite_skirt() const;
     bool                has_skirt() const;
     bool                has_brim() const;
@@ -589,6 +607,9 @@ protected:
     // Invalidates the step, and its depending steps in Print.
     bool                invalidate_step(PrintStep step);
 
+protected:
+    void                step_stats_output(int step, PrintStepStats &stats) const override;
+
 private:
     bool                invalidate_state_by_config_options(const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
 
@@ -625,6 +646,9 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
 
+    // Directory of the on disk cache of the PrintObject steps, empty if disabled.
+    std::string                             m_object_cache_dir;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
@@ -1,5 +1,9 @@
 #include "Exception.hpp"
 #include "PrintBase.hpp"
+#include "Utils.hpp"
+
+#include <cstdio>
+#include <map>
 
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
@@ -119,4 +123,151 @@ void PrintObjectBase::status_update_warnings(PrintBase *print, int step, PrintSt
     print->status_update_warnings(step, warning_level, message, this);
 }
 
+bool PrintObjectBase::step_stats_enabled(const PrintBase *print)
+{
+    return print->step_stats_enabled();
+}
+
+void PrintObjectBase::step_stats_add(PrintBase *print, int step, PrintStepTimer &timer) const
+{
+    print->step_stats_add(step, timer, this);
+}
+
+void PrintStepTimer::start()
+{
+    ProcessMemoryInfo mem = process_memory_info();
+    m_resident = mem.resident;
+    m_peak     = mem.peak;
+    m_cpu_time = process_cpu_time();
+    m_start    = std::chrono::steady_clock::now();
+    m_running  = true;
+}
+
+bool PrintStepTimer::stop(std::chrono::steady_clock::time_point origin, PrintStepStats &stats)
+{
+    if (! m_running)
+        return false;
+    auto              now = std::chrono::steady_clock::now();
+    ProcessMemoryInfo mem = process_memory_info();
+    stats.start_time        = std::chrono::duration<double>(m_start - origin).count();
+    stats.wall_time         = std::chrono::duration<double>(now - m_start).count();
+    stats.cpu_time          = process_cpu_time() - m_cpu_time;
+    stats.memory_delta      = int64_t(mem.resident) - int64_t(m_resident);
+    stats.peak_memory_delta = mem.peak > m_peak ? mem.peak - m_peak : 0;
+    m_running = false;
+    return true;
+}
+
+void PrintBase::clear_step_stats()
+{
+    std::scoped_lock<std::mutex> lock(m_step_stats_mutex);
+    m_step_stats.clear();
+    m_step_stats_origin = std::chrono::steady_clock::now();
+}
+
+std::vector<PrintStepStats> PrintBase::step_stats() const
+{
+    std::scoped_lock<std::mutex> lock(m_step_stats_mutex);
+    return m_step_stats;
+}
+
+void PrintBase::step_stats_add(int step, PrintStepTimer &timer, const PrintObjectBase *print_object)
+{
+    PrintStepStats stats;
+    if (! timer.stop(m_step_stats_origin, stats))
+        // The statistics were enabled while the step was running.
+        return;
+    stats.step = step;
+    if (print_object) {
+        stats.step_name   = this->object_step_name(step);
+        stats.object_name = print_object->model_object()->name;
+        stats.object_id   = print_object->id();
+        print_object->step_stats_output(step, stats);
+    } else {
+        stats.step_name   = this->step_name(step);
+        this->step_stats_output(step, stats);
+    }
+    std::scoped_lock<std::mutex> lock(m_step_stats_mutex);
+    m_step_stats.emplace_back(std::move(stats));
+}
+
+static std::string json_escape(const std::string &str)
+{
+    std::string out;
+    out.reserve(str.size() + 2);
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buf[8];
+                sprintf(buf, "\\u%04x", (unsigned int)c);
+                out += buf;
+            } else
+                out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+void export_step_stats_json(const std::vector<PrintStepStats> &stats, std::ostream &out)
+{
+    out << "[";
+    for (size_t i = 0; i < stats.size(); ++ i) {
+        const PrintStepStats &s = stats[i];
+        out << (i == 0 ? "\n" : ",\n") << "  { "
+            << "\"step\": " << json_escape(s.step_name)
+            << ", \"object\": " << json_escape(s.object_name)
+            << ", \"object_id\": " << (s.object_id.valid() ? int64_t(s.object_id.id) : -1)
+            << ", \"start\": " << s.start_time
+            << ", \"wall_time\": " << s.wall_time
+            << ", \"cpu_time\": " << s.cpu_time
+            << ", \"memory_delta\": " << s.memory_delta
+            << ", \"peak_memory_delta\": " << s.peak_memory_delta
+            << ", \"layers\": " << s.layers
+            << ", \"polygons\": " << s.polygons
+            << ", \"extrusions\": " << s.extrusions
+            << " }";
+    }
+    out << "\n]\n";
+}
+
+void export_step_stats_chrome_trace(const std::vector<PrintStepStats> &stats, std::ostream &out)
+{
+    // One row (thread) per PrintObject, the steps of a single PrintObject are executed sequentially,
+    // thus the events of a row do not overlap.
+    std::map<size_t, std::pair<int, std::string>> rows;
+    rows[ObjectID().id] = { 0, "Print" };
+    for (const PrintStepStats &s : stats)
+        if (s.object_id.valid() && rows.find(s.object_id.id) == rows.end())
+            rows[s.object_id.id] = { int(rows.size()), s.object_name };
+
+    out << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    auto separator = [&first]() { const char *sep = first ? "\n" : ",\n"; first = false; return sep; };
+    for (const auto &row : rows)
+        out << separator() << "  { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << row.second.first
+            << ", \"args\": { \"name\": " << json_escape(row.second.second) << " } }";
+    for (const PrintStepStats &s : stats)
+        out << separator() << "  { \"name\": " << json_escape(s.step_name)
+            << ", \"cat\": " << (s.object_id.valid() ? "\"PrintObject\"" : "\"Print\"")
+            << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << rows[s.object_id.id].first
+            << ", \"ts\": " << int64_t(s.start_time * 1e6)
+            << ", \"dur\": " << int64_t(s.wall_time * 1e6)
+            << ", \"args\": { \"cpu_time\": " << s.cpu_time
+            << ", \"memory_delta\": " << s.memory_delta
+            << ", \"peak_memory_delta\": " << s.peak_memory_delta
+            << ", \"layers\": " << s.layers
+            << ", \"polygons\": " << s.polygons
+            << ", \"extrusions\": " << s.extrusions
+            << " } }";
+    out << "\n] }\n";
+}
+
 } // namespace Slic3r
@@ -7,7 +7,9 @@
 #include <string>
 #include <functional>
 #include <atomic>
+#include <chrono>
 #include <mutex>
+#include <ostream>
 
 #include "ObjectID.hpp"
 #include "Model.hpp"
@@ -298,6 +300,53 @@ private:
     int                 m_step_active = -1;
 };
 
+// Statistics of a single run of a Print or PrintObject step, collected if enabled with PrintBase::set_step_stats_enabled().
+struct PrintStepStats
+{
+    // Name of the step, for example "posSlice" or "psSkirtBrim".
+    std::string     step_name;
+    // Index of the step in its PrintStep / PrintObjectStep enum.
+    int             step { -1 };
+    // Name and ObjectID of the PrintObject, empty and invalid for the Print steps.
+    std::string     object_name;
+    ObjectID        object_id;
+    // Start of the step relative to PrintBase::set_step_stats_enabled() / clear_step_stats(), and duration of the step, in seconds.
+    double          start_time { 0. };
+    double          wall_time { 0. };
+    // CPU time spent by all threads of the process while the step was running. As the PrintObject steps of multiple
+    // objects run concurrently, it includes CPU time of the other steps running at the same time.
+    double          cpu_time { 0. };
+    // Change of the resident memory and of the peak resident memory of the process in bytes.
+    int64_t         memory_delta { 0 };
+    size_t          peak_memory_delta { 0 };
+    // Size of the output of the step, if it applies to the step.
+    size_t          layers { 0 };
+    size_t          polygons { 0 };
+    size_t          extrusions { 0 };
+};
+
+// Export the step statistics as a JSON array with one record per step.
+extern void export_step_stats_json(const std::vector<PrintStepStats> &stats, std::ostream &out);
+// Export the step statistics in the Chrome trace event format, to be viewed with chrome://tracing or https://ui.perfetto.dev
+// The Print steps are shown on the first row, the steps of each PrintObject on a row of their own.
+extern void export_step_stats_chrome_trace(const std::vector<PrintStepStats> &stats, std::ostream &out);
+
+// Measures a running step for PrintStepStats.
+class PrintStepTimer
+{
+public:
+    void start();
+    // Fill in the times and memory usage of stats, return false if the timer was not started.
+    bool stop(std::chrono::steady_clock::time_point origin, PrintStepStats &stats);
+
+private:
+    std::chrono::steady_clock::time_point   m_start;
+    double                                  m_cpu_time { 0. };
+    size_t                                  m_resident { 0 };
+    size_t                                  m_peak { 0 };
+    bool                                    m_running { false };
+};
+
 class PrintBase;
 
 class PrintObjectBase : public ObjectBase
@@ -316,6 +365,12 @@ protected:
 	// The UI will be notified by calling a status callback registered on print.
 	// If no status callback is registered, the message is printed to console.
 	void 				   				status_update_warnings(PrintBase *print, int step, PrintStateBase::WarningLevel warning_level, const std::string &message);
+    // Step statistics, see PrintBase::set_step_stats_enabled().
+    static bool                         step_stats_enabled(const PrintBase *print);
+    void                                step_stats_add(PrintBase *print, int step, PrintStepTimer &timer) const;
+    // Fill in the size of the output of a step into the step statistics.
+    virtual void                        step_stats_output(int /* step */, PrintStepStats & /* stats */) const {}
+    friend class PrintBase;
 
     ModelObject                  *m_model_object;
 };
@@ -467,6 +522,17 @@ public:
     // If filename_set is empty, than the path may be a file or directory. If it is a file, then the macro will not be processed.
     std::string                output_filepath(const std::string &path, const std::string &filename_base = std::string()) const;
 
+    // Collect timing and memory statistics of the Print and PrintObject steps executed from now on.
+    // Enabling the statistics clears the statistics collected so far.
+    void                        set_step_stats_enabled(bool enable) { if (enable) this->clear_step_stats(); m_step_stats_enabled = enable; }
+    bool                        step_stats_enabled() const { return m_step_stats_enabled; }
+    void                        clear_step_stats();
+    // Statistics of the steps executed since the statistics were enabled, ordered by the end of the steps.
+    std::vector<PrintStepStats> step_stats() const;
+    // Names of the Print and PrintObject steps for the step statistics.
+    virtual const char*         step_name(int /* step */) const { return ""; }
+    virtual const char*         object_step_name(int /* step */) const { return ""; }
+
 protected:
 	friend class PrintObjectBase;
     friend class BackgroundSlicingProcess;
@@ -489,6 +555,10 @@ protected:
     std::string            output_filename(const std::string &format, const std::string &default_ext, const std::string &filename_base, const DynamicConfig *config_override = nullptr) const;
     // Update "scale", "input_filename", "input_filename_base" placeholders from the current printable ModelObjects.
     void                   update_object_placeholders(DynamicConfig &config, const std::string &default_ext) const;
+    // Finish the step statistics of a Print step (print_object == nullptr) or of a PrintObject step.
+    void                   step_stats_add(int step, PrintStepTimer &timer, const PrintObjectBase *print_object = nullptr);
+    // Fill in the size of the output of a Print step into the step statistics.
+    virtual void           step_stats_output(int /* step */, PrintStepStats & /* stats */) const {}
 
 	Model                                   m_model;
 	DynamicPrintConfig						m_full_print_config;
@@ -508,6 +578,12 @@ private:
     // while the data influencing the stage is modified.
     mutable std::mutex                      m_state_mutex;
 
+    // Step statistics, guarded by m_step_stats_mutex as the PrintObject steps are executed in parallel.
+    bool                                    m_step_stats_enabled { false };
+    std::chrono::steady_clock::time_point   m_step_stats_origin;
+    std::vector<PrintStepStats>             m_step_stats;
+    mutable std::mutex                      m_step_stats_mutex;
+
     friend PrintTryCancel;
 };
 
@@ -520,11 +596,18 @@ public:
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintStepEnum step) const { return m_state.state_with_warnings(step, this->state_mutex()); }
 
 protected:
-    bool            set_started(PrintStepEnum step) { return m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintStepEnum step) {
+        bool started = m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        if (started && this->step_stats_enabled())
+            m_step_timers[step].start();
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintStepEnum step) { 
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
         if (status.second)
             this->status_update_warnings(static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
+        if (this->step_stats_enabled())
+            this->step_stats_add(static_cast<int>(step), m_step_timers[step]);
         return status.first;
 	}
     bool            invalidate_step(PrintStepEnum step)
@@ -551,6 +634,7 @@ protected:
 
 private:
     PrintState<PrintStepEnum, COUNT> m_state;
+    PrintStepTimer                   m_step_timers[COUNT];
 };
 
 template<typename PrintType, typename PrintObjectStepEnum, const size_t COUNT>
@@ -568,12 +652,18 @@ public:
 protected:
 	PrintObjectBaseWithState(PrintType *print, ModelObject *model_object) : PrintObjectBase(model_object), m_print(print) {}
 
-    bool            set_started(PrintObjectStepEnum step) 
-        { return m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintObjectStepEnum step) {
+        bool started = m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        if (started && PrintObjectBase::step_stats_enabled(m_print))
+            m_step_timers[step].start();
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintObjectStepEnum step) { 
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
         if (status.second)
             this->status_update_warnings(m_print, static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
+        if (PrintObjectBase::step_stats_enabled(m_print))
+            this->step_stats_add(m_print, static_cast<int>(step), m_step_timers[step]);
         return status.first;
 	}
 
@@ -608,6 +698,7 @@ protected:
 
 private:
     PrintState<PrintObjectStepEnum, COUNT>   m_state;
+    PrintStepTimer                           m_step_timers[COUNT];
 };
 
 } // namespace Slic3r
@@ -117,6 +117,13 @@ static t_config_enum_values s_keys_map_IroningType {
 };
 CONFIG_OPTION_ENUM_DEFINE_STATIC_MAPS(IroningType)
 
+static t_config_enum_values s_keys_map_MonotonicQuality {
+    { "fast",           int(MonotonicQuality::Fast) },
+    { "normal",         int(MonotonicQuality::Normal) },
+    { "best",           int(MonotonicQuality::Best) }
+};
+CONFIG_OPTION_ENUM_DEFINE_STATIC_MAPS(MonotonicQuality)
+
 static t_config_enum_values s_keys_map_SlicingMode {
     { "regular",        int(SlicingMode::Regular) },
     { "even_odd",       int(SlicingMode::EvenOdd) },
@@ -1763,6 +1770,22 @@ void PrintConfigDef::init_fff_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloats { 10. });
 
+    def = this->add("monotonic_infill_quality", coEnum);
+    def->label = L("Monotonic infill quality");
+    def->category = L("Infill");
+    def->tooltip = L("Effort spent on ordering the regions of the monotonic infill to shorten the travels between them. "
+                     "Fast orders the regions greedily, Normal and Best search for a shorter ordering within "
+                     "a moderate or a large amount of computation.");
+    def->enum_keys_map = &ConfigOptionEnum<MonotonicQuality>::get_enum_values();
+    def->enum_values.push_back("fast");
+    def->enum_values.push_back("normal");
+    def->enum_values.push_back("best");
+    def->enum_labels.push_back(L("Fast"));
+    def->enum_labels.push_back(L("Normal"));
+    def->enum_labels.push_back(L("Best"));
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionEnum<MonotonicQuality>(MonotonicQuality::Normal));
+
     def = this->add("min_skirt_length", coFloat);
     def->label = L("Minimal filament extrusion length");
     def->tooltip = L("Generate no less than the number of skirt loops required to consume "
@@ -4085,6 +4108,15 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->cli = "slice|s";
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("batch", coBool);
+    def->label = L("Batch slicing");
+    def->tooltip = L("Read slicing jobs from the standard input, one job per line, and slice them one after another "
+                     "in a single process. Each line contains the input files and options of a job with the command line syntax, "
+                     "for example: --load overlay.ini --layer-height 0.1 --output out.gcode model.stl. "
+                     "The print configuration given on the command line is used as a base for all jobs. "
+                     "Models and slicing results are reused between jobs where possible. Only FFF printing is supported.");
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("help", coBool);
     def->label = L("Help");
     def->tooltip = L("Show this help.");
@@ -4248,6 +4280,22 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->label = L("Data directory");
     def->tooltip = L("Load and store settings at the given directory. This is useful for maintaining different profiles or including configurations from a network storage.");
 
+    def = this->add("cache_dir", coString);
+    def->label = L("Object cache directory");
+    def->tooltip = L("Cache the sliced layers, perimeters, infill and supports of each object in the given directory. "
+                     "When the same object is sliced again with the same settings, the cached results are loaded instead of being recalculated. "
+                     "The repaired meshes of the input files are cached in the \"models\" subdirectory, so that unchanged input files are not parsed and repaired again.");
+
+    def = this->add("step_stats", coString);
+    def->label = L("Export step statistics");
+    def->tooltip = L("Export the wall time, CPU time, memory usage and the number of layers, polygons and extrusions "
+                     "of each slicing step of the print and its objects into the given JSON file.");
+
+    def = this->add("step_trace", coString);
+    def->label = L("Export step trace");
+    def->tooltip = L("Export the slicing steps of the print and its objects into the given file in the Chrome trace event format, "
+                     "which may be viewed with chrome://tracing or https://ui.perfetto.dev.");
+
     def = this->add("loglevel", coInt);
     def->label = L("Logging level");
     def->tooltip = L("Sets logging sensitivity. 0:fatal, 1:error, 2:warning, 3:info, 4:debug, 5:trace\n"
@@ -69,6 +69,17 @@ enum class IroningType {
     Count,
 };
 
+// Effort spent on ordering the regions of the monotonic infill.
+enum class MonotonicQuality {
+    // Greedy ordering only.
+    Fast,
+    // Ant colony optimization within a moderate budget.
+    Normal,
+    // Ant colony optimization with more ants and rounds within a large budget.
+    Best,
+    Count,
+};
+
 enum class SlicingMode
 {
     // Regular, applying ClipperLib::pftNonZero rule when creating ExPolygons.
@@ -137,6 +148,7 @@ CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(AuthorizationType)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(FuzzySkinType)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(InfillPattern)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(IroningType)
+CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(MonotonicQuality)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(SlicingMode)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(SupportMaterialPattern)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(SupportMaterialStyle)
@@ -544,6 +556,7 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionPercent,              ironing_flowrate))
     ((ConfigOptionFloat,                ironing_spacing))
     ((ConfigOptionFloat,                ironing_speed))
+    ((ConfigOptionEnum<MonotonicQuality>, monotonic_infill_quality))
     // Detect bridging perimeters
     ((ConfigOptionBool,                 overhangs))
     ((ConfigOptionInt,                  perimeter_extruder))
@@ -149,6 +149,8 @@ void PrintObject::make_perimeters()
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size() - 1),
             [this, &region, region_id](const tbb::blocked_range<size_t>& range) {
+                // Clipper working data of these layers is allocated from a memory arena of this thread.
+                ClipperLib::ArenaScope clipper_arena;
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
                     LayerRegion &layerm                     = *m_layers[layer_idx]->get_region(region_id);
@@ -207,6 +209,7 @@ void PrintObject::make_perimeters()
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
         [this](const tbb::blocked_range<size_t>& range) {
+            ClipperLib::ArenaScope clipper_arena;
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
                 m_layers[layer_idx]->make_perimeters();
@@ -340,6 +343,7 @@ void PrintObject::infill()
     this->prepare_infill();
 
     if (this->set_started(posInfill)) {
+        m_print->set_status(70, L("Infilling layers"));
         auto [adaptive_fill_octree, support_fill_octree] = this->prepare_adaptive_infill_data();
 
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
@@ -459,6 +463,48 @@ std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare
         support_line_spacing  ? build_octree(mesh, overhangs.front(), support_line_spacing, true) : OctreePtr());
 }
 
+void PrintObject::step_stats_output(int step, PrintStepStats &stats) const
+{
+    switch (PrintObjectStep(step)) {
+    case posSlice:
+        stats.layers = m_layers.size();
+        for (const Layer *layer : m_layers)
+            for (const LayerRegion *layerm : layer->regions())
+                stats.polygons += layerm->slices.size();
+        break;
+    case posPerimeters:
+        stats.layers = m_layers.size();
+        for (const Layer *layer : m_layers)
+            for (const LayerRegion *layerm : layer->regions()) {
+                stats.polygons   += layerm->fill_surfaces.size();
+                stats.extrusions += layerm->perimeters.items_count() + layerm->thin_fills.items_count();
+            }
+        break;
+    case posPrepareInfill:
+        stats.layers = m_layers.size();
+        for (const Layer *layer : m_layers)
+            for (const LayerRegion *layerm : layer->regions())
+                stats.polygons += layerm->fill_surfaces.size();
+        break;
+    case posInfill:
+    case posIroning:
+        stats.layers = m_layers.size();
+        for (const Layer *layer : m_layers)
+            for (const LayerRegion *layerm : layer->regions())
+                stats.extrusions += layerm->fills.items_count();
+        break;
+    case posSupportMaterial:
+        stats.layers = m_support_layers.size();
+        for (const SupportLayer *layer : m_support_layers) {
+            stats.polygons   += layer->support_islands.expolygons.size();
+            stats.extrusions += layer->support_fills.items_count();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 void PrintObject::clear_layers()
 {
     for (Layer *l : m_layers)
@@ -598,6 +644,7 @@ bool PrintObject::invalidate_state_by_config_options(
             || opt_key == "fill_pattern"
             || opt_key == "infill_anchor"
             || opt_key == "infill_anchor_max"
+            || opt_key == "monotonic_infill_quality"
             || opt_key == "top_infill_extrusion_width"
             || opt_key == "first_layer_extrusion_width") {
             steps.emplace_back(posInfill);
@@ -1044,6 +1091,7 @@ void PrintObject::discover_vertical_shells()
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, num_layers, grain_size),
             [this, &cache_top_botom_regions](const tbb::blocked_range<size_t>& range) {
+                ClipperLib::ArenaScope clipper_arena;
                 const SurfaceType surfaces_bottom[2] = { stBottom, stBottomBridge };
                 const size_t num_regions = this->num_printing_regions();
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
@@ -1127,6 +1175,7 @@ void PrintObject::discover_vertical_shells()
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, num_layers, grain_size),
                 [this, region_id, &cache_top_botom_regions](const tbb::blocked_range<size_t>& range) {
+                    ClipperLib::ArenaScope clipper_arena;
                     const SurfaceType surfaces_bottom[2] = { stBottom, stBottomBridge };
                     for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
                         m_print->throw_if_canceled();
@@ -1156,6 +1205,7 @@ void PrintObject::discover_vertical_shells()
             tbb::blocked_range<size_t>(0, num_layers, grain_size),
             [this, region_id, &cache_top_botom_regions]
             (const tbb::blocked_range<size_t>& range) {
+                ClipperLib::ArenaScope clipper_arena;
                 // printf("discover_vertical_shells from %d to %d\n", range.begin(), range.end());
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
                     PROFILE_BLOCK(discover_vertical_shells_region_layer);
@@ -0,0 +1,391 @@
+#include "CacheFile.hpp"
+#include "Exception.hpp"
+#include "Layer.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+#include "Utils.hpp"
+#include "libslic3r_version.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/trivial.hpp>
+
+// On disk cache of the PrintObject steps posSlice .. posSupportMaterial.
+// The command line slicer slicing the same objects with the same settings over and over
+// (for example when batch processing many variants of a plate) loads the layers and extrusions
+// from the cache instead of recalculating them.
+
+namespace Slic3r {
+
+// Increase whenever the layout of the cache file or the data generated by the PrintObject steps changes.
+static constexpr const uint32_t PRINT_OBJECT_CACHE_VERSION = 2;
+static constexpr const char     PRINT_OBJECT_CACHE_MAGIC[4] = { 'P', 'S', 'O', 'C' };
+
+namespace {
+
+void hash_facets(CacheHasher &hasher, const FacetsAnnotation &facets)
+{
+    const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data = facets.get_data();
+    hasher.vector(data.first);
+    hasher.pod(data.second.size());
+    for (bool b : data.second)
+        hasher.pod(b);
+}
+
+// Extends the plain cache file writer with the geometry and extrusion entities.
+class CacheWriter : public CacheFileWriter
+{
+public:
+    explicit CacheWriter(const CacheFileWriter &out) : CacheFileWriter(out) {}
+
+    void points(const Points &pts) { this->vector(pts); }
+    void polygons(const Polygons &polygons) { this->count(polygons.size()); for (const Polygon &p : polygons) this->points(p.points); }
+    void polylines(const Polylines &polylines) { this->count(polylines.size()); for (const Polyline &p : polylines) this->points(p.points); }
+    void expolygon(const ExPolygon &expoly) { this->points(expoly.contour.points); this->polygons(expoly.holes); }
+    void expolygons(const ExPolygons &expolys) { this->count(expolys.size()); for (const ExPolygon &e : expolys) this->expolygon(e); }
+    void surfaces(const SurfaceCollection &surfaces) {
+        this->count(surfaces.surfaces.size());
+        for (const Surface &s : surfaces.surfaces) {
+            this->pod(s.surface_type);
+            this->expolygon(s.expolygon);
+            this->pod(s.thickness);
+            this->pod(s.thickness_layers);
+            this->pod(s.bridge_angle);
+            this->pod(s.extra_perimeters);
+        }
+    }
+    void path(const ExtrusionPath &path) {
+        this->pod(path.role());
+        this->pod(path.mm3_per_mm);
+        this->pod(path.width);
+        this->pod(path.height);
+        this->points(path.polyline.points);
+    }
+    void paths(const ExtrusionPaths &paths) { this->count(paths.size()); for (const ExtrusionPath &p : paths) this->path(p); }
+    void entities(const ExtrusionEntityCollection &collection) {
+        this->pod(collection.no_sort);
+        this->count(collection.entities.size());
+        for (const ExtrusionEntity *entity : collection.entities) {
+            if (const auto *path = dynamic_cast<const ExtrusionPath*>(entity); path) {
+                this->pod(uint8_t(EntityPath));
+                this->path(*path);
+            } else if (const auto *multipath = dynamic_cast<const ExtrusionMultiPath*>(entity); multipath) {
+                this->pod(uint8_t(EntityMultiPath));
+                this->paths(multipath->paths);
+            } else if (const auto *loop = dynamic_cast<const ExtrusionLoop*>(entity); loop) {
+                this->pod(uint8_t(EntityLoop));
+                this->pod(loop->loop_role());
+                this->paths(loop->paths);
+            } else if (const auto *child = dynamic_cast<const ExtrusionEntityCollection*>(entity); child) {
+                this->pod(uint8_t(EntityCollection));
+                this->entities(*child);
+            } else
+                throw Slic3r::RuntimeError("Unknown extrusion entity type, it cannot be stored into the object cache");
+        }
+    }
+
+    enum EntityType : uint8_t {
+        EntityPath,
+        EntityMultiPath,
+        EntityLoop,
+        EntityCollection,
+    };
+};
+
+class CacheReader : public CacheFileReader
+{
+public:
+    explicit CacheReader(const CacheFileReader &in) : CacheFileReader(in) {}
+
+    void points(Points &pts) { this->vector(pts); }
+    void polygons(Polygons &polygons) { polygons.assign(this->count(), Polygon()); for (Polygon &p : polygons) this->points(p.points); }
+    void polylines(Polylines &polylines) { polylines.assign(this->count(), Polyline()); for (Polyline &p : polylines) this->points(p.points); }
+    void expolygon(ExPolygon &expoly) { this->points(expoly.contour.points); this->polygons(expoly.holes); }
+    void expolygons(ExPolygons &expolys) { expolys.assign(this->count(), ExPolygon()); for (ExPolygon &e : expolys) this->expolygon(e); }
+    void surfaces(SurfaceCollection &surfaces) {
+        surfaces.surfaces.clear();
+        size_t n = this->count();
+        surfaces.surfaces.reserve(n);
+        for (size_t i = 0; i < n; ++ i) {
+            auto surface_type = this->pod<SurfaceType>();
+            ExPolygon expoly;
+            this->expolygon(expoly);
+            Surface &s = surfaces.surfaces.emplace_back(surface_type, std::move(expoly));
+            this->pod(s.thickness);
+            this->pod(s.thickness_layers);
+            this->pod(s.bridge_angle);
+            this->pod(s.extra_perimeters);
+        }
+    }
+    ExtrusionPath path() {
+        auto  role       = this->pod<ExtrusionRole>();
+        auto  mm3_per_mm = this->pod<double>();
+        auto  width      = this->pod<float>();
+        auto  height     = this->pod<float>();
+        ExtrusionPath out(role, mm3_per_mm, width, height);
+        this->points(out.polyline.points);
+        return out;
+    }
+    void paths(ExtrusionPaths &paths) {
+        size_t n = this->count();
+        paths.clear();
+        paths.reserve(n);
+        for (size_t i = 0; i < n; ++ i)
+            paths.emplace_back(this->path());
+    }
+    void entities(ExtrusionEntityCollection &collection) {
+        collection.clear();
+        this->pod(collection.no_sort);
+        size_t n = this->count();
+        collection.entities.reserve(n);
+        for (size_t i = 0; i < n; ++ i) {
+            switch (this->pod<uint8_t>()) {
+            case CacheWriter::EntityPath:
+                collection.entities.emplace_back(new ExtrusionPath(this->path()));
+                break;
+            case CacheWriter::EntityMultiPath:
+            {
+                auto *multipath = new ExtrusionMultiPath();
+                collection.entities.emplace_back(multipath);
+                this->paths(multipath->paths);
+                break;
+            }
+            case CacheWriter::EntityLoop:
+            {
+                auto *loop = new ExtrusionLoop(this->pod<ExtrusionLoopRole>());
+                collection.entities.emplace_back(loop);
+                this->paths(loop->paths);
+                break;
+            }
+            case CacheWriter::EntityCollection:
+            {
+                auto *child = new ExtrusionEntityCollection();
+                collection.entities.emplace_back(child);
+                this->entities(*child);
+                break;
+            }
+            default:
+                throw Slic3r::RuntimeError("Corrupted object cache file");
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
+std::string PrintObject::cache_key() const
+{
+    CacheHasher hasher;
+    hasher.string(SLIC3R_BUILD_ID);
+    hasher.pod(PRINT_OBJECT_CACHE_VERSION);
+
+    // Geometry and per volume settings. The volumes are hashed in the order of the ModelObject,
+    // which is the order the regions are assigned in.
+    const ModelObject &model_object = *this->model_object();
+    for (const ModelVolume *volume : model_object.volumes) {
+        hasher.pod(volume->type());
+        const indexed_triangle_set &its = volume->mesh().its;
+        hasher.vector(its.vertices);
+        hasher.vector(its.indices);
+        hasher.process(volume->get_matrix().data(), sizeof(double) * 16);
+        hasher.config(volume->config.get());
+        hash_facets(hasher, volume->supported_facets);
+        hash_facets(hasher, volume->seam_facets);
+        hash_facets(hasher, volume->mmu_segmentation_facets);
+    }
+    hasher.vector(model_object.layer_height_profile.get());
+
+    // Placement of the object in the print.
+    hasher.process(m_trafo.data(), sizeof(double) * 16);
+    hasher.process(m_center_offset.data(), sizeof(coord_t) * 2);
+    hasher.process(m_size.data(), sizeof(coord_t) * 3);
+
+    // Resolved settings of the object and of its regions, including the layer range modifiers.
+    hasher.config(m_config);
+    for (const std::unique_ptr<PrintRegion> &region : m_shared_regions->all_regions) {
+        hasher.pod(region->print_object_region_id());
+        hasher.config(region->config());
+    }
+    // Z extents of the layer range modifiers and the regions they map to. Moving or resizing a range
+    // with the same settings does not change the region configs hashed above.
+    hasher.pod(m_shared_regions->layer_ranges.size());
+    for (const PrintObjectRegions::LayerRangeRegions &range : m_shared_regions->layer_ranges) {
+        hasher.pod(range.layer_height_range.first);
+        hasher.pod(range.layer_height_range.second);
+        hasher.pod(range.volume_regions.size());
+        for (const PrintObjectRegions::VolumeRegion &region : range.volume_regions)
+            hasher.pod(region.region == nullptr ? -1 : region.region->print_object_region_id());
+        hasher.pod(range.painted_regions.size());
+        for (const PrintObjectRegions::PaintedRegion &region : range.painted_regions)
+            hasher.pod(region.region->print_object_region_id());
+    }
+    // Print wide settings, which invalidate the PrintObject steps, see Print::invalidate_state_by_config_options()
+    // and the slicing parameters.
+    hasher.config(m_print->config(), {
+        "nozzle_diameter", "resolution", "spiral_vase", "filament_soluble", "first_layer_height",
+        "first_layer_extrusion_width", "min_layer_height", "max_layer_height"
+    });
+    return hasher.hex_digest();
+}
+
+static std::string print_object_cache_path(const std::string &cache_dir, const std::string &key)
+{
+    return (boost::filesystem::path(cache_dir) / (key + ".bin")).string();
+}
+
+void PrintObject::save_to_cache(const std::string &cache_dir) const
+{
+    const std::string key      = this->cache_key();
+    const std::string path     = print_object_cache_path(cache_dir, key);
+    try {
+        write_cache_file(path, [this, &key](CacheFileWriter &file) {
+            CacheWriter out(file);
+            out.write(PRINT_OBJECT_CACHE_MAGIC, sizeof(PRINT_OBJECT_CACHE_MAGIC));
+            out.pod(PRINT_OBJECT_CACHE_VERSION);
+            out.string(key);
+            out.pod(m_typed_slices);
+            out.count(m_layers.size());
+            for (const Layer *layer : m_layers) {
+                out.pod(uint64_t(layer->id()));
+                out.pod(layer->height);
+                out.pod(layer->print_z);
+                out.pod(layer->slice_z);
+                out.pod(layer->slicing_errors);
+                out.expolygons(layer->lslices);
+                out.count(layer->regions().size());
+                for (const LayerRegion *layerm : layer->regions()) {
+                    out.pod(int32_t(layerm->region().print_object_region_id()));
+                    out.surfaces(layerm->slices);
+                    out.expolygons(layerm->raw_slices);
+                    out.entities(layerm->thin_fills);
+                    out.expolygons(layerm->fill_expolygons);
+                    out.surfaces(layerm->fill_surfaces);
+                    out.polylines(layerm->unsupported_bridge_edges);
+                    out.entities(layerm->perimeters);
+                    out.entities(layerm->fills);
+                }
+            }
+            out.count(m_support_layers.size());
+            for (const SupportLayer *layer : m_support_layers) {
+                out.pod(uint64_t(layer->id()));
+                out.pod(layer->height);
+                out.pod(layer->print_z);
+                out.pod(layer->slice_z);
+                out.expolygons(layer->support_islands.expolygons);
+                out.entities(layer->support_fills);
+            }
+            out.write(PRINT_OBJECT_CACHE_MAGIC, sizeof(PRINT_OBJECT_CACHE_MAGIC));
+        });
+        BOOST_LOG_TRIVIAL(info) << "Object " << this->model_object()->name << " stored into the object cache " << path;
+    } catch (const std::exception &ex) {
+        // Failing to store the cache is not fatal.
+        BOOST_LOG_TRIVIAL(error) << "Failed storing object " << this->model_object()->name << " into the object cache: " << ex.what();
+    }
+}
+
+bool PrintObject::load_from_cache(const std::string &cache_dir)
+{
+    const std::string key  = this->cache_key();
+    const std::string path = print_object_cache_path(cache_dir, key);
+    if (! boost::filesystem::exists(path))
+        return false;
+
+    LayerPtrs        layers;
+    SupportLayerPtrs support_layers;
+    bool             typed_slices = false;
+    auto release = [&layers, &support_layers]() {
+        for (Layer *l : layers)
+            delete l;
+        for (SupportLayer *l : support_layers)
+            delete l;
+    };
+    try {
+        read_cache_file(path, [this, &key, &layers, &support_layers, &typed_slices](CacheFileReader &file) {
+            CacheReader in(file);
+            in.magic(PRINT_OBJECT_CACHE_MAGIC, sizeof(PRINT_OBJECT_CACHE_MAGIC));
+            if (in.pod<uint32_t>() != PRINT_OBJECT_CACHE_VERSION || in.string() != key)
+                throw Slic3r::RuntimeError("Cache file version or key mismatch");
+            in.pod(typed_slices);
+            size_t num_layers = in.count();
+            layers.reserve(num_layers);
+            for (size_t i = 0; i < num_layers; ++ i) {
+                auto id      = in.pod<uint64_t>();
+                auto height  = in.pod<coordf_t>();
+                auto print_z = in.pod<coordf_t>();
+                auto slice_z = in.pod<coordf_t>();
+                Layer *layer = layers.emplace_back(new Layer(size_t(id), this, height, print_z, slice_z));
+                if (layers.size() > 1) {
+                    Layer *prev = layers[layers.size() - 2];
+                    prev->upper_layer  = layer;
+                    layer->lower_layer = prev;
+                }
+                in.pod(layer->slicing_errors);
+                in.expolygons(layer->lslices);
+                layer->lslices_bboxes.reserve(layer->lslices.size());
+                for (const ExPolygon &expoly : layer->lslices)
+                    layer->lslices_bboxes.emplace_back(get_extents(expoly));
+                size_t num_regions = in.count();
+                for (size_t j = 0; j < num_regions; ++ j) {
+                    auto region_id = in.pod<int32_t>();
+                    if (region_id < 0 || size_t(region_id) >= m_shared_regions->all_regions.size() ||
+                        m_shared_regions->all_regions[region_id]->print_object_region_id() != region_id)
+                        throw Slic3r::RuntimeError("Region mismatch");
+                    LayerRegion *layerm = layer->add_region(m_shared_regions->all_regions[region_id].get());
+                    in.surfaces(layerm->slices);
+                    in.expolygons(layerm->raw_slices);
+                    in.entities(layerm->thin_fills);
+                    in.expolygons(layerm->fill_expolygons);
+                    in.surfaces(layerm->fill_surfaces);
+                    in.polylines(layerm->unsupported_bridge_edges);
+                    in.entities(layerm->perimeters);
+                    in.entities(layerm->fills);
+                }
+            }
+            size_t num_support_layers = in.count();
+            support_layers.reserve(num_support_layers);
+            for (size_t i = 0; i < num_support_layers; ++ i) {
+                auto id      = in.pod<uint64_t>();
+                auto height  = in.pod<coordf_t>();
+                auto print_z = in.pod<coordf_t>();
+                auto slice_z = in.pod<coordf_t>();
+                SupportLayer *layer = support_layers.emplace_back(new SupportLayer(size_t(id), this, height, print_z, slice_z));
+                in.expolygons(layer->support_islands.expolygons);
+                in.entities(layer->support_fills);
+            }
+            in.magic(PRINT_OBJECT_CACHE_MAGIC, sizeof(PRINT_OBJECT_CACHE_MAGIC));
+        });
+    } catch (const std::exception &ex) {
+        release();
+        BOOST_LOG_TRIVIAL(error) << "Failed loading object " << this->model_object()->name << " from the object cache " << path << ": " << ex.what();
+        return false;
+    }
+
+    if (layers.empty()) {
+        release();
+        return false;
+    }
+
+    // Install the cached data, marking the steps as done the same way the steps themselves would do.
+    for (int istep = int(posSlice); istep < int(posCount); ++ istep) {
+        auto step = PrintObjectStep(istep);
+        if (! this->set_started(step))
+            continue;
+        if (step == posSlice) {
+            this->clear_layers();
+            m_layers       = std::move(layers);
+            m_typed_slices = typed_slices;
+            layers.clear();
+        } else if (step == posSupportMaterial) {
+            this->clear_support_layers();
+            m_support_layers = std::move(support_layers);
+            support_layers.clear();
+        }
+        this->set_done(step);
+    }
+    // Release whatever was not installed, if some of the steps were already done.
+    release();
+    BOOST_LOG_TRIVIAL(info) << "Object " << this->model_object()->name << " loaded from the object cache " << path;
+    return true;
+}
+
+} // namespace Slic3r
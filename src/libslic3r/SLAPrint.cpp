@@ -877,6 +877,29 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
     return invalidated;
 }
 
+const char* SLAPrint::step_name(int step) const
+{
+    switch (SLAPrintStep(step)) {
+    case slapsMergeSlicesAndEval:   return "slapsMergeSlicesAndEval";
+    case slapsRasterize:            return "slapsRasterize";
+    default:                        return "";
+    }
+}
+
+const char* SLAPrint::object_step_name(int step) const
+{
+    switch (SLAPrintObjectStep(step)) {
+    case slaposHollowing:       return "slaposHollowing";
+    case slaposDrillHoles:      return "slaposDrillHoles";
+    case slaposObjectSlice:     return "slaposObjectSlice";
+    case slaposSupportPoints:   return "slaposSupportPoints";
+    case slaposSupportTree:     return "slaposSupportTree";
+    case slaposPad:             return "slaposPad";
+    case slaposSliceSupports:   return "slaposSliceSupports";
+    default:                    return "";
+    }
+}
+
 // Returns true if an object step is done on all objects and there's at least one object.
 bool SLAPrint::is_step_done(SLAPrintObjectStep step) const
 {
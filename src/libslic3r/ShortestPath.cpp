@@ -13,12 +13,166 @@
 #include <cmath>
 #include <cassert>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
+// Uniform grid over end points of segments to be chained, used instead of a KD tree for large numbers of segments.
+// Contrary to the KD tree, end points are removed from the grid once they are connected, thus the closest point queries
+// do not slow down by skipping the already connected end points. The grid is built by a counting sort in a linear time
+// and its memory is reused by the following builds.
+class ChainEndPointGrid
+{
+public:
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	template<typename EndPointType>
+	void build(const std::vector<EndPointType> &end_points)
+	{
+		assert(! end_points.empty());
+		Vec2d pmin = end_points.front().pos;
+		Vec2d pmax = pmin;
+		for (const EndPointType &ep : end_points) {
+			pmin = pmin.cwiseMin(ep.pos);
+			pmax = pmax.cwiseMax(ep.pos);
+		}
+		// Aim at two end points per cell, also for degenerate (collinear) distributions of the end points.
+		const Vec2d  size = pmax - pmin;
+		const double n    = double(end_points.size());
+		m_cell_size       = std::max(std::max(std::sqrt(2. * size.x() * size.y() / n), 2. * std::max(size.x(), size.y()) / n), 1.);
+		m_origin          = pmin;
+		m_cols            = size_t(size.x() / m_cell_size) + 1;
+		m_rows            = size_t(size.y() / m_cell_size) + 1;
+
+		m_cell_of.resize(end_points.size());
+		m_cell_begin.assign(m_cols * m_rows + 1, 0);
+		for (size_t i = 0; i < end_points.size(); ++ i) {
+			Vec2i64 c = this->cell_coord(end_points[i].pos);
+			m_cell_of[i] = c.y() * m_cols + c.x();
+			++ m_cell_begin[m_cell_of[i] + 1];
+		}
+		for (size_t i = 1; i < m_cell_begin.size(); ++ i)
+			m_cell_begin[i] += m_cell_begin[i - 1];
+		m_cell_end.assign(m_cell_begin.begin(), m_cell_begin.end() - 1);
+		m_points.resize(end_points.size());
+		m_pos.resize(end_points.size());
+		m_slot.resize(end_points.size());
+		for (size_t i = 0; i < end_points.size(); ++ i) {
+			size_t slot = m_cell_end[m_cell_of[i]] ++;
+			m_points[slot] = i;
+			m_pos[slot]    = end_points[i].pos;
+			m_slot[i]      = slot;
+		}
+	}
+
+	// Remove an end point from the grid, it will not be returned by find_closest_point() anymore.
+	void remove(size_t idx)
+	{
+		size_t cell = m_cell_of[idx];
+		size_t slot = m_slot[idx];
+		assert(slot >= m_cell_begin[cell] && slot < m_cell_end[cell]);
+		size_t last = -- m_cell_end[cell];
+		m_points[slot]         = m_points[last];
+		m_pos[slot]            = m_pos[last];
+		m_slot[m_points[slot]] = slot;
+		m_points[last]         = idx;
+		m_slot[idx]            = last;
+	}
+
+	// Find the closest end point remaining in the grid, which passes the filter. Returns npos if not found.
+	template<typename FilterFn>
+	size_t find_closest_point(const Vec2d &pt, FilterFn filter) const
+	{
+		const Vec2i64 c         = this->cell_coord(pt);
+		const int64_t cols      = int64_t(m_cols);
+		const int64_t rows      = int64_t(m_rows);
+		size_t        min_idx   = npos;
+		double        min_dist2 = std::numeric_limits<double>::max();
+		auto visit_cell = [this, &pt, &filter, &min_idx, &min_dist2](int64_t x, int64_t y) {
+			size_t cell = size_t(y) * m_cols + size_t(x);
+			for (size_t slot = m_cell_begin[cell]; slot < m_cell_end[cell]; ++ slot) {
+				double dist2 = (m_pos[slot] - pt).squaredNorm();
+				if (dist2 < min_dist2 && filter(m_points[slot])) {
+					min_dist2 = dist2;
+					min_idx   = m_points[slot];
+				}
+			}
+		};
+		// pt may lie far outside of the grid, start with the first ring touching the grid.
+		const int64_t r_first = std::max(std::max(std::max(- c.x(), c.x() - cols + 1), std::max(- c.y(), c.y() - rows + 1)), int64_t(0));
+		for (int64_t r = r_first;; ++ r) {
+			// Cells in ring r are at least (r - 1) cell sizes away from pt.
+			if (r > 1) {
+				double d = double(r - 1) * m_cell_size;
+				if (d * d >= min_dist2)
+					break;
+			}
+			// Only the part of the ring overlapping the grid is visited.
+			const int64_t xmin = std::max(c.x() - r, int64_t(0));
+			const int64_t xmax = std::min(c.x() + r, cols - 1);
+			const int64_t ymin = std::max(c.y() - r + 1, int64_t(0));
+			const int64_t ymax = std::min(c.y() + r - 1, rows - 1);
+			if (c.y() - r >= 0)
+				for (int64_t x = xmin; x <= xmax; ++ x)
+					visit_cell(x, c.y() - r);
+			if (r > 0 && c.y() + r < rows)
+				for (int64_t x = xmin; x <= xmax; ++ x)
+					visit_cell(x, c.y() + r);
+			if (c.x() - r >= 0)
+				for (int64_t y = ymin; y <= ymax; ++ y)
+					visit_cell(c.x() - r, y);
+			if (r > 0 && c.x() + r < cols)
+				for (int64_t y = ymin; y <= ymax; ++ y)
+					visit_cell(c.x() + r, y);
+			if (c.x() - r <= 0 && c.y() - r <= 0 && c.x() + r >= cols - 1 && c.y() + r >= rows - 1)
+				// All cells visited.
+				break;
+		}
+		return min_idx;
+	}
+
+	// Release memory of a grid built over a huge number of end points, so that the thread local grid
+	// does not hold on to the memory of the largest chaining ever done on its thread.
+	void release_memory_if_larger_than(size_t max_end_points)
+	{
+		if (m_points.capacity() > max_end_points || m_cell_begin.capacity() > max_end_points + 1)
+			*this = ChainEndPointGrid();
+	}
+
+private:
+	// Not clamped to the grid, pt may lie outside of the bounding box of the end points.
+	Vec2i64 cell_coord(const Vec2d &pt) const {
+		Vec2d c = (pt - m_origin) / m_cell_size;
+		return { int64_t(std::floor(c.x())), int64_t(std::floor(c.y())) };
+	}
+
+	Vec2d               m_origin;
+	double              m_cell_size { 1. };
+	size_t              m_cols { 0 };
+	size_t              m_rows { 0 };
+	// Range of slots of a cell is <m_cell_begin[cell], m_cell_end[cell]), removed end points are moved past m_cell_end[cell].
+	std::vector<size_t> m_cell_begin;
+	std::vector<size_t> m_cell_end;
+	// End point index and its position for each slot, sorted by cells.
+	std::vector<size_t> m_points;
+	std::vector<Vec2d>  m_pos;
+	// Slot and cell of each end point.
+	std::vector<size_t> m_slot;
+	std::vector<size_t> m_cell_of;
+};
+
+// Above this number of segments, chain_segments_greedy_constrained_reversals_() indexes the end points
+// with ChainEndPointGrid instead of a KD tree.
+static constexpr size_t chain_grid_min_segments = 1024;
+// Memory of the thread local ChainEndPointGrid is released after chaining more end points than this.
+static constexpr size_t chain_grid_max_retained_end_points = 1 << 20;
+
 // Naive implementation of the Traveling Salesman Problem, it works by always taking the next closest neighbor.
 // This implementation will always produce valid result even if some segments cannot reverse.
-template<typename EndPointType, typename KDTreeType, typename CouldReverseFunc>
-std::vector<std::pair<size_t, bool>> chain_segments_closest_point(std::vector<EndPointType> &end_points, KDTreeType &kdtree, CouldReverseFunc &could_reverse_func, EndPointType &first_point)
+// find_closest_point_func(pos, filter) returns index of the closest end point to pos passing the filter.
+template<typename EndPointType, typename FindClosestPointFunc, typename CouldReverseFunc>
+std::vector<std::pair<size_t, bool>> chain_segments_closest_point(std::vector<EndPointType> &end_points, FindClosestPointFunc &find_closest_point_func, CouldReverseFunc &could_reverse_func, EndPointType &first_point)
 {
 	assert((end_points.size() & 1) == 0);
     size_t num_segments = end_points.size() / 2;
@@ -36,7 +190,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_closest_point(std::vector<En
     	this_point.chain_id = 1;
     	// Find the closest point to this end_point, which lies on a different extrusion path (filtered by the lambda).
     	// Ignore the starting point as the starting point is considered to be occupied, no end point coud connect to it.
-		size_t next_idx = find_closest_point(kdtree, this_point.pos,
+		size_t next_idx = find_closest_point_func(this_point.pos,
 			[this_idx, &end_points, &could_reverse_func](size_t idx) {
 				return (idx ^ this_idx) > 1 && end_points[idx].chain_id == 0 && ((idx & 1) == 0 || could_reverse_func(idx >> 1));
 		});
@@ -100,9 +254,19 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
             end_points.emplace_back(end_point_func(i, false).template cast<double>());
 	    }
 
-	    // Construct the closest point KD tree over end points of segments.
+	    // Construct the closest point KD tree over end points of segments, or a grid for a large number of segments.
 		auto coordinate_fn = [&end_points](size_t idx, size_t dimension) -> double { return end_points[idx].pos[dimension]; };
-		KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn, end_points.size());
+		KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn);
+		// The grid is reused by the following calls on this thread to save the allocations.
+		static thread_local ChainEndPointGrid grid;
+		const bool use_grid = num_segments >= chain_grid_min_segments;
+		if (use_grid)
+			grid.build(end_points);
+		else
+			kdtree.build(end_points.size());
+		auto find_closest = [use_grid, &kdtree](const Vec2d &pos, auto filter) -> size_t {
+			return use_grid ? grid.find_closest_point(pos, filter) : find_closest_point(kdtree, pos, filter);
+		};
 
 		// Helper to detect loops in already connected paths.
 		// Unique chain IDs are assigned to paths. If paths are connected, end points will not have their chain IDs updated, but the chain IDs
@@ -166,7 +330,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 		EndPoint *first_point = nullptr;
 		size_t    first_point_idx = std::numeric_limits<size_t>::max();
 		if (start_near != nullptr) {
-            size_t idx = find_closest_point(kdtree, start_near->template cast<double>(),
+            size_t idx = find_closest(start_near->template cast<double>(),
 				// Don't start with a reverse segment, if flipping of the segment is not allowed.
 				[&could_reverse_func](size_t idx) { return (idx & 1) == 0 || could_reverse_func(idx >> 1); });
 			assert(idx < end_points.size());
@@ -174,6 +338,8 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 			first_point->distance_out = 0.;
 			first_point->chain_id = equivalent_chain.next();
 			first_point_idx = idx;
+			if (use_grid)
+				grid.remove(idx);
 		}
 		EndPoint *initial_point = first_point;
 		EndPoint *last_point = nullptr;
@@ -185,7 +351,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 		    	size_t this_idx = &end_point - &end_points.front();
 		    	// Find the closest point to this end_point, which lies on a different extrusion path (filtered by the lambda).
 		    	// Ignore the starting point as the starting point is considered to be occupied, no end point coud connect to it.
-				size_t next_idx = find_closest_point(kdtree, end_point.pos, 
+				size_t next_idx = find_closest(end_point.pos, 
 					[this_idx, first_point_idx](size_t idx){ return idx != first_point_idx && (idx ^ this_idx) > 1; });
 				assert(next_idx < end_points.size());
 				EndPoint &end_point2 = end_points[next_idx];
@@ -289,6 +455,11 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 								equivalent_chain.merge(end_point1_other_chain_id, end_point2_other_chain_id));
 				end_point1.chain_id = chain_id;
 				end_point2.chain_id = chain_id;
+				if (use_grid) {
+					// Connected end points will never be connected to again.
+					grid.remove(&end_point1 - &end_points.front());
+					grid.remove(&end_point2 - &end_points.front());
+				}
 				assert(validate_graph_and_queue());
 				if (iter == 0) {
 					// Last iteration. There shall be exactly one or two end points waiting to be connected.
@@ -311,7 +482,7 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 		    	// Update edge_out and distance.
 		    	size_t this_idx = &end_point1 - &end_points.front();
 		    	// Find the closest point to this end_point, which lies on a different extrusion path (filtered by the filter lambda).
-				size_t next_idx = find_closest_point(kdtree, end_point1.pos, [&end_points, &equivalent_chain, this_idx](size_t idx) { 
+				size_t next_idx = find_closest(end_point1.pos, [&end_points, &equivalent_chain, this_idx](size_t idx) { 
 			    	assert(end_points[this_idx].edge_out == nullptr);
 			    	assert(end_points[this_idx].chain_id == 0);
 					if ((idx ^ this_idx) <= 1 || end_points[idx].chain_id != 0)
@@ -333,10 +504,13 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 				queue.update(end_point1.heap_idx);
 		    	//FIXME Remove the other end point from the KD tree.
 		    	// As the KD tree update is expensive, do it only after some larger number of points is removed from the queue.
+		    	// ChainEndPointGrid used for large numbers of segments removes the connected end points.
 				assert(validate_graph_and_queue());
 	    	}
 		}
 		assert(queue.empty());
+		if (use_grid)
+			grid.release_memory_if_larger_than(chain_grid_max_retained_end_points);
 
 		// Now interconnect pairs of segments into a chain.
 		assert(first_point != nullptr);
@@ -381,9 +555,13 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 					} while (first_point != nullptr);
 				}
 			}
-			if (failed)
+			if (failed) {
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
-				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+				if (use_grid)
+					// Insert the removed end points back.
+					grid.build(end_points);
+				out = chain_segments_closest_point<EndPoint, decltype(find_closest), CouldReverseFunc>(end_points, find_closest, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+			}
 		} else {
 			assert(! failed);
 		}
@@ -960,9 +1138,11 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 					} while (first_point != nullptr);
 				}
 			}
-			if (failed)
+			if (failed) {
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
-				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+				auto find_closest = [&kdtree](const Vec2d &pos, auto filter) -> size_t { return find_closest_point(kdtree, pos, filter); };
+				out = chain_segments_closest_point<EndPoint, decltype(find_closest), CouldReverseFunc>(end_points, find_closest, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+			}
 		} else {
 			assert(! failed);
 		}
@@ -998,11 +1178,15 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy2(SegmentEndPointFunc
 	return chain_segments_greedy_constrained_reversals2_<PointType, SegmentEndPointFunc, false, decltype(could_reverse_func)>(end_point_func, could_reverse_func, num_segments, start_near);
 }
 
-std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near)
+static void improve_ordering_of_extrusion_entities_by_two_exchanges(const std::vector<ExtrusionEntity*> &entities, std::vector<std::pair<size_t, bool>> &chain, bool fixed_start, size_t max_evaluations);
+
+std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near, size_t two_opt_max_evaluations)
 {
 	auto segment_end_point = [&entities](size_t idx, bool first_point) -> const Point& { return first_point ? entities[idx]->first_point() : entities[idx]->last_point(); };
 	auto could_reverse = [&entities](size_t idx) { const ExtrusionEntity *ee = entities[idx]; return ee->is_loop() || ee->can_reverse(); };
 	std::vector<std::pair<size_t, bool>> out = chain_segments_greedy_constrained_reversals<Point, decltype(segment_end_point), decltype(could_reverse)>(segment_end_point, could_reverse, entities.size(), start_near);
+	if (two_opt_max_evaluations > 0 && out.size() > 2)
+		improve_ordering_of_extrusion_entities_by_two_exchanges(entities, out, start_near != nullptr, two_opt_max_evaluations);
 	for (std::pair<size_t, bool> &segment : out) {
 		ExtrusionEntity *ee = entities[segment.first];
 		if (ee->is_loop())
@@ -1028,9 +1212,19 @@ void reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const s
     entities.swap(out);
 }
 
-void chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near)
+void chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near, size_t two_opt_max_evaluations)
+{
+	reorder_extrusion_entities(entities, chain_extrusion_entities(entities, start_near, two_opt_max_evaluations));
+}
+
+void chain_and_reorder_extrusion_entities_parallel(const std::vector<ExtrusionEntitiesPtr*> &collections, const Points &start_near, size_t two_opt_max_evaluations)
 {
-	reorder_extrusion_entities(entities, chain_extrusion_entities(entities, start_near));
+	assert(start_near.empty() || start_near.size() == collections.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, collections.size()),
+		[&collections, &start_near, two_opt_max_evaluations](const tbb::blocked_range<size_t> &range) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				chain_and_reorder_extrusion_entities(*collections[i], start_near.empty() ? nullptr : &start_near[i], two_opt_max_evaluations);
+		});
 }
 
 std::vector<std::pair<size_t, bool>> chain_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, const Point *start_near)
@@ -1273,12 +1467,22 @@ struct ConnectionCost {
 };
 static inline ConnectionCost operator-(const ConnectionCost &lhs, const ConnectionCost& rhs) { return ConnectionCost(lhs.cost - rhs.cost, lhs.cost_flipped - rhs.cost_flipped); }
 
+// Constraints of a crossover of three spans: The first span may have to stay at the start of the chain with its orientation kept,
+// a span containing edges, which cannot be flipped, may be moved, but its edges have to keep their orientation.
+struct CrossoverConstraints {
+	bool	fixed_start = false;
+	bool	can_flip1 = true;
+	bool	can_flip2 = true;
+	bool	can_flip3 = true;
+};
+
 static inline std::pair<double, size_t> minimum_crossover_cost(
 	const std::vector<FlipEdge>		  &edges,
 	const std::pair<size_t, size_t>   &span1, const ConnectionCost &cost1,
 	const std::pair<size_t, size_t>   &span2, const ConnectionCost &cost2,
 	const std::pair<size_t, size_t>   &span3, const ConnectionCost &cost3,
-	const double					   cost_current)
+	const double					   cost_current,
+	const CrossoverConstraints 		  &constraints = CrossoverConstraints())
 {
 	auto connection_cost = [&edges](
 		const std::pair<size_t, size_t> &span1, const ConnectionCost &cost1, bool reversed1, bool flipped1,
@@ -1315,6 +1519,14 @@ static inline std::pair<double, size_t> minimum_crossover_cost(
 	}
 #endif /* NDEBUG */
 
+	// Edges of a span are flipped by do_crossover() if the span is either reversed or flipped, but not both.
+	auto flips_valid = [](size_t i, bool can_flip_a, bool can_flip_b, bool can_flip_c) {
+		return (can_flip_a || ((i & 1) != 0) == ((i & (1 << 1)) != 0)) &&
+			   (can_flip_b || ((i & (1 << 2)) != 0) == ((i & (1 << 3)) != 0)) &&
+			   (can_flip_c || ((i & (1 << 4)) != 0) == ((i & (1 << 5)) != 0));
+	};
+	const bool constrained = constraints.fixed_start || ! constraints.can_flip1 || ! constraints.can_flip2 || ! constraints.can_flip3;
+
 	double cost_min = cost_current;
 	size_t flip_min = 0; // no flip, no improvement
 	for (size_t i = 0; i < (1 << 6); ++ i) {
@@ -1323,6 +1535,16 @@ static inline std::pair<double, size_t> minimum_crossover_cost(
 			        connection_cost(span1, cost1, (i & 1) != 0, (i & (1 << 1)) != 0, span2, cost2, (i & (1 << 2)) != 0, (i & (1 << 3)) != 0, span3, cost3, (i & (1 << 4)) != 0, (i & (1 << 5)) != 0);
 		double c2 = connection_cost(span1, cost1, (i & 1) != 0, (i & (1 << 1)) != 0, span3, cost3, (i & (1 << 2)) != 0, (i & (1 << 3)) != 0, span2, cost2, (i & (1 << 4)) != 0, (i & (1 << 5)) != 0);
 		double c3 = connection_cost(span2, cost2, (i & 1) != 0, (i & (1 << 1)) != 0, span1, cost1, (i & (1 << 2)) != 0, (i & (1 << 3)) != 0, span3, cost3, (i & (1 << 4)) != 0, (i & (1 << 5)) != 0);
+		if (constrained) {
+			// The first span stays first, not reversed and not flipped.
+			bool start_valid = ! constraints.fixed_start || (i & 3) == 0;
+			if (! start_valid || ! flips_valid(i, constraints.can_flip1, constraints.can_flip2, constraints.can_flip3))
+				c1 = std::numeric_limits<double>::max();
+			if (! start_valid || ! flips_valid(i, constraints.can_flip1, constraints.can_flip3, constraints.can_flip2))
+				c2 = std::numeric_limits<double>::max();
+			if (constraints.fixed_start || ! flips_valid(i, constraints.can_flip2, constraints.can_flip1, constraints.can_flip3))
+				c3 = std::numeric_limits<double>::max();
+		}
 		if (c1 < cost_min) {
 			cost_min = c1;
 			flip_min = i;
@@ -1532,12 +1754,19 @@ static inline void do_crossover(const std::vector<FlipEdge> &edges_in, std::vect
 }
 #endif
 
+// Budget of crossovers evaluated by chain_polylines(), bounding the quadratic time complexity of the 2-opt for large numbers of polylines.
+static constexpr size_t chain_two_opt_max_evaluations = 1 << 20;
+
 // Worst time complexity:    O(min(n, 100) * (n * log n + n^2)
 // Expected time complexity: O(min(n, 100) * (n * log n + k * n)
 // where n is the number of edges and k is the number of connection_lengths candidates after the first one
 // is found that improves the total cost.
+// The optimization stops after max_evaluations crossovers were evaluated, keeping the improvements found so far.
+// If fixed_start is set, the first edge stays first with its orientation. If could_flip is provided, it is indexed by FlipEdge::source_index
+// and the edges marked false keep their orientation.
 //FIXME there are likley better heuristics to lower the time complexity.
-static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<FlipEdge> &edges)
+static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<FlipEdge> &edges, 
+	size_t max_evaluations = std::numeric_limits<size_t>::max(), bool fixed_start = false, const std::vector<unsigned char> *could_flip = nullptr)
 {
 	if (edges.size() < 2)
 		return;
@@ -1546,8 +1775,17 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
 	std::vector<FlipEdge> 					edges_tmp(edges);
 	std::vector<std::pair<double, size_t>>	connection_lengths(edges.size() - 1, std::pair<double, size_t>(0., 0));
 	std::vector<char>						connection_tried(edges.size(), false);
+	// Number of edges, which cannot be flipped, before the i-th edge.
+	std::vector<size_t>						num_fixed_edges;
 	const size_t 							max_iterations = std::min(edges.size(), size_t(100));
-	for (size_t iter = 0; iter < max_iterations; ++ iter) {
+	size_t 									num_evaluations = 0;
+	for (size_t iter = 0; iter < max_iterations && num_evaluations < max_evaluations; ++ iter) {
+		if (could_flip != nullptr) {
+			num_fixed_edges.assign(1, 0);
+			for (const FlipEdge &edge : edges)
+				num_fixed_edges.emplace_back(num_fixed_edges.back() + ((*could_flip)[edge.source_index] ? 0 : 1));
+		}
+		auto can_flip = [could_flip, &num_fixed_edges](size_t begin, size_t end) { return could_flip == nullptr || num_fixed_edges[end] == num_fixed_edges[begin]; };
 		// Initialize connection costs and connection lengths.
 		for (size_t i = 1; i < edges.size(); ++ i) {
 			const FlipEdge   	 &e1 = edges[i - 1];
@@ -1577,9 +1815,11 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
 					size_t b = longest_connection_idx;
 					if (a > b)
 						std::swap(a, b);
+					CrossoverConstraints constraints { fixed_start, can_flip(0, a), can_flip(a, b), can_flip(b, edges.size()) };
 					std::pair<double, size_t> cost_and_flip = minimum_crossover_cost(edges, 
 						std::make_pair(size_t(0), a), connections[a - 1], std::make_pair(a, b), connections[b - 1] - connections[a], std::make_pair(b, edges.size()), connections.back() - connections[b],
-						connections.back().cost);
+						connections.back().cost, constraints);
+					++ num_evaluations;
 					if (cost_and_flip.second > 0 && cost_and_flip.first < crossover_cost_min) {
 						crossover_pos_min  = j;
 						crossover_cost_min = cost_and_flip.first;
@@ -1593,6 +1833,9 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
 				crossover2_pos_final = crossover_pos_min;
 				crossover_flip_final = crossover_flip_min;
 				break;
+			} else if (num_evaluations >= max_evaluations) {
+				// Out of budget.
+				return;
 			} else {
 				// Continue with another long candidate edge.
 			}
@@ -1889,7 +2132,7 @@ static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polyl
     std::transform(polylines.begin(), polylines.end(), std::back_inserter(edges), 
     	[&polylines](const Polyline &pl){ return FlipEdge(pl.first_point().cast<double>(), pl.last_point().cast<double>(), &pl - polylines.data()); });
 #if 1
-	reorder_by_two_exchanges_with_segment_flipping(edges);
+	reorder_by_two_exchanges_with_segment_flipping(edges, chain_two_opt_max_evaluations);
 #else
 	// reorder_by_three_exchanges_with_segment_flipping(edges);
 	reorder_by_three_exchanges_with_segment_flipping2(edges);
@@ -1897,26 +2140,49 @@ static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polyl
 	Polylines out;
 	out.reserve(polylines.size());
 	for (const FlipEdge &edge : edges) {
-		Polyline &pl = polylines[edge.source_index];
-		out.emplace_back(std::move(pl));
-		if (edge.p2 == pl.first_point().cast<double>()) {
+		out.emplace_back(std::move(polylines[edge.source_index]));
+		if (edge.p2 == out.back().first_point().cast<double>()) {
 			// Polyline is flipped.
 			out.back().reverse();
 		} else {
 			// Polyline is not flipped.
-			assert(edge.p1 == pl.first_point().cast<double>());
+			assert(edge.p1 == out.back().first_point().cast<double>());
 		}
 	}
+	polylines = std::move(out);
 
 #ifndef NDEBUG
 	double cost_final = cost();
 #ifdef DEBUG_SVG_OUTPUT
-	svg_draw_polyline_chain("improve_ordering_by_two_exchanges_with_segment_flipping-final", iRun, out);
+	svg_draw_polyline_chain("improve_ordering_by_two_exchanges_with_segment_flipping-final", iRun, polylines);
 #endif /* DEBUG_SVG_OUTPUT */
 	assert(cost_final <= cost_initial);
 #endif /* NDEBUG */
 }
 
+// Shorten the travels between extrusion entities chained by chain_extrusion_entities(). The first entity stays first if fixed_start is set,
+// entities, which cannot be reversed, keep their orientation.
+static void improve_ordering_of_extrusion_entities_by_two_exchanges(const std::vector<ExtrusionEntity*> &entities, std::vector<std::pair<size_t, bool>> &chain, bool fixed_start, size_t max_evaluations)
+{
+	std::vector<FlipEdge>      edges;
+	std::vector<unsigned char> could_flip(entities.size(), false);
+	edges.reserve(chain.size());
+	for (const std::pair<size_t, bool> &segment : chain) {
+		const ExtrusionEntity *ee = entities[segment.first];
+		edges.emplace_back(ee->first_point().cast<double>(), ee->last_point().cast<double>(), segment.first);
+		if (segment.second)
+			edges.back().flip();
+		could_flip[segment.first] = ee->is_loop() || ee->can_reverse();
+	}
+	reorder_by_two_exchanges_with_segment_flipping(edges, max_evaluations, fixed_start, &could_flip);
+	assert(edges.size() == chain.size());
+	for (size_t i = 0; i < edges.size(); ++ i) {
+		const FlipEdge &edge = edges[i];
+		chain[i] = { edge.source_index, edge.p1 != entities[edge.source_index]->first_point().cast<double>() };
+		assert(could_flip[edge.source_index] || ! chain[i].second);
+	}
+}
+
 // Used to optimize order of infill lines and brim lines.
 Polylines chain_polylines(Polylines &&polylines, const Point *start_near)
 {
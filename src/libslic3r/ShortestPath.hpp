@@ -14,9 +14,14 @@ namespace Slic3r {
 
 std::vector<size_t> 				 chain_points(const Points &points, Point *start_near = nullptr);
 
-std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr);
+// If two_opt_max_evaluations is non zero, the greedy chain is improved by 2-opt exchanges, until the given number of exchanges was evaluated.
+// The slicing pipeline calls these with two_opt_max_evaluations = 0, the 2-opt improvement is used by the tests and the chaining benchmark only.
+std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr, size_t two_opt_max_evaluations = 0);
 void                                 reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const std::vector<std::pair<size_t, bool>> &chain);
-void                                 chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr);
+void                                 chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr, size_t two_opt_max_evaluations = 0);
+// Chain and reorder independent collections in parallel. If not empty, start_near contains a start point for each collection.
+// Not used by the slicing pipeline yet, support and gap fill extrusions are still chained serially.
+void                                 chain_and_reorder_extrusion_entities_parallel(const std::vector<ExtrusionEntitiesPtr*> &collections, const Points &start_near = {}, size_t two_opt_max_evaluations = 0);
 
 std::vector<std::pair<size_t, bool>> chain_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, const Point *start_near = nullptr);
 void                                 reorder_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, std::vector<std::pair<size_t, bool>> &chain);
@@ -7,6 +7,7 @@
 #include "Point.hpp"
 #include "Execution/ExecutionTBB.hpp"
 #include "Execution/ExecutionSeq.hpp"
+#include "Format/STL.hpp"
 
 #include <libqhullcpp/Qhull.h>
 #include <libqhullcpp/QhullFacetList.h>
@@ -14,6 +15,7 @@
 
 #include <cmath>
 #include <deque>
+#include <numeric>
 #include <queue>
 #include <vector>
 #include <utility>
@@ -22,6 +24,10 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
 #include <Eigen/Core>
 #include <Eigen/Dense>
 
@@ -85,6 +91,11 @@ TriangleMesh::TriangleMesh(const indexed_triangle_set &M) : repaired(false)
     stl_get_size(&stl);
 }
 
+bool TriangleMesh::ReadSTLFile(const char* input_file)
+{
+    return read_stl_file(input_file, this->stl);
+}
+
 // #define SLIC3R_TRACE_REPAIR
 
 void TriangleMesh::repair(bool update_shared_vertices)
@@ -704,23 +715,28 @@ static std::vector<EdgeToFace> create_edge_map(
 {
     std::vector<EdgeToFace> edges_map;
     edges_map.assign(its.indices.size() * 3, EdgeToFace());
-    for (uint32_t facet_idx = 0; facet_idx < its.indices.size(); ++ facet_idx)
-        for (int i = 0; i < 3; ++ i) {
-            EdgeToFace &e2f = edges_map[facet_idx * 3 + i];
-            e2f.vertex_low  = its.indices[facet_idx][i];
-            e2f.vertex_high = its.indices[facet_idx][(i + 1) % 3];
-            e2f.face        = facet_idx;
-            // 1 based indexing, to be always strictly positive.
-            e2f.face_edge   = i + 1;
-            if (e2f.vertex_low > e2f.vertex_high) {
-                // Sort the vertices
-                std::swap(e2f.vertex_low, e2f.vertex_high);
-                // and make the face_edge negative to indicate a flipped edge.
-                e2f.face_edge = - e2f.face_edge;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &edges_map](const tbb::blocked_range<size_t> &range) {
+        for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx)
+            for (int i = 0; i < 3; ++ i) {
+                EdgeToFace &e2f = edges_map[facet_idx * 3 + i];
+                e2f.vertex_low  = its.indices[facet_idx][i];
+                e2f.vertex_high = its.indices[facet_idx][(i + 1) % 3];
+                e2f.face        = int(facet_idx);
+                // 1 based indexing, to be always strictly positive.
+                e2f.face_edge   = i + 1;
+                if (e2f.vertex_low > e2f.vertex_high) {
+                    // Sort the vertices
+                    std::swap(e2f.vertex_low, e2f.vertex_high);
+                    // and make the face_edge negative to indicate a flipped edge.
+                    e2f.face_edge = - e2f.face_edge;
+                }
             }
-        }
+    });
     throw_on_cancel();
-    std::sort(edges_map.begin(), edges_map.end());
+    // Equal edges are sorted by their faces, so that the edges shared by more than two faces are paired deterministically.
+    tbb::parallel_sort(edges_map.begin(), edges_map.end(), [](const EdgeToFace &l, const EdgeToFace &r) {
+        return l < r || (l == r && (l.face < r.face || (l.face == r.face && std::abs(l.face_edge) < std::abs(r.face_edge))));
+    });
 
     return edges_map;
 }
@@ -834,10 +850,9 @@ std::vector<Vec3i> its_face_edge_ids(const indexed_triangle_set &its, std::vecto
 int its_merge_vertices(indexed_triangle_set &its, bool shrink_to_fit)
 {
     // 1) Sort indices to vertices lexicographically by coordinates AND vertex index.
-    auto sorted = reserve_vector<int>(its.vertices.size());
-    for (int i = 0; i < int(its.vertices.size()); ++ i)
-        sorted.emplace_back(i);
-    std::sort(sorted.begin(), sorted.end(), [&its](int il, int ir) {
+    std::vector<int> sorted(its.vertices.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    tbb::parallel_sort(sorted.begin(), sorted.end(), [&its](int il, int ir) {
         const Vec3f &l = its.vertices[il];
         const Vec3f &r = its.vertices[ir];
         // Sort lexicographically by coordinates AND vertex index.
@@ -882,9 +897,13 @@ int its_merge_vertices(indexed_triangle_set &its, bool shrink_to_fit)
         // Shrink the vertices.
         its.vertices.erase(its.vertices.begin() + k, its.vertices.end());
         // Remap face indices.
-        for (stl_triangle_vertex_indices &face : its.indices)
-            for (int i = 0; i < 3; ++ i)
-                face(i) = map_vertices[face(i)];
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &map_vertices](const tbb::blocked_range<size_t> &range) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                stl_triangle_vertex_indices &face = its.indices[face_idx];
+                for (int i = 0; i < 3; ++ i)
+                    face(i) = map_vertices[face(i)];
+            }
+        });
         // Optionally shrink to fit (reallocate) vertices.
         if (shrink_to_fit)
             its.vertices.shrink_to_fit();
@@ -1261,14 +1280,48 @@ void VertexFaceIndex::create(const indexed_triangle_set &its)
     m_vertex_to_face_start.front() = 0;
 }
 
+// Sort based face neighbor index, sharing create_edge_map() with its_face_edge_ids().
+// Two faces are neighbors if they share an edge with opposite orientation. If more than two faces share an edge,
+// the edges are paired greedily in the order of their faces. Runs of equal edges are paired in parallel.
 std::vector<Vec3i> its_face_neighbors(const indexed_triangle_set &its)
 {
-    return create_face_neighbors_index(ex_seq, its);
+    std::vector<Vec3i>      out(its.indices.size(), Vec3i(-1, -1, -1));
+    std::vector<EdgeToFace> edges_map = create_edge_map(its, [](){});
+    // Each face edge belongs to a single run of equal edges, thus the elements of out written by different runs never overlap.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, edges_map.size()), [&edges_map, &out](const tbb::blocked_range<size_t> &range) {
+        size_t i = range.begin();
+        // Skip the run started by the previous range.
+        while (i > 0 && i < range.end() && edges_map[i - 1] == edges_map[i])
+            ++ i;
+        while (i < range.end()) {
+            size_t j = i + 1;
+            while (j < edges_map.size() && edges_map[i] == edges_map[j])
+                ++ j;
+            for (size_t k = i; k < j; ++ k) {
+                const EdgeToFace &edge_k     = edges_map[k];
+                int              &neighbor_k = out[edge_k.face](std::abs(edge_k.face_edge) - 1);
+                if (neighbor_k != -1)
+                    // Already paired.
+                    continue;
+                for (size_t l = k + 1; l < j; ++ l) {
+                    const EdgeToFace &edge_l     = edges_map[l];
+                    int              &neighbor_l = out[edge_l.face](std::abs(edge_l.face_edge) - 1);
+                    if (edge_k.face_edge * edge_l.face_edge < 0 && edge_k.face != edge_l.face && neighbor_l == -1) {
+                        neighbor_k = edge_l.face;
+                        neighbor_l = edge_k.face;
+                        break;
+                    }
+                }
+            }
+            i = j;
+        }
+    });
+    return out;
 }
 
 std::vector<Vec3i> its_face_neighbors_par(const indexed_triangle_set &its)
 {
-    return create_face_neighbors_index(ex_tbb, its);
+    return its_face_neighbors(its);
 }
 
 } // namespace Slic3r
@@ -24,7 +24,7 @@ public:
     TriangleMesh(const Pointf3s &points, const std::vector<Vec3i> &facets);
     explicit TriangleMesh(const indexed_triangle_set &M);
     void clear() { this->stl.clear(); this->its.clear(); this->repaired = false; }
-    bool ReadSTLFile(const char* input_file) { return stl_open(&stl, input_file); }
+    bool ReadSTLFile(const char* input_file);
     bool write_ascii(const char* output_file) { return stl_write_ascii(&this->stl, output_file, ""); }
     bool write_binary(const char* output_file) { return stl_write_binary(&this->stl, output_file, ""); }
     void repair(bool update_shared_vertices = true);
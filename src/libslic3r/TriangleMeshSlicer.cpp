@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cmath>
 #include <deque>
+#include <numeric>
 #include <queue>
 #include <mutex>
 #include <utility>
@@ -15,6 +16,8 @@
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
 
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
@@ -44,20 +47,20 @@ class IntersectionReference
 {
 public:
     IntersectionReference() = default;
-    IntersectionReference(int point_id, int edge_id) : point_id(point_id), edge_id(edge_id) {}
+    IntersectionReference(int point_id, int64_t edge_id) : point_id(point_id), edge_id(edge_id) {}
     // Where is this intersection point located? On mesh vertex or mesh edge?
     // Only one of the following will be set, the other will remain set to -1.
     // Index of the mesh vertex.
     int point_id { -1 };
-    // Index of the mesh edge.
-    int edge_id { -1 };
+    // Index of the mesh edge, either as calculated by its_face_edge_ids() or as returned by edge_key().
+    int64_t edge_id { -1 };
 };
 
 class IntersectionPoint : public Point, public IntersectionReference
 {
 public:
     IntersectionPoint() = default;
-    IntersectionPoint(int point_id, int edge_id, const Point &pt) : IntersectionReference(point_id, edge_id), Point(pt) {}
+    IntersectionPoint(int point_id, int64_t edge_id, const Point &pt) : IntersectionReference(point_id, edge_id), Point(pt) {}
     IntersectionPoint(const IntersectionReference &ir, const Point &pt) : IntersectionReference(ir), Point(pt) {}
     // Inherits coord_t x, y
 };
@@ -81,8 +84,8 @@ public:
     int             a_id { -1 };
     int             b_id { -1 };
     // Source mesh edges of the line end points.
-    int             edge_a_id { -1 };
-    int             edge_b_id { -1 };
+    int64_t         edge_a_id { -1 };
+    int64_t         edge_b_id { -1 };
 
     enum class FacetEdgeType { 
         // A general case, the cutting plane intersect a face at two different edges.
@@ -137,14 +140,25 @@ enum class FacetSliceType {
     Cutting = 2
 };
 
+// Unique identifier of an undirected mesh edge, composed of the indices of its two vertices.
+// Used instead of the edge IDs calculated by its_face_edge_ids() where only the identity of an edge is needed,
+// as its_face_edge_ids() is costly to calculate for large meshes. The key is always positive, thus it does not
+// collide with the -1 "no edge" marker.
+static inline int64_t edge_key(int a_id, int b_id)
+{
+    assert(a_id >= 0 && b_id >= 0 && a_id != b_id);
+    return a_id < b_id ? (int64_t(a_id) << 32) | int64_t(b_id) : (int64_t(b_id) << 32) | int64_t(a_id);
+}
+
 // Return true, if the facet has been sliced and line_out has been filled.
+// If edge_ids is null, the intersection points are identified by edge_key() of the intersected edge.
 static FacetSliceType slice_facet(
     // Z height of the slice in XY plane. Scaled or unscaled (same as vertices[].z()).
     float                                slice_z,
     // 3 vertices of the triangle, XY scaled. Z scaled or unscaled (same as slice_z).
     const stl_vertex                    *vertices,
     const stl_triangle_vertex_indices   &indices,
-    const Vec3i                         &edge_ids,
+    const Vec3i                         *edge_ids,
     const int                            idx_vertex_lowest,
     const bool                           horizontal,
     IntersectionLine                    &line_out)
@@ -157,13 +171,13 @@ static FacetSliceType slice_facet(
     // This is needed to get all intersection lines in a consistent order
     // (external on the right of the line)
     for (int j = 0; j < 3; ++ j) {  // loop through facet edges
-        int               edge_id;
+        int64_t           edge_id;
         const stl_vertex *a, *b;
         int               a_id, b_id;
         {
             int   k = (idx_vertex_lowest + j) % 3;
             int   l = (k + 1) % 3;
-            edge_id = edge_ids(k);
+            edge_id = edge_ids ? (*edge_ids)(k) : -1;
             a_id    = indices[k];
             a       = vertices + k;
             b_id    = indices[l];
@@ -260,7 +274,7 @@ static FacetSliceType slice_facet(
             } else {
                 point.x() = coord_t(floor(double(b->x()) + (double(a->x()) - double(b->x())) * t + 0.5));
                 point.y() = coord_t(floor(double(b->y()) + (double(a->y()) - double(b->y())) * t + 0.5));
-                point.edge_id = edge_id;
+                point.edge_id = edge_ids ? edge_id : edge_key(a_id, b_id);
                 ++ num_points;
             }
         }
@@ -303,62 +317,169 @@ static FacetSliceType slice_facet(
     return FacetSliceType::NoSlice;
 }
 
-template<typename TransformVertex>
-void slice_facet_at_zs(
-    // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
-    const std::vector<Vec3f>                         &mesh_vertices,
-    const TransformVertex                            &transform_vertex_fn,
-    const stl_triangle_vertex_indices                &indices,
-    const Vec3i                                      &edge_ids,
-    // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
-    const std::vector<float>                         &zs,
-    std::vector<IntersectionLines>                   &lines,
-    std::array<std::mutex, 64>                       &lines_mutex)
+// Mesh faces sorted by the minimum Z of their vertices, with their Z extents stored in the same order in contiguous arrays,
+// so that the faces intersecting a slicing plane could be collected by a sweep over the slicing planes
+// without a binary search of the slicing planes for each face.
+struct ZSortedFacets
 {
-    stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
+    // Face indices sorted by min_z, faces with the same min_z are sorted by their index.
+    std::vector<int>    face_idx;
+    // Z extents of the faces, in the order of face_idx.
+    std::vector<float>  min_z;
+    std::vector<float>  max_z;
+    // Maximum Z extent of a face. Faces spanning a plane at z start at or above z - max_height.
+    // Calculated in doubles, where the difference of two floats is exact.
+    double              max_height { 0. };
+};
 
-    // find facet extents
-    const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
-    const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
-    
-    // find layer extents
-    auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z); // first layer whose slice_z is >= min_z
-    auto max_layer = std::upper_bound(min_layer, zs.end(), max_z); // first layer whose slice_z is > max_z
-    int  idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
-    
-    for (auto it = min_layer; it != max_layer; ++ it) {
-        IntersectionLine il;
-        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
-        if (min_z != max_z && slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
-            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
-            size_t slice_id = it - zs.begin();
-            boost::lock_guard<std::mutex> l(lines_mutex[slice_id >> 6]);
-            lines[slice_id].emplace_back(il);
-        }
-    }
+static ZSortedFacets z_sorted_facets(
+    const std::vector<stl_vertex>                   &vertices,
+    const std::vector<stl_triangle_vertex_indices>  &indices)
+{
+    ZSortedFacets      out;
+    std::vector<float> min_z(indices.size());
+    std::vector<float> max_z(indices.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, indices.size()),
+        [&vertices, &indices, &min_z, &max_z](const tbb::blocked_range<size_t> &range) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const stl_triangle_vertex_indices &tri = indices[face_idx];
+                const float z0 = vertices[tri(0)].z();
+                const float z1 = vertices[tri(1)].z();
+                const float z2 = vertices[tri(2)].z();
+                min_z[face_idx] = fminf(z0, fminf(z1, z2));
+                max_z[face_idx] = fmaxf(z0, fmaxf(z1, z2));
+            }
+        });
+
+    out.face_idx.assign(indices.size(), 0);
+    std::iota(out.face_idx.begin(), out.face_idx.end(), 0);
+    tbb::parallel_sort(out.face_idx.begin(), out.face_idx.end(), [&min_z](int lhs, int rhs) 
+        { return min_z[lhs] < min_z[rhs] || (min_z[lhs] == min_z[rhs] && lhs < rhs); });
+
+    out.min_z.assign(indices.size(), 0.f);
+    out.max_z.assign(indices.size(), 0.f);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, indices.size()),
+        [&out, &min_z, &max_z](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                out.min_z[i] = min_z[out.face_idx[i]];
+                out.max_z[i] = max_z[out.face_idx[i]];
+            }
+        });
+    for (size_t i = 0; i < indices.size(); ++ i)
+        out.max_height = std::max(out.max_height, double(max_z[i]) - double(min_z[i]));
+    return out;
 }
 
+// Slice the mesh with just a few planes, as the interactive clipping plane does with a single plane.
+// Each face is transformed and sliced on its own: Neither the vertices are copied nor the faces are sorted.
+// The ranges of faces are reduced in order, thus the lines are stored in the order of the faces.
 template<typename TransformVertex, typename ThrowOnCancel>
-static inline std::vector<IntersectionLines> slice_make_lines(
+static inline std::vector<IntersectionLines> slice_make_lines_few_planes(
     const std::vector<stl_vertex>                   &vertices,
     const TransformVertex                           &transform_vertex_fn,
     const std::vector<stl_triangle_vertex_indices>  &indices,
-    const std::vector<Vec3i>                        &face_edge_ids,
     const std::vector<float>                        &zs,
     const ThrowOnCancel                              throw_on_cancel_fn)
 {
-    std::vector<IntersectionLines>  lines(zs.size(), IntersectionLines());
-    std::array<std::mutex, 64>      lines_mutex;
+    using LinesPerPlane = std::vector<IntersectionLines>;
+    return tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, indices.size(), 4096), LinesPerPlane(zs.size(), IntersectionLines()),
+        [&vertices, &transform_vertex_fn, &indices, &zs, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range, LinesPerPlane lines) {
+            throw_on_cancel_fn();
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const stl_triangle_vertex_indices &tri = indices[face_idx];
+                stl_vertex v[3] { transform_vertex_fn(vertices[tri(0)]), transform_vertex_fn(vertices[tri(1)]), transform_vertex_fn(vertices[tri(2)]) };
+                const float min_z = fminf(v[0].z(), fminf(v[1].z(), v[2].z()));
+                const float max_z = fmaxf(v[0].z(), fmaxf(v[1].z(), v[2].z()));
+                if (min_z == max_z)
+                    // Ignore horizontal faces.
+                    continue;
+                auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z);
+                auto max_layer = std::upper_bound(min_layer, zs.end(), max_z);
+                int  idx_vertex_lowest = (v[1].z() == min_z) ? 1 : ((v[2].z() == min_z) ? 2 : 0);
+                for (auto it = min_layer; it != max_layer; ++ it) {
+                    IntersectionLine il;
+                    if (slice_facet(*it, v, tri, nullptr, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                        assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                        lines[it - zs.begin()].emplace_back(il);
+                    }
+                }
+            }
+            return lines;
+        },
+        [](LinesPerPlane lhs, LinesPerPlane rhs) {
+            for (size_t i = 0; i < lhs.size(); ++ i)
+                append(lhs[i], std::move(rhs[i]));
+            return lhs;
+        });
+}
+
+// Slice the mesh with a plane sweep: The faces are sorted by their minimum Z once, then the slicing planes are swept bottom up
+// while maintaining a list of active faces, that is faces spanning the current slicing plane. Faces enter the active list
+// in the order of their minimum Z and they leave it when the plane passes their maximum Z.
+// The slicing planes are split into chunks processed in parallel, each chunk sweeps its own active list, thus no locking
+// is needed when storing the intersection lines and the lines are stored in a deterministic order.
+// Horizontal faces are ignored. Any valid horizontal face must have a vertical face connected, otherwise the part has zero volume.
+// A face is visited at each slicing plane it spans, therefore the vertices are expected to be transformed for slicing
+// (scaled in XY, not scaled in Z) by the caller, see transform_mesh_vertices_for_slicing().
+template<typename ThrowOnCancel>
+static inline std::vector<IntersectionLines> slice_make_lines(
+    const std::vector<stl_vertex>                   &vertices,
+    const std::vector<stl_triangle_vertex_indices>  &indices,
+    const std::vector<float>                        &zs,
+    const ThrowOnCancel                              throw_on_cancel_fn)
+{
+    std::vector<IntersectionLines> lines(zs.size(), IntersectionLines());
+    if (zs.empty() || indices.empty())
+        return lines;
+
+    const ZSortedFacets facets = z_sorted_facets(vertices, indices);
+    throw_on_cancel_fn();
+
     tbb::parallel_for(
-        tbb::blocked_range<int>(0, int(indices.size())),
-        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &lines_mutex, throw_on_cancel_fn](const tbb::blocked_range<int> &range) {
-            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
-                if ((face_idx & 0x0ffff) == 0)
-                    throw_on_cancel_fn();
-                slice_facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], face_edge_ids[face_idx], zs, lines, lines_mutex);
+        tbb::blocked_range<size_t>(0, zs.size(), std::max<size_t>(1, zs.size() / 64)),
+        [&vertices, &indices, &zs, &facets, &lines, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            const float  *min_z   = facets.min_z.data();
+            const float  *max_z   = facets.max_z.data();
+            const size_t  num_faces = facets.face_idx.size();
+            // Indices into facets of the faces spanning the current slicing plane, sorted by their minimum Z.
+            std::vector<size_t> active;
+            // Start of the faces not yet entered into the active list.
+            size_t next = std::upper_bound(facets.min_z.begin(), facets.min_z.end(), zs[range.begin()]) - facets.min_z.begin();
+            {
+                // Faces starting below the first slicing plane of this chunk and still spanning it.
+                // Only the faces starting less than max_height below the plane may span it.
+                const float  z     = zs[range.begin()];
+                const size_t first = std::lower_bound(facets.min_z.begin(), facets.min_z.begin() + next, double(z) - facets.max_height,
+                    [](float min_z, double z) { return double(min_z) < z; }) - facets.min_z.begin();
+                for (size_t i = first; i < next; ++ i)
+                    if (max_z[i] >= z && min_z[i] != max_z[i])
+                        active.emplace_back(i);
             }
-        }
-    );
+            for (size_t slice_id = range.begin(); slice_id < range.end(); ++ slice_id) {
+                throw_on_cancel_fn();
+                const float z = zs[slice_id];
+                // Remove the faces below the slicing plane, keep the order of the remaining faces.
+                active.erase(std::remove_if(active.begin(), active.end(), [max_z, z](size_t i) { return max_z[i] < z; }), active.end());
+                // Add the faces starting at or below the slicing plane.
+                for (; next < num_faces && min_z[next] <= z; ++ next)
+                    if (max_z[next] >= z && min_z[next] != max_z[next])
+                        active.emplace_back(next);
+                IntersectionLines &lines_this = lines[slice_id];
+                for (size_t i : active) {
+                    const stl_triangle_vertex_indices &tri = indices[facets.face_idx[i]];
+                    stl_vertex v[3] { vertices[tri(0)], vertices[tri(1)], vertices[tri(2)] };
+                    int idx_vertex_lowest = (v[1].z() == min_z[i]) ? 1 : ((v[2].z() == min_z[i]) ? 2 : 0);
+                    IntersectionLine il;
+                    if (slice_facet(z, v, tri, nullptr, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                        assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                        lines_this.emplace_back(il);
+                    }
+                }
+            }
+        });
     return lines;
 }
 
@@ -490,7 +611,7 @@ void slice_facet_with_slabs(
         IntersectionLine il_prev;
         for (auto it = min_layer; it != max_layer; ++ it) {
             IntersectionLine il;
-            auto type = slice_facet(*it, vertices, indices, facet_edge_ids, idx_vertex_lowest, false, il);
+            auto type = slice_facet(*it, vertices, indices, &facet_edge_ids, idx_vertex_lowest, false, il);
             if (type == FacetSliceType::NoSlice) {
                 // One and exactly one vertex is touching the slicing plane.
             } else {
@@ -720,13 +841,18 @@ inline std::pair<SlabLines, SlabLines> slice_slabs_make_lines(
         lines_bottom.between_slices.assign(zs.size(), IntersectionLines());        
     }
 
+    // Process the faces in the order of their minimum Z, so that each thread works on a narrow band of slabs:
+    // Less contention on lines_mutex and better locality of the output lines.
+    const ZSortedFacets facets = z_sorted_facets(vertices, indices);
+
     tbb::parallel_for(
         tbb::blocked_range<int>(0, int(indices.size())),
-        [&vertices, &indices, &face_neighbors, &face_edge_ids, num_edges, &face_orientation, &zs, top, bottom, &lines_top, &lines_bottom, &lines_mutex_top, &lines_mutex_bottom, throw_on_cancel_fn]
+        [&vertices, &indices, &face_neighbors, &face_edge_ids, num_edges, &face_orientation, &zs, top, bottom, &facets, &lines_top, &lines_bottom, &lines_mutex_top, &lines_mutex_bottom, throw_on_cancel_fn]
         (const tbb::blocked_range<int> &range) {
-            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
-                if ((face_idx & 0x0ffff) == 0)
+            for (int i = range.begin(); i < range.end(); ++ i) {
+                if ((i & 0x0ffff) == 0)
                     throw_on_cancel_fn();
+                int             face_idx = facets.face_idx[i];
                 FaceOrientation fo       = face_orientation[face_idx];
                 Vec3i           edge_ids = face_edge_ids[face_idx];
                 if (top && (fo == FaceOrientation::Up || fo == FaceOrientation::Degenerate)) {
@@ -878,8 +1004,8 @@ static void chain_lines_by_triangle_connectivity(IntersectionLines &lines, Polyg
         IntersectionLine *last_line = first_line;
         
         /*
-        printf("first_line edge_a_id = %d, edge_b_id = %d, a_id = %d, b_id = %d, a = %d,%d, b = %d,%d\n", 
-            first_line->edge_a_id, first_line->edge_b_id, first_line->a_id, first_line->b_id,
+        printf("first_line edge_a_id = %lld, edge_b_id = %lld, a_id = %d, b_id = %d, a = %d,%d, b = %d,%d\n", 
+            (long long)first_line->edge_a_id, (long long)first_line->edge_b_id, first_line->a_id, first_line->b_id,
             first_line->a.x, first_line->a.y, first_line->b.x, first_line->b.y);
         */
         
@@ -931,8 +1057,8 @@ static void chain_lines_by_triangle_connectivity(IntersectionLines &lines, Polyg
                 break;
             }
             /*
-            printf("next_line edge_a_id = %d, edge_b_id = %d, a_id = %d, b_id = %d, a = %d,%d, b = %d,%d\n", 
-                next_line->edge_a_id, next_line->edge_b_id, next_line->a_id, next_line->b_id,
+            printf("next_line edge_a_id = %lld, edge_b_id = %lld, a_id = %d, b_id = %d, a = %d,%d, b = %d,%d\n", 
+                (long long)next_line->edge_a_id, (long long)next_line->edge_b_id, next_line->a_id, next_line->b_id,
                 next_line->a.x, next_line->a.y, next_line->b.x, next_line->b.y);
             */
             assert(last_line->b == next_line->a);
@@ -970,7 +1096,7 @@ static void chain_open_polylines_exact(std::vector<OpenPolyline> &open_polylines
         const IntersectionReference& ipref() const { return start ? polyline->start : polyline->end; }
         // Return a unique ID for the intersection point.
         // Return a positive id for a point, or a negative id for an edge.
-        int id() const { const IntersectionReference &r = ipref(); return (r.point_id >= 0) ? r.point_id : - r.edge_id; }
+        int64_t id() const { const IntersectionReference &r = ipref(); return (r.point_id >= 0) ? r.point_id : - r.edge_id; }
         bool operator==(const OpenPolylineEnd &rhs) const { return this->polyline == rhs.polyline && this->start == rhs.start; }
     };
     auto by_id_lower = [](const OpenPolylineEnd &ope1, const OpenPolylineEnd &ope2) { return ope1.id() < ope2.id(); };
@@ -1615,6 +1741,9 @@ static inline Transform3f make_trafo_for_slicing(const Transform3d &trafo)
     return t.cast<float>();
 }
 
+// Up to this number of slicing planes, slice_mesh() slices each face on its own instead of sweeping the planes over the Z sorted faces.
+static constexpr const size_t slice_few_planes_max = 8;
+
 static inline bool is_identity(const Transform3d &trafo)
 {
     return trafo.matrix() == Transform3d::Identity().matrix();
@@ -1635,9 +1764,7 @@ static std::vector<stl_vertex> transform_mesh_vertices_for_slicing(const indexed
         }
     } else {
         // Transform the vertices, scale up in XY, not in Y.
-        auto t = trafo;
-        t.prescale(Vec3d(s, s, 1.));
-        auto tf = t.cast<float>();
+        Transform3f tf = make_trafo_for_slicing(trafo);
         for (stl_vertex &v : out)
             v = tf * v;
     }
@@ -1656,27 +1783,24 @@ std::vector<Polygons> slice_mesh(
     std::vector<IntersectionLines> lines;
 
     {
-        //FIXME facets_edges is likely not needed and quite costly to calculate.
-        // Instead of edge identifiers, one shall use a sorted pair of edge vertex indices.
-        // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
-        // to make sure that no code relies on it.
-        std::vector<Vec3i> face_edge_ids = its_face_edge_ids(mesh);
-        if (zs.size() <= 1) {
-            // It likely is not worthwile to copy the vertices. Apply the transformation in place.
+        // Intersection points on mesh edges are identified by edge_key() of the sorted pair of edge vertex indices
+        // instead of by the costly its_face_edge_ids(). The chaining code does not rely on a single edge ID being shared
+        // by two triangles only, it iterates over all the lines starting at a given edge.
+        if (zs.size() <= slice_few_planes_max) {
+            // It likely is not worthwile to copy the vertices and to sort the faces. Apply the transformation in place.
             if (is_identity(params.trafo)) {
-                lines = slice_make_lines(
+                lines = slice_make_lines_few_planes(
                     mesh.vertices, [](const Vec3f &p) { return Vec3f(scaled<float>(p.x()), scaled<float>(p.y()), p.z()); }, 
-                    mesh.indices, face_edge_ids, zs, throw_on_cancel);
+                    mesh.indices, zs, throw_on_cancel);
             } else {
                 // Transform the vertices, scale up in XY, not in Z.
                 Transform3f tf = make_trafo_for_slicing(params.trafo);
-                lines = slice_make_lines(mesh.vertices, [tf](const Vec3f &p) { return tf * p; }, mesh.indices, face_edge_ids, zs, throw_on_cancel);
+                lines = slice_make_lines_few_planes(mesh.vertices, [tf](const Vec3f &p) { return tf * p; }, mesh.indices, zs, throw_on_cancel);
             }
         } else {
             // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
-            lines = slice_make_lines(
-                transform_mesh_vertices_for_slicing(mesh, params.trafo), 
-                [](const Vec3f &p) { return p; },  mesh.indices, face_edge_ids, zs, throw_on_cancel);
+            // The plane sweep visits each face at each slicing plane it spans, therefore the vertices are transformed just once.
+            lines = slice_make_lines(transform_mesh_vertices_for_slicing(mesh, params.trafo), mesh.indices, zs, throw_on_cancel);
         }
     }
 
@@ -2001,7 +2125,7 @@ void cut_mesh(const indexed_triangle_set &mesh, float z, indexed_triangle_set *u
                 dst.y() = scale_(src.y());
                 dst.z() = src.z();
             }
-            slice_type = slice_facet(z, vertices_scaled, mesh.indices[facet_idx], facets_edge_ids[facet_idx], idx_vertex_lowest, min_z == max_z, line);
+            slice_type = slice_facet(z, vertices_scaled, mesh.indices[facet_idx], &facets_edge_ids[facet_idx], idx_vertex_lowest, min_z == max_z, line);
         }
 
         if (slice_type != FacetSliceType::NoSlice) {
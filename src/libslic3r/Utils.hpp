@@ -24,6 +24,15 @@ extern std::string format_memsize_MB(size_t n);
 // The string is non-empty if the loglevel >= info (3) or ignore_loglevel==true.
 // Latter is used to get the memory info from SysInfoDialog.
 extern std::string log_memory_info(bool ignore_loglevel = false);
+// Resident memory of the current process and its peak in bytes, zero if not available.
+struct ProcessMemoryInfo
+{
+    size_t resident { 0 };
+    size_t peak     { 0 };
+};
+extern ProcessMemoryInfo process_memory_info();
+// CPU time (user + system) consumed by all the threads of the current process in seconds.
+extern double process_cpu_time();
 extern void disable_multi_threading();
 // Returns the size of physical memory (RAM) in bytes.
 extern size_t total_physical_memory();
@@ -6,6 +6,9 @@
 #include <boost/log/trivial.hpp>
 #include "I18N.hpp"
 
+#include <tbb/pipeline.h>
+#include <tbb/task_arena.h>
+
 //! macro used to mark string used at localization,
 //! return same string
 #define L(s) Slic3r::I18N::translate(s)
@@ -18,6 +21,16 @@
 
 namespace Slic3r {
 
+static mz_uint compression_level(Zipper::e_compression compression)
+{
+    switch (compression) {
+    case Zipper::NO_COMPRESSION: return MZ_NO_COMPRESSION;
+    case Zipper::FAST_COMPRESSION: return MZ_BEST_SPEED;
+    case Zipper::TIGHT_COMPRESSION: return MZ_BEST_COMPRESSION;
+    }
+    return MZ_NO_COMPRESSION;
+}
+
 class Zipper::Impl: public MZ_Archive {
 public:
     std::string m_zipname;
@@ -97,37 +110,77 @@ void Zipper::add_entry(const std::string &name, const void *data, size_t l)
     if(!m_impl->is_alive()) return;
 
     finish_entry();
-    mz_uint cmpr = MZ_NO_COMPRESSION;
-    switch (m_compression) {
-    case NO_COMPRESSION: cmpr = MZ_NO_COMPRESSION; break;
-    case FAST_COMPRESSION: cmpr = MZ_BEST_SPEED; break;
-    case TIGHT_COMPRESSION: cmpr = MZ_BEST_COMPRESSION; break;
-    }
-
-    if(!mz_zip_writer_add_mem(&m_impl->arch, name.c_str(), data, l, cmpr))
+    if(!mz_zip_writer_add_mem(&m_impl->arch, name.c_str(), data, l, compression_level(m_compression)))
         m_impl->blow_up();
 
     m_entry.clear();
     m_data.clear();
 }
 
-void Zipper::finish_entry()
+void Zipper::add_entries(const std::vector<Entry> &entries)
 {
     if(!m_impl->is_alive()) return;
 
-    if(!m_data.empty() && !m_entry.empty()) {
-        mz_uint compression = MZ_NO_COMPRESSION;
+    finish_entry();
+    const mz_uint level = compression_level(m_compression);
+    if (level == MZ_NO_COMPRESSION) {
+        for (const Entry &entry : entries)
+            add_entry(entry.name, entry.data, entry.bytes);
+        return;
+    }
 
-        switch (m_compression) {
-        case NO_COMPRESSION: compression = MZ_NO_COMPRESSION; break;
-        case FAST_COMPRESSION: compression = MZ_BEST_SPEED; break;
-        case TIGHT_COMPRESSION: compression = MZ_BEST_COMPRESSION; break;
-        }
+    struct Compressed {
+        size_t          idx;
+        bool            ok;
+        MZ_DeflatedData data;
+    };
+    bool   ok       = true;
+    size_t idx_next = 0;
+    tbb::parallel_pipeline(2 * tbb::this_task_arena::max_concurrency(),
+        tbb::make_filter<void, size_t>(tbb::filter::serial_in_order,
+            [&entries, &ok, &idx_next](tbb::flow_control &fc) -> size_t {
+                if (! ok || idx_next == entries.size()) {
+                    fc.stop();
+                    return 0;
+                }
+                return idx_next ++;
+            }) &
+        tbb::make_filter<size_t, std::shared_ptr<Compressed>>(tbb::filter::parallel,
+            [&entries, level](size_t idx) -> std::shared_ptr<Compressed> {
+                auto out = std::make_shared<Compressed>();
+                out->idx = idx;
+                // Tiny entries are stored uncompressed by miniz.
+                out->ok  = entries[idx].bytes <= 3 || deflate_data(entries[idx].data, entries[idx].bytes, int(level), true, out->data);
+                return out;
+            }) &
+        tbb::make_filter<std::shared_ptr<Compressed>, void>(tbb::filter::serial_in_order,
+            [this, &entries, &ok, level](std::shared_ptr<Compressed> out) {
+                if (! ok)
+                    return;
+                const Entry &entry = entries[out->idx];
+                if (! out->ok) {
+                    mz_zip_set_last_error(&m_impl->arch, MZ_ZIP_COMPRESSION_FAILED);
+                    ok = false;
+                } else if (entry.bytes <= 3)
+                    ok = mz_zip_writer_add_mem(&m_impl->arch, entry.name.c_str(), entry.data, entry.bytes, level);
+                else if (! mz_zip_writer_add_mem_ex_v2(&m_impl->arch, entry.name.c_str(), out->data.data.data(), out->data.data.size(), nullptr, 0,
+                                level | MZ_ZIP_FLAG_COMPRESSED_DATA, out->data.uncomp_size, out->data.uncomp_crc32, nullptr, nullptr, 0, nullptr, 0))
+                    ok = false;
+            }));
+
+    if (! ok)
+        m_impl->blow_up();
+}
 
+void Zipper::finish_entry()
+{
+    if(!m_impl->is_alive()) return;
+
+    if(!m_data.empty() && !m_entry.empty()) {
         if(!mz_zip_writer_add_mem(&m_impl->arch, m_entry.c_str(),
                                   m_data.c_str(),
                                   m_data.size(),
-                                  compression)) m_impl->blow_up();
+                                  compression_level(m_compression))) m_impl->blow_up();
     }
 
     m_data.clear();
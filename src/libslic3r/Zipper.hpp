@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace Slic3r {
 
@@ -51,6 +52,19 @@ public:
     /// This method throws exactly like finish_entry() does.
     void add_entry(const std::string& name, const void* data, size_t bytes);
 
+    /// Binary file entry for add_entries(), the data is referenced, not copied.
+    struct Entry {
+        std::string name;
+        const void *data;
+        size_t      bytes;
+    };
+
+    /// Add many binary file entries at once. The entries are compressed in
+    /// parallel and written into the archive in the order given, thus the
+    /// archive does not depend on the number of threads.
+    /// This method throws exactly like finish_entry() does.
+    void add_entries(const std::vector<Entry> &entries);
+
     // Writing data to the archive works like with standard streams. The target
     // within the zip file is the entry created with the add_entry method.
 
@@ -1,4 +1,5 @@
 #include <exception>
+#include <memory>
 
 #include "miniz_extension.hpp"
 
@@ -8,6 +9,9 @@
 
 #include "I18N.hpp"
 
+#include <tbb/pipeline.h>
+#include <tbb/task_arena.h>
+
 //! macro used to mark string used at localization,
 //! return same string
 #define L(s) Slic3r::I18N::translate(s)
@@ -76,6 +80,71 @@ bool open_zip_writer(mz_zip_archive *zip, const std::string &fname)
 bool close_zip_reader(mz_zip_archive *zip) { return close_zip(zip, true); }
 bool close_zip_writer(mz_zip_archive *zip) { return close_zip(zip, false); }
 
+bool deflate_data(const void *data, size_t size, int level, bool last, MZ_DeflatedData &out)
+{
+    out.data.clear();
+    out.uncomp_size  = size;
+    out.uncomp_crc32 = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)data, size);
+    // tdefl_compressor is a few hundred kilobytes large, don't allocate it on stack.
+    auto compressor = std::make_unique<tdefl_compressor>();
+    auto put_buf    = [](const void *buf, int len, void *user) -> mz_bool {
+        auto &out = *static_cast<std::vector<unsigned char>*>(user);
+        out.insert(out.end(), (const unsigned char*)buf, (const unsigned char*)buf + len);
+        return MZ_TRUE;
+    };
+    // Negative window bits: Raw deflate stream without the zlib header, as stored into ZIP archives.
+    if (tdefl_init(compressor.get(), put_buf, &out.data, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
+        return false;
+    tdefl_status status = tdefl_compress_buffer(compressor.get(), data, size, last ? TDEFL_FINISH : TDEFL_FULL_FLUSH);
+    return status == (last ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+}
+
+bool add_file_to_zip_parallel(mz_zip_archive *zip, const char *name, mz_uint64 max_size, int level,
+                              size_t num_pieces, const std::function<void(size_t idx, std::string &out)> &produce_piece)
+{
+    if (num_pieces == 0) {
+        mz_zip_set_last_error(zip, MZ_ZIP_INVALID_PARAMETER);
+        return false;
+    }
+
+    mz_zip_writer_staged_context context;
+    if (! mz_zip_writer_add_staged_open(zip, &context, name, max_size, nullptr, nullptr, 0,
+            mz_uint(level < 0 ? MZ_DEFAULT_LEVEL : level) | MZ_ZIP_FLAG_COMPRESSED_DATA, nullptr, 0, nullptr, 0))
+        return false;
+
+    bool   ok       = true;
+    size_t idx_next = 0;
+    tbb::parallel_pipeline(2 * tbb::this_task_arena::max_concurrency(),
+        tbb::make_filter<void, size_t>(tbb::filter::serial_in_order,
+            [&ok, &idx_next, num_pieces](tbb::flow_control &fc) -> size_t {
+                if (! ok || idx_next == num_pieces) {
+                    fc.stop();
+                    return 0;
+                }
+                return idx_next ++;
+            }) &
+        tbb::make_filter<size_t, std::shared_ptr<MZ_DeflatedData>>(tbb::filter::parallel,
+            [&produce_piece, level, num_pieces](size_t idx) -> std::shared_ptr<MZ_DeflatedData> {
+                std::string piece;
+                produce_piece(idx, piece);
+                auto out = std::make_shared<MZ_DeflatedData>();
+                return deflate_data(piece.data(), piece.size(), level, idx + 1 == num_pieces, *out) ? out : nullptr;
+            }) &
+        tbb::make_filter<std::shared_ptr<MZ_DeflatedData>, void>(tbb::filter::serial_in_order,
+            [zip, &context, &ok](std::shared_ptr<MZ_DeflatedData> out) {
+                if (! ok)
+                    return;
+                if (! out) {
+                    mz_zip_set_last_error(zip, MZ_ZIP_COMPRESSION_FAILED);
+                    ok = false;
+                } else if (! mz_zip_writer_add_staged_compressed_data(&context, out->data.data(), out->data.size(), out->uncomp_size, out->uncomp_crc32))
+                    ok = false;
+            }));
+
+    // Nothing to release if the entry is not finished after a failure, the compressed data is not buffered by miniz.
+    return ok && mz_zip_writer_add_staged_finish(&context);
+}
+
 MZ_Archive::MZ_Archive()
 {
     mz_zip_zero_struct(&arch);
@@ -1,7 +1,9 @@
 #ifndef MINIZ_EXTENSION_HPP
 #define MINIZ_EXTENSION_HPP
 
+#include <functional>
 #include <string>
+#include <vector>
 #include <miniz.h>
 
 namespace Slic3r {
@@ -11,6 +13,27 @@ bool open_zip_writer(mz_zip_archive *zip, const std::string &fname_utf8);
 bool close_zip_reader(mz_zip_archive *zip);
 bool close_zip_writer(mz_zip_archive *zip);
 
+// Piece of a raw deflate stream compressed independently of other pieces, so that the entries
+// or the pieces of a large entry of a ZIP archive may be compressed in parallel.
+struct MZ_DeflatedData
+{
+    std::vector<unsigned char> data;
+    size_t                     uncomp_size  { 0 };
+    mz_uint32                  uncomp_crc32 { MZ_CRC32_INIT };
+};
+
+// Compress data into a raw deflate stream. If last is false, the stream is terminated by a full flush instead of the final block,
+// so that it may be continued by the deflate stream of the next piece. Returns false on failure.
+bool deflate_data(const void *data, size_t size, int level, bool last, MZ_DeflatedData &out);
+
+// Add a possibly huge file to a ZIP archive piecewise. The pieces are produced by produce_piece(idx, out) for idx = 0 .. num_pieces - 1
+// and compressed on worker threads, while the compressed pieces are written into the archive in order, so that only a bounded
+// number of pieces is kept in memory. The archive does not depend on the number of threads.
+// Like with mz_zip_writer_add_staged_open(), the file shall not be empty.
+// Returns false on failure, the error is stored into the archive.
+bool add_file_to_zip_parallel(mz_zip_archive *zip, const char *name, mz_uint64 max_size, int level,
+                              size_t num_pieces, const std::function<void(size_t idx, std::string &out)> &produce_piece);
+
 class MZ_Archive {
 public:
     mz_zip_archive arch;
@@ -1007,6 +1007,55 @@ std::string log_memory_info(bool ignore_loglevel)
     return out;
 }
 
+ProcessMemoryInfo process_memory_info()
+{
+    ProcessMemoryInfo out;
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        out.resident = size_t(pmc.WorkingSetSize);
+        out.peak     = size_t(pmc.PeakWorkingSetSize);
+    }
+#elif defined(__linux__) or defined(__APPLE__)
+    #ifdef __APPLE__
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t infoCount = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &infoCount) == KERN_SUCCESS)
+        out.resident = (size_t)info.resident_size;
+    #else // i.e. __linux__
+    size_t tSize = 0, resident = 0;
+    std::ifstream buffer("/proc/self/statm");
+    if (buffer && (buffer >> tSize >> resident))
+        out.resident = resident * (size_t)sysconf(_SC_PAGE_SIZE);
+    #endif
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) == 0) {
+        out.peak = (size_t)memory_info.ru_maxrss;
+    #ifdef __linux__
+        // getrusage returns the value in kB on linux
+        out.peak *= 1024;
+    #endif
+    }
+#endif
+    return out;
+}
+
+double process_cpu_time()
+{
+#ifdef WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        auto to_100ns = [](const FILETIME &t) { return (uint64_t(t.dwHighDateTime) << 32) | uint64_t(t.dwLowDateTime); };
+        return double(to_100ns(kernel_time) + to_100ns(user_time)) * 1e-7;
+    }
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + 1e-6 * double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#endif
+    return 0.;
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
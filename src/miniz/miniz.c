@@ -152,6 +152,73 @@ mz_ulong mz_crc32(mz_ulong crc, const mz_uint8 *ptr, size_t buf_len)
 }
 #endif
 
+/* CRC-32 combination, the zlib crc32_combine() algorithm: The CRC-32 of a sequence is updated by appending len2 zero bits
+   with a precomputed operator, which is squared repeatedly to process len2 in log2(len2) steps. */
+static mz_uint32 mz_gf2_matrix_times(const mz_uint32 *mat, mz_uint32 vec)
+{
+    mz_uint32 sum = 0;
+    while (vec)
+    {
+        if (vec & 1)
+            sum ^= *mat;
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void mz_gf2_matrix_square(mz_uint32 *square, const mz_uint32 *mat)
+{
+    int n;
+    for (n = 0; n < 32; n++)
+        square[n] = mz_gf2_matrix_times(mat, mat[n]);
+}
+
+mz_ulong mz_crc32_combine(mz_ulong crc1, mz_ulong crc2, mz_uint64 len2)
+{
+    int n;
+    mz_uint32 row;
+    mz_uint32 even[32]; /* even-power-of-two zeros operator */
+    mz_uint32 odd[32];  /* odd-power-of-two zeros operator */
+    mz_uint32 crc = (mz_uint32)crc1;
+
+    if (len2 == 0)
+        return crc1;
+
+    /* put operator for one zero bit in odd */
+    odd[0] = 0xedb88320UL; /* CRC-32 polynomial */
+    row = 1;
+    for (n = 1; n < 32; n++)
+    {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    /* put operator for two zero bits in even */
+    mz_gf2_matrix_square(even, odd);
+    /* put operator for four zero bits in odd */
+    mz_gf2_matrix_square(odd, even);
+
+    /* apply len2 zeros to crc1 (first square will put the operator for one zero byte, eight zero bits, in even) */
+    do
+    {
+        /* apply zeros operator for this bit of len2 */
+        mz_gf2_matrix_square(even, odd);
+        if (len2 & 1)
+            crc = mz_gf2_matrix_times(even, crc);
+        len2 >>= 1;
+        if (len2 == 0)
+            break;
+        /* another iteration of the loop with odd and even swapped */
+        mz_gf2_matrix_square(odd, even);
+        if (len2 & 1)
+            crc = mz_gf2_matrix_times(odd, crc);
+        len2 >>= 1;
+    } while (len2 != 0);
+
+    return crc ^ (mz_uint32)crc2;
+}
+
 void mz_free(void *p)
 {
     MZ_FREE(p);
@@ -6720,9 +6787,8 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
 
     pState = pZip->m_pState;
 
-    /* We could support this, but why? */
-    if (level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA)
-        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+    /* With MZ_ZIP_FLAG_COMPRESSED_DATA, the raw deflate stream is provided by mz_zip_writer_add_staged_compressed_data(). */
+    pContext->compressed_data = (level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA) != 0;
 
     if (!mz_zip_writer_validate_archive_name(pArchive_name))
         return mz_zip_set_error(pZip, MZ_ZIP_INVALID_FILENAME);
@@ -6834,16 +6900,22 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     assert(max_size);
     assert(level);
 
+    pContext->add_state.m_pZip = pZip;
+    pContext->add_state.m_cur_archive_file_ofs = pContext->cur_archive_file_ofs;
+    pContext->add_state.m_comp_size = 0;
+
+    if (pContext->compressed_data)
+    {
+        pContext->compressed_data_open = MZ_TRUE;
+        return MZ_TRUE;
+    }
+
     pContext->pCompressor = (tdefl_compressor*)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(tdefl_compressor));
     if (!pContext->pCompressor)
     {
         return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
     }
 
-    pContext->add_state.m_pZip = pZip;
-    pContext->add_state.m_cur_archive_file_ofs = pContext->cur_archive_file_ofs;
-    pContext->add_state.m_comp_size = 0;
-
     if (tdefl_init(pContext->pCompressor, mz_zip_writer_add_put_buf_callback, &pContext->add_state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
     {
         pZip->m_pFree(pZip->m_pAlloc_opaque, pContext->pCompressor);
@@ -6883,15 +6955,45 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context *pContext, const void *pComp_buf, size_t comp_size, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32)
+{
+    if (! pContext->compressed_data_open)
+        return mz_zip_set_error(pContext->pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    if (pContext->file_ofs + uncomp_size > pContext->max_size)
+    {
+        pContext->compressed_data_open = MZ_FALSE;
+        return mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_READ_FAILED);
+    }
+
+    pContext->file_ofs += uncomp_size;
+    pContext->uncomp_crc32 = (mz_uint32)mz_crc32_combine(pContext->uncomp_crc32, uncomp_crc32, uncomp_size);
+
+    if (comp_size > 0 && ! mz_zip_writer_add_put_buf_callback(pComp_buf, (int)comp_size, &pContext->add_state))
+    {
+        pContext->compressed_data_open = MZ_FALSE;
+        return mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_WRITE_FAILED);
+    }
+
+    return MZ_TRUE;
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
-    if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
-        // Either never opened, or already finished.
-        ! pContext->pCompressor)
-        return MZ_FALSE;
+    if (pContext->compressed_data) {
+        // Either never opened, already finished or failed.
+        if (! pContext->compressed_data_open)
+            return MZ_FALSE;
+        pContext->compressed_data_open = MZ_FALSE;
+    } else {
+        if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
+            // Either never opened, or already finished.
+            ! pContext->pCompressor)
+            return MZ_FALSE;
 
-    pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
-    pContext->pCompressor = NULL;
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+    }
 
     // Rewrite preallocated phony custom block in local dir header by ZIP64 extension. Also, other values are adjusted in the header.
     if (pContext->file_ofs >= MZ_UINT32_MAX || pContext->add_state.m_comp_size >= MZ_UINT32_MAX) {
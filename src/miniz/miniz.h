@@ -1332,6 +1332,9 @@ typedef struct mz_zip_writer_staged_context
     mz_zip_writer_add_state  add_state;
     tdefl_compressor        *pCompressor;
     mz_uint64                file_ofs;
+    /* Opened with MZ_ZIP_FLAG_COMPRESSED_DATA, the data is deflated by the caller. */
+    mz_bool                  compressed_data;
+    mz_bool                  compressed_data_open;
 
     /*
      * The following data is passed to the "finish" stage, the referenced pointers must still be valid!
@@ -1349,8 +1352,14 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     mz_uint64 max_size, const MZ_TIME_T* pFile_time, const void* pComment, mz_uint16 comment_size, mz_uint level_and_flags,
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
+/* If mz_zip_writer_add_staged_open() was called with MZ_ZIP_FLAG_COMPRESSED_DATA, the raw deflate stream is passed piecewise by the caller
+   together with the size and CRC-32 of the uncompressed data, for example when compressing large files on multiple threads. */
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context* pContext, const void* pComp_buf, size_t comp_size, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
 
+/* Returns the CRC-32 of two concatenated blocks of data, given the CRC-32 of both blocks and the length of the 2nd block. */
+mz_ulong mz_crc32_combine(mz_ulong crc1, mz_ulong crc2, mz_uint64 len2);
+
 /* Adds a file to an archive by fully cloning the data from another archive. */
 /* This function fully clones the source file's compressed data (no recompression), along with its full filename, extra data (it may add or modify the zip64 local header extra data field), and the optional descriptor following the compressed data. */
 mz_bool mz_zip_writer_add_from_zip_reader(mz_zip_archive *pZip, mz_zip_archive *pSource_zip, mz_uint src_file_index);
@@ -1406,7 +1406,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memsize();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -1445,8 +1445,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
 
 #if ENABLE_GCODE_LINES_ID_IN_H_SLIDER
     m_sequential_view.gcode_ids.clear();
-    for (const GCodeProcessor::MoveVertex& move : gcode_result.moves) {
-        m_sequential_view.gcode_ids.push_back(move.gcode_id);
+    m_sequential_view.gcode_ids.reserve(m_moves_count);
+    for (size_t i = 0; i < m_moves_count; ++i) {
+        m_sequential_view.gcode_ids.push_back(gcode_result.moves.gcode_id(i));
     }
 #endif // ENABLE_GCODE_LINES_ID_IN_H_SLIDER
 
@@ -1594,9 +1595,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             float half_width = 0.5f * path.width;
             for (size_t j = 1; j < path_vertices_count - 1; ++j) {
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
-                const Vec3f& prev = gcode_result.moves[curr_s_id - 1].position;
-                const Vec3f& curr = gcode_result.moves[curr_s_id].position;
-                const Vec3f& next = gcode_result.moves[curr_s_id + 1].position;
+                const Vec3f& prev = gcode_result.moves.position(curr_s_id - 1);
+                const Vec3f& curr = gcode_result.moves.position(curr_s_id);
+                const Vec3f& next = gcode_result.moves.position(curr_s_id + 1);
 
                 // select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
@@ -1736,9 +1737,13 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
             continue;
 
         const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
+        // the moves are decoded from the compact storage on access
+        GCodeProcessor::MoveVertex next_move;
         const GCodeProcessor::MoveVertex* next = nullptr;
-        if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+        if (i < m_moves_count - 1) {
+            next_move = gcode_result.moves[i + 1];
+            next = &next_move;
+        }
 
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
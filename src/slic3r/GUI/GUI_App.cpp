@@ -908,6 +908,8 @@ bool GUI_App::on_init_inner()
     init_label_colours();
     init_fonts();
 
+    update_model_cache();
+
     // Suppress the '- default -' presets.
     preset_bundle->set_default_suppressed(app_config->get("no_defaults") == "1");
     try {
@@ -1380,6 +1382,7 @@ void GUI_App::force_colors_update()
 void GUI_App::update_ui_from_settings()
 {
     update_label_colours();
+    update_model_cache();
     mainframe->update_ui_from_settings();
 
 #ifdef _WIN32
@@ -1393,6 +1396,12 @@ void GUI_App::update_ui_from_settings()
 #endif
 }
 
+void GUI_App::update_model_cache()
+{
+    Model::set_cache_dir(app_config->get("use_model_cache") == "1" ?
+        (boost::filesystem::path(data_dir()) / "model_cache").string() : std::string());
+}
+
 void GUI_App::persist_window_geometry(wxTopLevelWindow *window, bool default_maximized)
 {
     const std::string name = into_u8(window->GetName());
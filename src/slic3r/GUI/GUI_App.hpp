@@ -228,6 +228,8 @@ public:
 
     void            persist_window_geometry(wxTopLevelWindow *window, bool default_maximized = false);
     void            update_ui_from_settings();
+    // Enable or disable the on disk cache of the loaded models based on the "use_model_cache" app config value.
+    void            update_model_cache();
 
     bool            switch_language();
     bool            load_language(wxString language, bool initial);
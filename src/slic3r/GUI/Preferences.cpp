@@ -164,6 +164,14 @@ void PreferencesDialog::build()
 		option = Option(def, "show_incompatible_presets");
 		m_optgroup_general->append_single_option_line(option);
 
+		def.label = L("Cache loaded models");
+		def.type = coBool;
+		def.tooltip = L("If enabled, the repaired meshes of the loaded models are stored in the data directory, "
+			"so that the same files load faster next time. Modified files are always loaded again.");
+		def.set_default_value(new ConfigOptionBool{ app_config->get("use_model_cache") == "1" });
+		option = Option(def, "use_model_cache");
+		m_optgroup_general->append_single_option_line(option);
+
 		def.label = L("Show drop project dialog");
 		def.type = coBool;
 		def.tooltip = L("When checked, whenever dragging and dropping a project file on the application, shows a dialog asking to select the action to take on the file to load.");
@@ -3,10 +3,17 @@
 #include <numeric>
 #include <sstream>
 
+#include <tbb/task_arena.h>
+
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
+#include "libslic3r/Fill/FillPatternCache.hpp"
+#include "libslic3r/Fill/FillRectilinear.hpp"
+#include "libslic3r/Fill/FillSurfaceCache.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
+#include "libslic3r/Layer.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SVG.hpp"
 #include "libslic3r/libslic3r.h"
@@ -190,6 +197,176 @@ TEST_CASE("Fill: Pattern Path Length", "[Fill]") {
     }
 }
 
+TEST_CASE("Fill: Periodic patterns do not depend on the pattern cache", "[Fill]") {
+    ExPolygon small_square(Polygon::new_scale({ {10, 10}, {30, 10}, {30, 30}, {10, 30} }));
+    ExPolygon large_square(Polygon::new_scale({ {0, 0}, {80, 0}, {80, 80}, {0, 80} }));
+    FillParams fill_params;
+    fill_params.density = 0.15f;
+
+    for (const char *pattern : { "gyroid", "3dhoneycomb" }) {
+        std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(pattern));
+        filler->spacing  = 0.45;
+        filler->layer_id = 10;
+        filler->z        = 2.1;
+        auto fill = [&filler, &fill_params](const ExPolygon &expolygon) {
+            Surface surface(stInternal, expolygon);
+            filler->bounding_box = get_extents(expolygon);
+            return filler->fill_surface(&surface, fill_params);
+        };
+        FillPatternCache::clear();
+        Polylines small_uncached = fill(small_square);
+        FillPatternCache::clear();
+        Polylines large_uncached = fill(large_square);
+        // Grows the pattern cached for the large square, then crops it to the small square.
+        Polylines small_cached   = fill(small_square);
+        FillPatternCache::clear();
+        fill(small_square);
+        // Grows the pattern cached for the small square to the large square.
+        Polylines large_cached   = fill(large_square);
+        FillPatternCache::clear();
+
+        INFO("Pattern " << pattern);
+        REQUIRE(! small_uncached.empty());
+        REQUIRE(small_cached == small_uncached);
+        REQUIRE(large_cached == large_uncached);
+    }
+}
+
+TEST_CASE("Fill: Identical objects share identical infill", "[Fill]") {
+    for (const char *pattern : { "rectilinear", "gyroid", "concentric" }) {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({ Slic3r::Test::TestMesh::cube_20x20x20, Slic3r::Test::TestMesh::cube_20x20x20 }, print, {
+            { "fill_pattern",   pattern },
+            { "fill_density",   "20%" },
+            { "layer_height",   0.3 }
+        });
+        REQUIRE(print.objects().size() == 2);
+        const PrintObject &object1 = *print.objects().front();
+        const PrintObject &object2 = *print.objects().back();
+        REQUIRE(object1.layers().size() == object2.layers().size());
+        size_t num_polylines = 0;
+        for (size_t layer_id = 0; layer_id < object1.layers().size(); ++ layer_id) {
+            Polylines infill1 = object1.get_layer(int(layer_id))->regions().front()->fills.as_polylines();
+            Polylines infill2 = object2.get_layer(int(layer_id))->regions().front()->fills.as_polylines();
+            REQUIRE(infill1 == infill2);
+            num_polylines += infill1.size();
+        }
+        REQUIRE(num_polylines > 0);
+    }
+}
+
+// Monotonic filler counting the surfaces it has filled.
+class FillMonotonicCounting : public FillMonotonic
+{
+public:
+    Fill* clone() const override { return new FillMonotonicCounting(*this); }
+    Polylines fill_surface(const Surface *surface, const FillParams &params) override {
+        ++ num_filled;
+        return FillMonotonic::fill_surface(surface, params);
+    }
+
+    size_t num_filled { 0 };
+};
+
+TEST_CASE("Fill: Surface cache reuses the infill of identical surfaces only", "[Fill]") {
+    ExPolygon square(Polygon::new_scale({ {0, 0}, {20, 0}, {20, 20}, {0, 20} }));
+    Surface   surface(stInternalSolid, square);
+    FillMonotonicCounting filler;
+    filler.spacing      = 0.45;
+    filler.layer_id     = 3;
+    filler.z            = 1.2;
+    filler.angle        = 0.f;
+    filler.bounding_box = get_extents(square);
+    FillParams fill_params;
+    fill_params.density = 1.f;
+    auto fill = [&filler, &surface, &fill_params]() { return FillSurfaceCache::fill_surface(filler, ipMonotonic, surface, fill_params); };
+
+    FillSurfaceCache::clear();
+    Polylines first = fill();
+    REQUIRE(! first.empty());
+    REQUIRE(filler.num_filled == 1);
+
+    SECTION("identical surface is a hit") {
+        Polylines second = fill();
+        REQUIRE(filler.num_filled == 1);
+        REQUIRE(second == first);
+    }
+    SECTION("different layer is a miss") {
+        filler.layer_id = 4;
+        fill();
+        REQUIRE(filler.num_filled == 2);
+    }
+    SECTION("different angle is a miss") {
+        filler.angle = float(M_PI / 4.);
+        Polylines rotated = fill();
+        REQUIRE(filler.num_filled == 2);
+        REQUIRE(rotated != first);
+    }
+    SECTION("different monotonic quality is a miss") {
+        fill_params.monotonic_quality = MonotonicQuality::Best;
+        fill();
+        REQUIRE(filler.num_filled == 2);
+    }
+    FillSurfaceCache::clear();
+}
+
+TEST_CASE("Fill: Adaptive cubic octree does not depend on the number of threads", "[Fill]") {
+    indexed_triangle_set mesh = its_make_sphere(20., PI / 45.);
+    its_transform(mesh, Transform3d(FillAdaptive::transform_to_octree().toRotationMatrix() * Eigen::Translation3d(0., 0., 20.)), true);
+    ExPolygon square(Polygon::new_scale({ {-25, -25}, {25, -25}, {25, 25}, {-25, 25} }));
+    FillParams fill_params;
+    fill_params.density = 0.2f;
+
+    for (bool support_overhangs_only : { false, true }) {
+        FillAdaptive::OctreePtr octree_serial;
+        tbb::task_arena(1).execute([&]() { octree_serial = FillAdaptive::build_octree(mesh, {}, 2., support_overhangs_only); });
+        FillAdaptive::OctreePtr octree_parallel = FillAdaptive::build_octree(mesh, {}, 2., support_overhangs_only);
+        std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(support_overhangs_only ? ipSupportCubic : ipAdaptiveCubic));
+        filler->spacing      = 0.45;
+        filler->angle        = 0.f;
+        filler->bounding_box = get_extents(square);
+        size_t num_lines     = 0;
+        for (double z : { 1., 7.3, 20., 33.1 }) {
+            filler->z = z;
+            Surface surface(stInternal, square);
+            filler->adapt_fill_octree = octree_serial.get();
+            Polylines serial = filler->fill_surface(&surface, fill_params);
+            filler->adapt_fill_octree = octree_parallel.get();
+            Polylines parallel = filler->fill_surface(&surface, fill_params);
+            REQUIRE(serial == parallel);
+            num_lines += serial.size();
+        }
+        REQUIRE(num_lines > 0);
+    }
+}
+
+TEST_CASE("Fill: Monotonic infill is deterministic at all quality levels", "[Fill]") {
+    // Perforated plate: many monotonic regions separated by the holes.
+    ExPolygon plate(Polygon::new_scale({ {0, 0}, {50, 0}, {50, 50}, {0, 50} }));
+    for (int i = 0; i < 5; ++ i)
+        for (int j = 0; j < 5; ++ j) {
+            Polygon hole = Polygon::new_scale({ {4. + 10. * i, 4. + 10. * j}, {6. + 10. * i, 4. + 10. * j}, {6. + 10. * i, 6. + 10. * j}, {4. + 10. * i, 6. + 10. * j} });
+            hole.reverse();
+            plate.holes.emplace_back(std::move(hole));
+        }
+    std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("monotonic"));
+    filler->spacing      = 0.45;
+    filler->angle        = float(M_PI / 4.);
+    filler->bounding_box = get_extents(plate);
+    FillParams fill_params;
+    fill_params.density = 1.f;
+
+    for (MonotonicQuality quality : { MonotonicQuality::Fast, MonotonicQuality::Normal, MonotonicQuality::Best }) {
+        fill_params.monotonic_quality = quality;
+        Surface surface(stInternalSolid, plate);
+        Polylines paths1 = filler->fill_surface(&surface, fill_params);
+        Polylines paths2 = filler->fill_surface(&surface, fill_params);
+        INFO("Quality " << int(quality));
+        REQUIRE(! paths1.empty());
+        REQUIRE(paths1 == paths2);
+    }
+}
+
 /*
 {
     my $collection = Slic3r::Polyline::Collection->new(
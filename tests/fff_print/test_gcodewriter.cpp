@@ -1,6 +1,9 @@
 #include <catch2/catch.hpp>
 
+#include <iomanip>
 #include <memory>
+#include <random>
+#include <sstream>
 
 #include "libslic3r/GCodeWriter.hpp"
 
@@ -94,3 +97,42 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("GCodeFormatter emits the same values as std::ostringstream with fixed-point output.", "[GCodeWriter]") {
+
+    GIVEN("Random values including values close to a rounding boundary") {
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> dist(-1000., 1000.);
+        std::vector<double> values { 0., -0., -0.0001, 0.0005, 1.0005, 2.5e-4, -2.5e-4, 99999.123, 203.200522, 1e20, -1e20 };
+        for (size_t i = 0; i < 10000; ++ i) {
+            double v = dist(rng);
+            values.emplace_back(v);
+            values.emplace_back(std::round(v * 2000.) / 2000.);
+            values.emplace_back(std::round(v * 200000.) / 200000.);
+            values.emplace_back(v * 1e-4);
+        }
+        WHEN("the values are formatted with 3 and 5 decimal digits") {
+            THEN("GCodeFormatter output matches std::ostringstream output") {
+                size_t num_mismatches = 0;
+                for (double v : values)
+                    for (int digits : { GCodeFormatter::XYZF_EXPORT_DIGITS, GCodeFormatter::E_EXPORT_DIGITS }) {
+                        std::string out;
+                        GCodeFormatter::append_fixed(out, v, digits);
+                        std::ostringstream ss;
+                        ss << std::fixed << std::setprecision(digits) << v;
+                        if (out != ss.str())
+                            ++ num_mismatches;
+                    }
+                REQUIRE(num_mismatches == 0);
+            }
+        }
+    }
+    GIVEN("GCodeWriter instance") {
+        GCodeWriter writer;
+        WHEN("travel_to_xy is called") {
+            THEN("Output string is G1 X10.000 Y-0.500 F7800.000") {
+                REQUIRE_THAT(writer.travel_to_xy(Vec2d(10., -0.5)), Catch::Equals("G1 X10.000 Y-0.500 F7800.000\n"));
+            }
+        }
+    }
+}
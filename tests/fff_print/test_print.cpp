@@ -126,3 +126,42 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Step statistics", "[Print]") {
+    GIVEN("20mm cube and default config") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "skirts", 1 } });
+        WHEN("the print is processed with the step statistics enabled") {
+            print.set_step_stats_enabled(true);
+            print.process();
+            std::vector<PrintStepStats> stats = print.step_stats();
+            auto find_step = [&stats](const std::string &name) {
+                return std::find_if(stats.begin(), stats.end(), [&name](const PrintStepStats &s) { return s.step_name == name; });
+            };
+            THEN("all the object steps and the skirt / brim step are recorded") {
+                for (const char *name : { "posSlice", "posPerimeters", "posPrepareInfill", "posInfill", "posIroning", "posSupportMaterial", "psSkirtBrim" })
+                    REQUIRE(find_step(name) != stats.end());
+            }
+            THEN("posSlice reports the layers of the object") {
+                auto it = find_step("posSlice");
+                REQUIRE(it != stats.end());
+                REQUIRE(it->object_id == print.objects().front()->id());
+                REQUIRE(it->layers == print.objects().front()->layers().size());
+                REQUIRE(it->wall_time >= 0.);
+            }
+            THEN("the skirt extrusions are counted") {
+                auto it = find_step("psSkirtBrim");
+                REQUIRE(it != stats.end());
+                REQUIRE(! it->object_id.valid());
+                REQUIRE(it->extrusions == print.skirt().items_count() + print.brim().items_count());
+            }
+        }
+        WHEN("the print is processed with the step statistics disabled") {
+            print.process();
+            THEN("no statistics are recorded") {
+                REQUIRE(print.step_stats().empty());
+            }
+        }
+    }
+}
@@ -87,3 +87,34 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: cache key covers the layer range modifiers", "[PrintObject]") {
+    GIVEN("20mm cube with a layer range modifier from 2mm to 5mm") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({ { "layer_height", 0.2 } });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        ModelObject *object = model.objects.front();
+        auto set_range = [&](const t_layer_height_range &range) {
+            object->layer_config_ranges.clear();
+            object->layer_config_ranges[range].set("perimeters", 5);
+            print.apply(model, config);
+            return print.objects().front()->cache_key();
+        };
+        std::string key = set_range({ 2., 5. });
+        THEN("The same range produces the same key") {
+            REQUIRE(set_range({ 2., 5. }) == key);
+        }
+        WHEN("The range is moved keeping its settings") {
+            THEN("The cache key changes") {
+                REQUIRE(set_range({ 4., 7. }) != key);
+            }
+        }
+        WHEN("The range is resized keeping its settings") {
+            THEN("The cache key changes") {
+                REQUIRE(set_range({ 2., 8. }) != key);
+            }
+        }
+    }
+}
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <future>
 #include <chrono>
+#include <iostream>
 
 //#include "test_options.hpp"
 #include "test_data.hpp"
@@ -379,6 +380,69 @@ SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
         }
     }
 }
+TEST_CASE("Sliced sphere produces a single circular contour per layer", "[TriangleMeshSlicer]") {
+    const double         radius = 10.;
+    indexed_triangle_set sphere = its_make_sphere(radius, 2. * PI / 180.);
+    std::vector<float>   zs { -9.f, -5.f, -0.5f, 0.f, 3.f, 7.5f, 9.5f };
+    std::vector<ExPolygons> slices = slice_mesh_ex(sphere, zs);
+    REQUIRE(slices.size() == zs.size());
+    for (size_t i = 0; i < zs.size(); ++ i) {
+        REQUIRE(slices[i].size() == 1);
+        REQUIRE(slices[i].front().holes.empty());
+        double r2 = radius * radius - double(zs[i]) * double(zs[i]);
+        REQUIRE(unscaled<double>(unscaled<double>(slices[i].front().area())) == Approx(PI * r2).epsilon(0.01));
+    }
+}
+
+TEST_CASE("Slicing at a few planes matches slicing at a stack of planes", "[TriangleMeshSlicer]") {
+    // A few planes are sliced face by face, a stack of planes by a plane sweep over the Z sorted faces.
+    indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 180.);
+    its_transform(sphere, Transform3d(Eigen::AngleAxisd(0.3, Vec3d::UnitX())), true);
+    std::vector<float>   zs_stack;
+    for (float z = -9.5f; z < 10.f; z += 0.5f)
+        zs_stack.emplace_back(z);
+    std::vector<ExPolygons> slices_stack = slice_mesh_ex(sphere, zs_stack);
+    REQUIRE(slices_stack.size() == zs_stack.size());
+    for (size_t i = 0; i < zs_stack.size(); i += 7) {
+        std::vector<ExPolygons> slices_single = slice_mesh_ex(sphere, { zs_stack[i] });
+        REQUIRE(slices_single.size() == 1);
+        REQUIRE(slices_single.front().size() == slices_stack[i].size());
+        REQUIRE(slices_single.front().size() == 1);
+        REQUIRE(slices_single.front().front().contour.size() == slices_stack[i].front().contour.size());
+        REQUIRE(slices_single.front().front().area() == Approx(slices_stack[i].front().area()));
+    }
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Benchmark slicing of a large mesh without precalculated edge IDs", "[TriangleMeshSlicer]") {
+    // Approximately 4 million triangles.
+    indexed_triangle_set sphere = its_make_sphere(50., 2. * PI / 1440.);
+    std::vector<float>   zs;
+    for (float z = -49.9f; z < 50.f; z += 0.2f)
+        zs.emplace_back(z);
+
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point start) { return std::chrono::duration<double>(clock::now() - start).count(); };
+
+    // slice_mesh() used to calculate the face edge IDs on each call to chain the intersection lines.
+    auto               t_start       = clock::now();
+    std::vector<Vec3i> face_edge_ids = its_face_edge_ids(sphere);
+    double             t_edge_ids    = seconds(t_start);
+    t_start = clock::now();
+    std::vector<ExPolygons> slices = slice_mesh_ex(sphere, zs);
+    double             t_slice       = seconds(t_start);
+
+    std::cout << "Slicing " << sphere.indices.size() << " triangles at " << zs.size() << " layers: " <<
+        "its_face_edge_ids " << t_edge_ids << "s, slice_mesh_ex " << t_slice << "s, " <<
+        "speedup " << (t_edge_ids + t_slice) / t_slice << "x" << std::endl;
+
+    REQUIRE(face_edge_ids.size() == sphere.indices.size());
+    REQUIRE(slices.size() == zs.size());
+    for (const ExPolygons &slice : slices)
+        REQUIRE(slice.size() == 1);
+}
+#endif // TEST_PERFORMANCE
+
 #ifdef TEST_PERFORMANCE
 TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
     TriangleMesh mesh;
@@ -124,3 +124,53 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
     }
 }
 
+
+SCENARIO("Loading 3mf file through the model cache", "[3mf]") {
+    GIVEN("3mf file with a transformed volume and per volume settings") {
+        Model src_model;
+        std::string src_file = std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl";
+        load_stl(src_file.c_str(), &src_model);
+        src_model.add_default_instances();
+        ModelVolume *src_volume = src_model.objects.front()->volumes.front();
+        src_volume->set_offset({ 10.0, 20.0, 0.0 });
+        src_volume->set_rotation({ 0., 0., Geometry::deg2rad(45.0) });
+        src_volume->config.set("perimeters", 5);
+
+        std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/prusa_cached.3mf";
+        store_3mf(test_file.c_str(), &src_model, nullptr, false);
+
+        boost::filesystem::path cache_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        Model::set_cache_dir(cache_dir.string());
+
+        WHEN("the 3mf file is loaded twice") {
+            auto load = [&test_file]() {
+                DynamicPrintConfig config;
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                return Model::read_from_archive(test_file, &config, &ctxt, Model::LoadAttribute::AddDefaultInstances);
+            };
+            Model parsed = load();
+            bool  cache_stored = ! boost::filesystem::is_empty(cache_dir);
+            Model cached = load();
+            THEN("the first load stores the model into the cache") {
+                REQUIRE(cache_stored);
+            }
+            THEN("the model loaded from the cache matches the parsed model") {
+                REQUIRE(cached.objects.size() == parsed.objects.size());
+                const ModelVolume &vp = *parsed.objects.front()->volumes.front();
+                const ModelVolume &vc = *cached.objects.front()->volumes.front();
+                REQUIRE(vc.mesh().its.vertices == vp.mesh().its.vertices);
+                REQUIRE(vc.mesh().its.indices == vp.mesh().its.indices);
+                REQUIRE(vc.mesh().stl.stats.number_of_facets == vp.mesh().stl.stats.number_of_facets);
+                REQUIRE(vc.mesh().repaired);
+                REQUIRE(vc.get_matrix().isApprox(vp.get_matrix()));
+                REQUIRE(vc.config.opt_int("perimeters") == 5);
+                REQUIRE(cached.objects.front()->instances.size() == parsed.objects.front()->instances.size());
+                REQUIRE(cached.objects.front()->input_file == test_file);
+            }
+        }
+
+        Model::set_cache_dir(std::string());
+        boost::filesystem::remove_all(cache_dir);
+        boost::filesystem::remove(test_file);
+    }
+}
@@ -299,3 +299,26 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Clipper working data allocated from a thread arena", "[ClipperUtils]") {
+    ExPolygon square_with_hole;
+    square_with_hole.contour = Polygon{ { 100, 100 }, { 200, 100 }, { 200, 200 }, { 100, 200 } };
+    square_with_hole.holes.emplace_back(Polygon{ { 160, 140 }, { 140, 140 }, { 140, 160 }, { 160, 160 } });
+    const ExPolygons  subject { square_with_hole };
+    const Polygons    clip { Polygon{ { 150, 50 }, { 250, 50 }, { 250, 150 }, { 150, 150 } } };
+    const ExPolygons  diff_heap   = diff_ex(subject, clip);
+    const ExPolygons  offset_heap = offset_ex(subject, 5.f);
+    ExPolygons        diff_arena, offset_arena;
+    {
+        ClipperLib::ArenaScope clipper_arena;
+        {
+            // Nested scopes are allowed, the arena is rewound once the outermost scope ends.
+            ClipperLib::ArenaScope nested;
+            diff_arena = diff_ex(subject, clip);
+        }
+        offset_arena = offset_ex(subject, 5.f);
+    }
+    // Results are allocated from the heap, they remain valid after the scope ends.
+    REQUIRE(diff_arena == diff_heap);
+    REQUIRE(offset_arena == offset_heap);
+}
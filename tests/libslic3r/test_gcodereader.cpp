@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCodeReader.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+using namespace Slic3r;
+
+struct ParsedLine {
+    std::string raw;
+    std::string cmd;
+    float       x, y, e;
+    bool        has_x, has_y, has_e;
+    bool operator==(const ParsedLine &rhs) const {
+        return raw == rhs.raw && cmd == rhs.cmd && x == rhs.x && y == rhs.y && e == rhs.e && has_x == rhs.has_x && has_y == rhs.has_y && has_e == rhs.has_e;
+    }
+};
+
+static void collect_line(std::vector<ParsedLine> &out, const GCodeReader::GCodeLine &line)
+{
+    out.push_back({ std::string(line.raw()), std::string(line.cmd()), line.x(), line.y(), line.e(), line.has_x(), line.has_y(), line.has_e() });
+}
+
+TEST_CASE("Memory mapped parse_file matches parse_buffer", "[GCodeReader]") {
+    // Mixed line endings, comments, an empty line and a last line without a trailing newline.
+    const std::string gcode =
+        "; generated by test\n"
+        "G1 X10.5 Y20 E0.1 ; comment\n"
+        "\n"
+        "G1 X11 Y21 E0.2\r\n"
+        "M104 S200\n"
+        "G1 X12.25 Y-3 E0.3";
+
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gcodereader_%%%%-%%%%.gcode");
+    {
+        FILE *f = boost::nowide::fopen(path.string().c_str(), "wb");
+        REQUIRE(f != nullptr);
+        fwrite(gcode.data(), 1, gcode.size(), f);
+        fclose(f);
+    }
+
+    std::vector<ParsedLine> from_buffer;
+    std::vector<ParsedLine> from_file;
+    {
+        GCodeReader reader;
+        reader.parse_buffer(gcode, [&from_buffer](GCodeReader &, const GCodeReader::GCodeLine &line) { collect_line(from_buffer, line); });
+    }
+    {
+        GCodeReader reader;
+        reader.parse_file(path.string(), [&from_file](GCodeReader &, const GCodeReader::GCodeLine &line) { collect_line(from_file, line); });
+    }
+    boost::filesystem::remove(path);
+
+    REQUIRE(from_file.size() == 6);
+    REQUIRE(from_file == from_buffer);
+    REQUIRE(from_file[1].raw == "G1 X10.5 Y20 E0.1 ; comment");
+    REQUIRE(from_file[3].raw == "G1 X11 Y21 E0.2");
+    REQUIRE(from_file.back().raw == "G1 X12.25 Y-3 E0.3");
+    REQUIRE(from_file.back().x == Approx(12.25f));
+}
+
+TEST_CASE("GCodeLine::set() keeps a modified copy of the line", "[GCodeReader]") {
+    GCodeReader reader;
+    GCodeReader::GCodeLine modified;
+    {
+        std::string line = "G1 X1 Z0.2 E0.5";
+        reader.parse_line(line, [&modified](GCodeReader &reader, const GCodeReader::GCodeLine &gline) {
+            modified = gline;
+            modified.set(reader, Z, 0.3f);
+        });
+        // Overwrite the parsed buffer, the modified line shall not reference it.
+        std::fill(line.begin(), line.end(), 'x');
+    }
+    REQUIRE(modified.raw() == "G1 X1 Z0.300 E0.5");
+    GCodeReader::GCodeLine copy = modified;
+    REQUIRE(copy.raw() == "G1 X1 Z0.300 E0.5");
+    REQUIRE(copy.z() == Approx(0.3f));
+}
+
+TEST_CASE("parse_file_parallel matches parse_file", "[GCodeReader]") {
+    // Large enough to be split into several chunks, the last line is not terminated.
+    std::string gcode = "M83\n";
+    for (int i = 0; i < 300000; ++ i)
+        gcode += (i % 7 == 0) ? ";LAYER_CHANGE\r\n" : "G1 X" + std::to_string(i % 100) + ".5 Y" + std::to_string(i % 37) + " E0.0125\n";
+    gcode += "G1 X1 Y2 E0.5";
+
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gcodereader_%%%%-%%%%.gcode");
+    {
+        FILE *f = boost::nowide::fopen(path.string().c_str(), "wb");
+        REQUIRE(f != nullptr);
+        fwrite(gcode.data(), 1, gcode.size(), f);
+        fclose(f);
+    }
+
+    // Record the reader state seen by the callback as well.
+    auto collect = [](std::vector<ParsedLine> &out, GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        collect_line(out, line);
+        out.push_back({ std::string(), std::string(), reader.x(), reader.y(), reader.e(), false, false, false });
+    };
+    GCodeConfig config;
+    config.use_relative_e_distances.value = true;
+
+    std::vector<ParsedLine> serial;
+    std::vector<ParsedLine> parallel;
+    {
+        GCodeReader reader;
+        reader.apply_config(config);
+        reader.parse_file(path.string(), [&serial, &collect](GCodeReader &reader, const GCodeReader::GCodeLine &line) { collect(serial, reader, line); });
+    }
+    {
+        GCodeReader reader;
+        reader.apply_config(config);
+        reader.parse_file_parallel(path.string(), [&parallel, &collect](GCodeReader &reader, const GCodeReader::GCodeLine &line) { collect(parallel, reader, line); });
+    }
+
+    size_t cnt = 0;
+    {
+        // Parsing stops when requested from the callback.
+        GCodeReader reader;
+        reader.parse_file_parallel(path.string(), [&cnt](GCodeReader &reader, const GCodeReader::GCodeLine &) {
+            if (++ cnt == 1000)
+                reader.quit_parsing();
+        });
+    }
+    boost::filesystem::remove(path);
+
+    REQUIRE(cnt == 1000);
+    REQUIRE(serial.size() == 2 * 300002);
+    REQUIRE(parallel == serial);
+}
@@ -1,5 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include <memory>
+#include <cstring>
+#include <random>
+
+#include <tbb/task_arena.h>
+
 #include "libslic3r/Point.hpp"
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/Polygon.hpp"
@@ -7,7 +13,9 @@
 #include "libslic3r/Line.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/ExtrusionEntityCollection.hpp"
 #include "libslic3r/ShortestPath.hpp"
+#include "libslic3r/EdgeGrid.hpp"
 
 using namespace Slic3r;
 
@@ -323,6 +331,88 @@ SCENARIO("Path chaining", "[Geometry]") {
 	}
 }
 
+SCENARIO("Chaining of large sets of extrusions", "[Geometry]") {
+	std::mt19937 rng(0);
+	std::uniform_int_distribution<coord_t> coord(0, scaled<coord_t>(200.));
+	std::uniform_int_distribution<coord_t> offset(- scaled<coord_t>(2.), scaled<coord_t>(2.));
+	auto random_path = [&rng, &coord, &offset]() {
+		Point a(coord(rng), coord(rng));
+		ExtrusionPath path(erSupportMaterialInterface);
+		path.polyline = Polyline(a, a + Point(offset(rng), offset(rng)));
+		return path;
+	};
+	Point start(0, 0);
+	GIVEN("Short segments, every fifth of them not reversible") {
+		// Enough segments to index their end points with a grid instead of a KD tree.
+		ExtrusionEntityCollection collection;
+		for (size_t i = 0; i < 5000; ++ i)
+			if (i % 5 == 0) {
+				ExtrusionEntityCollection fixed;
+				fixed.no_sort = true;
+				fixed.append(random_path());
+				collection.append(std::move(fixed));
+			} else
+				collection.append(random_path());
+		ExtrusionEntitiesPtr &entities = collection.entities;
+		auto validate = [&entities](const std::vector<std::pair<size_t, bool>> &chain) {
+			REQUIRE(chain.size() == entities.size());
+			std::vector<char> used(entities.size(), false);
+			for (const std::pair<size_t, bool> &segment : chain) {
+				REQUIRE(segment.first < entities.size());
+				REQUIRE(! used[segment.first]);
+				used[segment.first] = true;
+				REQUIRE((entities[segment.first]->can_reverse() || ! segment.second));
+			}
+		};
+		auto travel_length = [&entities](const std::vector<std::pair<size_t, bool>> &chain) {
+			double length = 0.;
+			for (size_t i = 1; i < chain.size(); ++ i) {
+				const ExtrusionEntity *prev = entities[chain[i - 1].first];
+				const ExtrusionEntity *next = entities[chain[i].first];
+				Point end   = chain[i - 1].second ? prev->first_point() : prev->last_point();
+				Point begin = chain[i].second ? next->last_point() : next->first_point();
+				length += (begin - end).cast<double>().norm();
+			}
+			return length;
+		};
+		std::vector<std::pair<size_t, bool>> greedy = chain_extrusion_entities(entities, &start);
+		THEN("Greedy chain is valid") {
+			validate(greedy);
+		}
+		WHEN("Improved by 2-opt") {
+			std::vector<std::pair<size_t, bool>> improved = chain_extrusion_entities(entities, &start, 100000);
+			THEN("The chain is valid, starts with the same segment and it is not longer") {
+				validate(improved);
+				REQUIRE(improved.front() == greedy.front());
+				REQUIRE(travel_length(improved) <= travel_length(greedy) + EPSILON);
+			}
+		}
+	}
+	GIVEN("Many independent collections") {
+		std::vector<ExtrusionEntityCollection> serial(64);
+		for (ExtrusionEntityCollection &collection : serial)
+			for (size_t i = 0; i < 200; ++ i)
+				collection.append(random_path());
+		std::vector<ExtrusionEntityCollection> parallel = serial;
+		WHEN("Chained in parallel") {
+			std::vector<ExtrusionEntitiesPtr*> collections;
+			for (ExtrusionEntityCollection &collection : parallel)
+				collections.emplace_back(&collection.entities);
+			chain_and_reorder_extrusion_entities_parallel(collections, Points(collections.size(), start));
+			THEN("The result is the same as if chained one by one") {
+				for (size_t i = 0; i < serial.size(); ++ i) {
+					chain_and_reorder_extrusion_entities(serial[i].entities, &start);
+					REQUIRE(serial[i].entities.size() == parallel[i].entities.size());
+					for (size_t j = 0; j < serial[i].entities.size(); ++ j) {
+						REQUIRE(serial[i].entities[j]->first_point() == parallel[i].entities[j]->first_point());
+						REQUIRE(serial[i].entities[j]->last_point() == parallel[i].entities[j]->last_point());
+					}
+				}
+			}
+		}
+	}
+}
+
 SCENARIO("Line distances", "[Geometry]"){
     GIVEN("A line"){
         Line line(Point(0, 0), Point(20, 0));
@@ -432,6 +522,59 @@ TEST_CASE("Triangle Simplification does not result in less than 3 points", "[Geo
     REQUIRE(triangle.simplify(250000).at(0).points.size() == 3);
 }
 
+TEST_CASE("EdgeGrid built in parallel is identical to the serial build", "[Geometry]") {
+    // Square with a square hole, a finely sampled circle and a thin triangle with long slanted edges crossing many stripes.
+    ExPolygons expolygons;
+    {
+        ExPolygon square;
+        square.contour = Slic3r::Polygon({ { 0, 0 }, { scaled(60.), 0 }, { scaled(60.), scaled(60.) }, { 0, scaled(60.) } });
+        square.holes.emplace_back(Slic3r::Polygon({ { scaled(20.), scaled(20.) }, { scaled(20.), scaled(40.) }, { scaled(40.), scaled(40.) }, { scaled(40.), scaled(20.) } }));
+        expolygons.emplace_back(std::move(square));
+        ExPolygon circle;
+        for (size_t i = 0; i < 720; ++ i) {
+            double angle = 2. * M_PI * double(i) / 720.;
+            circle.contour.points.emplace_back(scaled(95. + 25. * cos(angle)), scaled(30. + 25. * sin(angle)));
+        }
+        expolygons.emplace_back(std::move(circle));
+        expolygons.emplace_back(Slic3r::Polygon({ { scaled(5.), scaled(70.) }, { scaled(115.), scaled(75.) }, { scaled(10.), scaled(110.) } }));
+    }
+
+    auto build = [&expolygons]() {
+        EdgeGrid::Grid grid;
+        grid.create(expolygons, scaled(0.2));
+        grid.calculate_sdf();
+        return grid;
+    };
+    EdgeGrid::Grid serial;
+    tbb::task_arena(1).execute([&serial, &build]() { serial = build(); });
+    EdgeGrid::Grid parallel = build();
+
+    REQUIRE(parallel.bbox().min == serial.bbox().min);
+    REQUIRE(parallel.bbox().max == serial.bbox().max);
+    REQUIRE(parallel.rows() == serial.rows());
+    REQUIRE(parallel.cols() == serial.cols());
+    // Many more rows than stripes, thus the stripes span more rows than the minimum.
+    REQUIRE(serial.rows() > 64 * 8);
+
+    bool same_cells = true;
+    bool same_sdf   = true;
+    for (coord_t r = 0; r < coord_t(serial.rows()); ++ r)
+        for (coord_t c = 0; c < coord_t(serial.cols()); ++ c) {
+            auto cell_serial   = serial.cell_data_range(r, c);
+            auto cell_parallel = parallel.cell_data_range(r, c);
+            if (! std::equal(cell_serial.first, cell_serial.second, cell_parallel.first, cell_parallel.second))
+                same_cells = false;
+            // The center of a cell interpolates all four corners of the signed distance field with non-zero weights.
+            Point center = serial.bbox().min + Point(c * serial.resolution() + serial.resolution() / 2, r * serial.resolution() + serial.resolution() / 2);
+            float d_serial   = serial.signed_distance_bilinear(center);
+            float d_parallel = parallel.signed_distance_bilinear(center);
+            if (std::memcmp(&d_serial, &d_parallel, sizeof(float)) != 0)
+                same_sdf = false;
+        }
+    REQUIRE(same_cells);
+    REQUIRE(same_sdf);
+}
+
 SCENARIO("Ported from xs/t/14_geometry.t", "[Geometry]"){
     GIVEN(("square")){
     	Slic3r::Points points { { 100, 100 }, {100, 200 }, { 200, 200 }, { 200, 100 }, { 150, 150 } };
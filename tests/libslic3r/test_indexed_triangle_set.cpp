@@ -100,3 +100,29 @@ TEST_CASE("Split two watertight meshes", "[its_split][its]") {
     debug_write_obj(res, "parts_watertight");
 }
 
+
+TEST_CASE("Face neighbors are symmetric", "[its_face_neighbors][its]") {
+    using namespace Slic3r;
+
+    auto cube = its_make_cube(10., 10., 10.), cube_high = cube;
+    its_transform(cube_high, identity3f().translate(Vec3f{10.f, 10.f, 0.f}));
+    its_merge(cube, cube_high);
+    // The two cubes share a single vertical edge, which becomes non-manifold after merging the vertices.
+    its_merge_vertices(cube);
+
+    std::vector<Vec3i> neighbors = its_face_neighbors(cube);
+
+    REQUIRE(neighbors.size() == cube.indices.size());
+    for (int face_idx = 0; face_idx < int(neighbors.size()); ++ face_idx)
+        for (int i = 0; i < 3; ++ i) {
+            int neighbor = neighbors[face_idx](i);
+            // Every edge of a closed mesh has a neighbor.
+            REQUIRE(neighbor != -1);
+            REQUIRE(neighbor != face_idx);
+            // The neighbor shares the edge with opposite orientation and it points back to this face.
+            Vec2i edge = its_triangle_edge(cube.indices[face_idx], i);
+            int   k    = its_triangle_edge_index(cube.indices[neighbor], Vec2i(edge(1), edge(0)));
+            REQUIRE(k != -1);
+            REQUIRE(neighbors[neighbor](k) == face_idx);
+        }
+}
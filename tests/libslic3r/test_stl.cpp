@@ -2,6 +2,10 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
 
 using namespace Slic3r;
 
@@ -35,8 +39,7 @@ SCENARIO("Reading an STL file", "[stl]") {
 				REQUIRE(is_approx(model.objects.front()->volumes.front()->mesh().size(), Vec3d(20, 20, 20)));
 			}
 		}
-#if 0
-		// ASCII STLs ending with just carriage returns are not supported. These were used by the old Macs, while the Unix based MacOS uses LFs as any other Unix.
+		// ASCII STLs ending with just carriage returns were used by the old Macs, while the Unix based MacOS uses LFs as any other Unix.
 		WHEN("line endings CR") {
 			Slic3r::Model model;
 			THEN("load should succeed") {
@@ -44,8 +47,6 @@ SCENARIO("Reading an STL file", "[stl]") {
 				REQUIRE(is_approx(model.objects.front()->volumes.front()->mesh().size(), Vec3d(20, 20, 20)));
 			}
 		}
-
-#endif
 		WHEN("nonstandard STL file (text after ending tags, invalid normals, for example infinities)") {
 			Slic3r::Model model;
 			THEN("load should succeed") {
@@ -55,3 +56,41 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+static bool read_ascii_stl(const std::string &facets, stl_file &stl)
+{
+	// Binary and ASCII STLs are told apart by the first bytes after the header, thus the file has to be long enough.
+	const std::string data = "solid " + std::string(200, 'x') + "\n" + facets + "endsolid\n";
+	boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("stl_%%%%-%%%%.stl");
+	FILE *f = boost::nowide::fopen(path.string().c_str(), "wb");
+	REQUIRE(f != nullptr);
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+	bool result = read_stl_file(path.string().c_str(), stl);
+	boost::filesystem::remove(path);
+	return result;
+}
+
+static std::string ascii_stl_facet(const std::string &normal, const std::string &first_coordinate = "0")
+{
+	return "facet normal " + normal + "\nouter loop\nvertex " + first_coordinate + " 0 0\nvertex 1 0 0\nvertex 0 1 0\nendloop\nendfacet\n";
+}
+
+TEST_CASE("ASCII STL with garbage normals and numbers", "[stl]") {
+	SECTION("garbage in any coordinate of a normal resets the normal") {
+		stl_file stl;
+		REQUIRE(read_ascii_stl(
+			ascii_stl_facet("1.#QNAN 0 0") +
+			ascii_stl_facet("nan garbage 1") +
+			ascii_stl_facet("0 0 " + std::string(70, '1')) +
+			ascii_stl_facet("0 0 1"), stl));
+		REQUIRE(stl.stats.number_of_facets == 4);
+		for (size_t i = 0; i < 3; ++ i)
+			REQUIRE(stl.facet_start[i].normal == stl_normal::Zero());
+		REQUIRE(stl.facet_start[3].normal == stl_normal(0.f, 0.f, 1.f));
+	}
+	SECTION("a long token is not parsed by its prefix") {
+		stl_file stl;
+		REQUIRE(! read_ascii_stl(ascii_stl_facet("0 0 1", "1" + std::string(70, '0') + "x"), stl));
+	}
+}